@@ -7,8 +7,14 @@
  *
  * iotdata_gateway.c - E22-900T22U to MQTT gateway
  *
- * Receives iotdata binary frames from E22-900T22U radio, decodes to JSON,
- * and publishes to MQTT topic: <prefix>/<variant_name>/<station_id>
+ * Receives iotdata binary frames from one or more E22-900T22U radios, decodes
+ * to JSON, and publishes to MQTT topic: <prefix>/<variant_name>/<station_id>
+ *
+ * A single epoll loop owns every radio's serial port and the dedup UDP
+ * socket. Radio frames are delimited by inter-byte silence, so no read
+ * blocks; each radio has its own port, channel and statistics. mosquitto
+ * runs without its own thread, and one thread makes every MQTT call: the
+ * publisher thread when there are decode workers, otherwise the epoll loop.
  *
  * Variant definitions are compiled in from the common headers.
  * No routing configuration needed — the variant byte in the iotdata header
@@ -17,7 +23,7 @@
  * Mesh support (variant 15):
  *   - FORWARD packets are unwrapped and the inner sensor data processed
  *     as if received directly.
- *   - Duplicate suppression via {station_id, sequence} ring buffer.
+ *   - Duplicate suppression via per-station sequence windows.
  *   - Beacon origination on a configurable interval (when mesh-enable=true).
  *   - ACK transmission to FORWARD senders (stub, ready for implementation).
  *   - All mesh control packets are logged for diagnostics.
@@ -26,7 +32,34 @@
  *   - allow incoming, and establish outgoing, UDP streams to specified
  *     other gateways to synchronise station_id/sequence pairs for edge
  *     de-duplication before publishing to MQTT. Operates indepemdently of
- *     Mesh protocol.
+ *     Mesh protocol. Pairs to send are queued lock-free from any thread and
+ *     flushed by a one-shot timerfd, armed by the first pair after a flush.
+ *
+ * Station state:
+ *   - a 4096-slot table indexed by station id holds each station's last
+ *     packet, last-seen time, sequence gap/loss counters, RSSI EMA and
+ *     variant, updated in O(1) as packets are accepted. Every
+ *     interval-snapshot seconds the state of each station heard is
+ *     published to <prefix>/state/<station_id> with its last values decoded,
+ *     a few stations per loop pass and, with workers, by the publisher.
+ *
+ * Capture:
+ *   - optionally (capture-path) every raw frame received is appended, with
+ *     its time, RSSI and radio, to memory-mapped segment files rotated at
+ *     capture-segment-size MB, keeping the last capture-segments of them.
+ *     iotdata_replay decodes them again, e.g. after variant map changes.
+ *
+ * Pipeline:
+ *   - the radio thread reads, peeks, handles mesh control and dedups, then
+ *     hands sensor packets to N decode workers (by station, so each
+ *     station's packets stay in order), which serialise JSON for a single
+ *     MQTT publisher thread. Stages are joined by bounded single-producer/
+ *     single-consumer rings; a slow broker fills them rather than stalling
+ *     radio reads. With zero workers, packets are processed inline.
+ *   - optionally the publisher batches (mqtt-batch): per variant into one
+ *     NDJSON or JSON array payload on <prefix>/<variant_name>, or as a burst
+ *     of individual publishes through a corked socket, held for at most
+ *     mqtt-batch-linger ms or mqtt-batch-size messages.
  *
  * Depends upon EBYTE E22 connector
  * https://github.com/matthewgream/e22900t22u
@@ -35,6 +68,8 @@
 // -----------------------------------------------------------------------------------------------------------------------------------------
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
+#define _GNU_SOURCE /* sendmmsg, recvmmsg */
+
 #include <signal.h>
 #include <stdarg.h>
 #include <stdbool.h>
@@ -46,12 +81,17 @@
 #include <time.h>
 
 #include <errno.h>
-#include <poll.h>
 #include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <sys/timerfd.h>
 
 volatile bool running = true;
 
@@ -134,6 +174,7 @@ void __sleep_ms(const uint32_t ms) {
 #include "iotdata_variant_suite.h"
 #include "iotdata.c"
 #include "iotdata_mesh.h"
+#include "iotdata_capture.h"
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
 // -----------------------------------------------------------------------------------------------------------------------------------------
@@ -147,23 +188,39 @@ void __sleep_ms(const uint32_t ms) {
 #define MQTT_CLIENT_DEFAULT              "iotdata_gateway"
 #define MQTT_SERVER_DEFAULT              "mqtt://localhost"
 #define MQTT_TLS_DEFAULT                 false
-#define MQTT_SYNCHRONOUS_DEFAULT         false
+#define MQTT_SYNCHRONOUS_DEFAULT         true /* driven by the process loop */
 #define MQTT_TOPIC_PREFIX_DEFAULT        "iotdata"
 #define MQTT_RECONNECT_DELAY_DEFAULT     5
 #define MQTT_RECONNECT_DELAY_MAX_DEFAULT 60
+#define MQTT_BATCH_DEFAULT               "off"
+#define MQTT_BATCH_LINGER_DEFAULT        50 /* milliseconds */
+#define MQTT_BATCH_SIZE_DEFAULT          32 /* messages */
 
 #define INTERVAL_STAT_DEFAULT            (5 * 60)
 #define INTERVAL_RSSI_DEFAULT            (1 * 60)
 #define INTERVAL_BEACON_DEFAULT          60 /* seconds */
+#define INTERVAL_SNAPSHOT_DEFAULT        60 /* seconds, 0 disables */
+
+#define CAPTURE_PATH_DEFAULT             ""  /* segment file prefix, empty disables */
+#define CAPTURE_SEGMENT_SIZE_DEFAULT     16  /* megabytes */
+#define CAPTURE_SEGMENTS_DEFAULT         0   /* kept on disk, 0 for all */
+
+#define PROCESS_JSON_SIZE_MAX            16384
+#define PROCESS_TOPIC_SIZE_MAX           255
+#define PROCESS_WORKERS_DEFAULT          2
 
 #define GATEWAY_STATION_ID_DEFAULT       1
 
+#define RADIO_INTERFACES_MAX             4
+#define RADIO_FRAME_GAP_MS               100 /* inter-byte silence that ends a frame, as serial_read */
+
 #include "config_linux.h"
 
 // clang-format off
 const struct option config_options [] = {
     {"config",                required_argument, 0, 0},
     {"port",                  required_argument, 0, 0},
+    {"interfaces",            required_argument, 0, 0},
     {"rate",                  required_argument, 0, 0},
     {"bits",                  required_argument, 0, 0},
     {"address",               required_argument, 0, 0},
@@ -178,6 +235,7 @@ const struct option config_options [] = {
     {"read-timeout-packet",   required_argument, 0, 0},
     {"interval-rssi",         required_argument, 0, 0},
     {"interval-stat",         required_argument, 0, 0},
+    {"interval-snapshot",     required_argument, 0, 0},
     {"debug-e22900t22u",      required_argument, 0, 0},
     {"mqtt-client",           required_argument, 0, 0},
     {"mqtt-server",           required_argument, 0, 0},
@@ -193,7 +251,16 @@ const struct option config_options [] = {
     {"dedup-port",               required_argument, 0, 0},
     {"dedup-peers",              required_argument, 0, 0},
     {"dedup-delay",              required_argument, 0, 0},
+    {"dedup-batch",              required_argument, 0, 0},
+    {"dedup-timeout",            required_argument, 0, 0},
     {"debug-dedup",              required_argument, 0, 0},
+    {"process-workers",       required_argument, 0, 0},
+    {"mqtt-batch",            required_argument, 0, 0},
+    {"mqtt-batch-linger",     required_argument, 0, 0},
+    {"mqtt-batch-size",       required_argument, 0, 0},
+    {"capture-path",          required_argument, 0, 0},
+    {"capture-segment-size",  required_argument, 0, 0},
+    {"capture-segments",      required_argument, 0, 0},
     {"debug",                 required_argument, 0, 0},
     {0, 0, 0, 0}
 };
@@ -250,6 +317,162 @@ void config_populate_mqtt(mqtt_config_t *cfg) {
 // -----------------------------------------------------------------------------------------------------------------------------------------
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
+/* One E22 module per interface. The connector drives a single module through serial_fd, so radio_select() points it at an interface
+ * before any device_* call; each module is configured (including its channel) in turn at startup, and the process loop reads frames
+ * from all of them directly. */
+
+typedef struct {
+    serial_config_t serial;
+    e22900t22_config_t e22900t22u;
+    int fd;
+    uint8_t frame[E22900T22_PACKET_MAXSIZE + 1]; /* +1 for RSSI byte */
+    int frame_length;
+    struct timespec frame_last;
+    time_t interval_rssi_last;
+    /* statistics */
+    uint32_t stat_frames;
+    uint32_t stat_bytes;
+    uint32_t stat_rssi_channel_cnt;
+    uint8_t stat_rssi_channel_ema;
+    uint32_t stat_rssi_packet_cnt;
+    uint8_t stat_rssi_packet_ema;
+} radio_t;
+
+struct {
+    radio_t radios[RADIO_INTERFACES_MAX];
+    int radios_count;
+    char ports[CONFIG_MAX_STRING];
+} radio_state;
+
+void config_populate_radio(const serial_config_t *serial_cfg, const e22900t22_config_t *e22900t22u_cfg) {
+    memset(&radio_state, 0, sizeof(radio_state));
+    /* interfaces=<port>[:<channel>],... overrides port and channel; the other settings are common */
+    strncpy(radio_state.ports, config_get_string("interfaces", ""), sizeof(radio_state.ports) - 1);
+    char *save = NULL, *tok = strtok_r(radio_state.ports, ",", &save);
+    while (tok && radio_state.radios_count < RADIO_INTERFACES_MAX) {
+        while (*tok == ' ')
+            tok++;
+        radio_t *radio = &radio_state.radios[radio_state.radios_count++];
+        radio->serial = *serial_cfg;
+        radio->e22900t22u = *e22900t22u_cfg;
+        char *colon = strrchr(tok, ':');
+        if (colon) {
+            *colon = '\0';
+            radio->e22900t22u.channel = (uint8_t)strtol(colon + 1, NULL, 0);
+        }
+        radio->serial.port = tok;
+        tok = strtok_r(NULL, ",", &save);
+    }
+    if (radio_state.radios_count == 0) {
+        radio_state.radios[0].serial = *serial_cfg;
+        radio_state.radios[0].e22900t22u = *e22900t22u_cfg;
+        radio_state.radios_count = 1;
+    }
+    for (int i = 0; i < radio_state.radios_count; i++) {
+        radio_state.radios[i].fd = -1;
+        printf("config: radio[%d]: port=%s, channel=%d\n", i, radio_state.radios[i].serial.port, radio_state.radios[i].e22900t22u.channel);
+    }
+}
+
+void radio_select(radio_t *radio) {
+    serial_fd = radio->fd;
+    _serial_cfg = &radio->serial;
+}
+
+void radio_end(void) {
+    for (int i = 0; i < radio_state.radios_count; i++) {
+        radio_t *radio = &radio_state.radios[i];
+        if (radio->fd < 0)
+            continue;
+        radio_select(radio);
+        device_disconnect();
+        serial_disconnect();
+        radio->fd = -1;
+    }
+    serial_end();
+}
+
+bool radio_begin(void) {
+    for (int i = 0; i < radio_state.radios_count; i++) {
+        radio_t *radio = &radio_state.radios[i];
+        if (!serial_begin(&radio->serial) || !serial_connect()) {
+            fprintf(stderr, "device: connect failure (interface=%d, port=%s, rate=%d, bits=%s)\n", i, radio->serial.port, radio->serial.rate, serial_bits_str(radio->serial.bits));
+            goto radio_fail;
+        }
+        if (!device_connect(E22900T22_MODULE_USB, &radio->e22900t22u)) {
+            serial_disconnect();
+            goto radio_fail;
+        }
+        radio->fd = serial_fd;
+        printf("device: connect success (interface=%d, port=%s, rate=%d, bits=%s)\n", i, radio->serial.port, radio->serial.rate, serial_bits_str(radio->serial.bits));
+        if (!(device_mode_config() && device_info_read() && device_config_read_and_update() && device_mode_transfer()))
+            goto radio_fail;
+    }
+    return true;
+
+radio_fail:
+    radio_end();
+    return false;
+}
+
+/* on readability: one read, which returns at once since data is waiting (further reads would block for VTIME); false if the interface
+ * has gone (end of file, as after a USB unplug, or a read error other than a transient one) */
+bool radio_receive(radio_t *radio) {
+    const ssize_t n = read(radio->fd, radio->frame + radio->frame_length, sizeof(radio->frame) - (size_t)radio->frame_length);
+    if (n < 0)
+        return errno == EAGAIN || errno == EINTR;
+    if (n == 0)
+        return false;
+    radio->frame_length += (int)n;
+    radio->stat_bytes += (uint32_t)n;
+    clock_gettime(CLOCK_MONOTONIC, &radio->frame_last);
+    return true;
+}
+
+/* takes a failed interface out of service: closed and skipped from then on, with any part received frame dropped */
+void radio_down(radio_t *radio) {
+    fprintf(stderr, "device: interface failed, taking it down (port=%s, error=%s)\n", radio->serial.port, errno ? strerror(errno) : "hangup");
+    radio_select(radio);
+    serial_disconnect();
+    radio->fd = -1;
+    radio->frame_length = 0;
+}
+
+int radio_up_count(void) {
+    int count = 0;
+    for (int i = 0; i < radio_state.radios_count; i++)
+        if (radio_state.radios[i].fd >= 0)
+            count++;
+    return count;
+}
+
+/* milliseconds until the frame being received is complete: -1 if none, 0 if complete now */
+int radio_frame_due_ms(const radio_t *radio) {
+    if (radio->frame_length == 0)
+        return -1;
+    if (radio->frame_length == (int)sizeof(radio->frame))
+        return 0;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const long elapsed_ms = (now.tv_sec - radio->frame_last.tv_sec) * 1000L + (now.tv_nsec - radio->frame_last.tv_nsec) / 1000000L;
+    return elapsed_ms >= RADIO_FRAME_GAP_MS ? 0 : (int)(RADIO_FRAME_GAP_MS - elapsed_ms);
+}
+
+/* takes the completed frame, separating the trailing RSSI byte when the module appends one */
+int radio_frame_take(radio_t *radio, uint8_t *packet_buffer, uint8_t *packet_rssi) {
+    int packet_length = radio->frame_length;
+    *packet_rssi = 0;
+    if (radio->e22900t22u.rssi_packet && packet_length > 1)
+        *packet_rssi = radio->frame[--packet_length];
+    memcpy(packet_buffer, radio->frame, (size_t)packet_length);
+    radio->frame_length = 0;
+    radio->stat_frames++;
+    return packet_length;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
 struct {
     bool enabled;
     uint16_t station_id;             /* this gateway's station_id for mesh packets */
@@ -257,7 +480,7 @@ struct {
     uint16_t beacon_generation;      /* increments each beacon round */
     uint16_t mesh_seq;               /* mesh packet sequence counter */
     time_t beacon_last;              /* last beacon TX time */
-    iotdata_mesh_dedup_ring_t dedup; /* dedup ring */
+    iotdata_mesh_dedup_window_t dedup; /* dedup windows, local and peer-injected */
     bool debug;
     /* statistics */
     uint32_t stat_beacons_tx;
@@ -274,11 +497,16 @@ struct {
 
 #define DEDUP_PORT_DEFAULT     9876
 #define DEDUP_DELAY_MS_DEFAULT 20
+#define DEDUP_TIMEOUT_DEFAULT  30 /* seconds without a new packet before a station's window restarts */
+#define DEDUP_TIMEOUT_MIN      1  /* 0 would restart every window on every packet, disabling dedup */
 #define DEDUP_PEERS_MAX        16
-#define DEDUP_PENDING_MAX      256
-#define DEDUP_BATCH_MAX        32
+#define DEDUP_PENDING_MAX      256 /* power of two */
+#define DEDUP_BATCH_DEFAULT    32
+#define DEDUP_BATCH_MAX        255 /* the entry count is one byte on the wire */
 #define DEDUP_PKT_HEADER_SIZE  3
-#define DEDUP_PKT_SIZE         (DEDUP_PKT_HEADER_SIZE + DEDUP_BATCH_MAX * 4) /* 131 bytes */
+#define DEDUP_PKT_SIZE         (DEDUP_PKT_HEADER_SIZE + DEDUP_BATCH_MAX * 4)    /* 1023 bytes */
+#define DEDUP_WIRE_SIZE        (DEDUP_PENDING_MAX * (DEDUP_PKT_HEADER_SIZE + 4)) /* all pending entries, even at one per datagram */
+#define DEDUP_MMSG_MAX         32                                               /* datagrams per sendmmsg/recvmmsg */
 
 typedef struct {
     char host[128];
@@ -287,32 +515,52 @@ typedef struct {
     bool resolved;
 } dedup_peer_t;
 
+typedef uint8_t dedup_packet_t[DEDUP_PKT_SIZE];
+
+typedef struct {
+    _Atomic uint32_t turn; /* equals the position when free to fill, position + 1 once filled */
+    iotdata_mesh_dedup_entry_t entry;
+} dedup_pending_slot_t;
+
 struct {
     bool enabled;
     uint16_t port;
     uint32_t delay_ms;
+    uint32_t timeout;
+    int batch_size;
     dedup_peer_t peers[DEDUP_PEERS_MAX];
     int peers_count;
-    pthread_mutex_t mutex;
-    pthread_t thread;
-    iotdata_mesh_dedup_entry_t pending[DEDUP_PENDING_MAX];
-    int pending_count;
-    struct timespec pending_first;
+    int recv_fd;
+    int send_fd;
+    int timer_fd; /* one-shot, armed by the first entry pending after a flush */
+    atomic_bool timer_armed;
+    /* entries to send: bounded multi-producer/single-consumer queue, pushed from any thread, drained by the event loop */
+    dedup_pending_slot_t pending[DEDUP_PENDING_MAX];
+    _Alignas(64) _Atomic uint32_t pending_head; /* producers */
+    _Alignas(64) uint32_t pending_tail;         /* consumer */
+    /* datagrams are encoded once into send_wire and shared by every peer's message; received ones are parsed in place */
+    uint8_t send_wire[DEDUP_WIRE_SIZE];
+    struct iovec send_iovs[DEDUP_PENDING_MAX];
+    struct mmsghdr send_msgs[DEDUP_MMSG_MAX];
+    dedup_packet_t recv_pkts[DEDUP_MMSG_MAX];
+    struct iovec recv_iovs[DEDUP_MMSG_MAX];
+    struct mmsghdr recv_msgs[DEDUP_MMSG_MAX];
     bool debug;
     /* statistics */
     uint32_t stat_send_cycles;
     uint32_t stat_send_entries;
+    uint32_t stat_send_calls;
     uint32_t stat_recv_cycles;
     uint32_t stat_recv_entries;
+    uint32_t stat_recv_calls;
     uint32_t stat_injected;
+    _Atomic uint32_t stat_pending_full;
 } dedup_state;
 
 #define DEDUP_MIN(a, b) ((a) < (b) ? (a) : (b))
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
-typedef uint8_t dedup_packet_t[DEDUP_PKT_SIZE];
-
 #define dedup_packet_get_length(pkt)                      (size_t)(3 + (size_t)pkt[2] * 4)
 
 #define dedup_packet_get_gateway_id(pkt)                  (((uint16_t)pkt[0] << 8) | (uint16_t)pkt[1])
@@ -387,6 +635,15 @@ void dedup_peers_resolve(void) {
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
+/* monotonic seconds, the clock of the dedup windows' timeout */
+uint32_t dedup_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
 int dedup_recv_setup(void) {
     const int recv_fd = socket(AF_INET, SOCK_DGRAM, 0);
     if (recv_fd < 0) {
@@ -404,29 +661,33 @@ int dedup_recv_setup(void) {
     return recv_fd;
 }
 
+/* on readability: drain every waiting datagram, up to DEDUP_MMSG_MAX per call */
 void dedup_recv_from_peers(int recv_fd) {
-    struct pollfd pfd = { .fd = recv_fd, .events = POLLIN, .revents = 0 };
-    if (poll(&pfd, 1, 5) > 0 && (pfd.revents & POLLIN)) {
-        dedup_packet_t pkt;
-        struct sockaddr_in from;
-        socklen_t from_len = (socklen_t)sizeof(from);
-        const ssize_t recv_len = recvfrom(recv_fd, pkt, sizeof(pkt), 0, (struct sockaddr *)&from, &from_len);
-        if (recv_len >= DEDUP_PKT_HEADER_SIZE) {
+    for (int i = 0; i < DEDUP_MMSG_MAX; i++) {
+        dedup_state.recv_iovs[i] = (struct iovec) { .iov_base = dedup_state.recv_pkts[i], .iov_len = sizeof(dedup_state.recv_pkts[i]) };
+        dedup_state.recv_msgs[i].msg_hdr = (struct msghdr) { .msg_iov = &dedup_state.recv_iovs[i], .msg_iovlen = 1 };
+    }
+    const uint32_t now = dedup_now();
+    int recv_count;
+    do {
+        recv_count = recvmmsg(recv_fd, dedup_state.recv_msgs, DEDUP_MMSG_MAX, MSG_DONTWAIT, NULL);
+        dedup_state.stat_recv_calls++;
+        for (int i = 0; i < recv_count; i++) {
+            const uint8_t *pkt = dedup_state.recv_pkts[i];
+            const size_t recv_len = dedup_state.recv_msgs[i].msg_len;
+            if (recv_len < DEDUP_PKT_HEADER_SIZE || recv_len < dedup_packet_get_length(pkt))
+                continue;
             const int entry_count = dedup_packet_get_entry_count(pkt);
-            if (recv_len >= (ssize_t)dedup_packet_get_length(pkt)) {
-                pthread_mutex_lock(&dedup_state.mutex);
-                for (int entry_index = 0; entry_index < entry_count; entry_index++) {
-                    iotdata_mesh_dedup_check_and_add(&mesh_state.dedup, dedup_packet_get_entry_station(pkt, entry_index), dedup_packet_get_entry_sequence(pkt, entry_index));
-                    dedup_state.stat_injected++;
-                }
-                pthread_mutex_unlock(&dedup_state.mutex);
-                dedup_state.stat_recv_cycles++;
-                dedup_state.stat_recv_entries += (uint32_t)entry_count;
-                if (dedup_state.debug)
-                    printf("dedup: rx from gateway=0x%04" PRIX16 ", entries=%d\n", dedup_packet_get_gateway_id(pkt), entry_count);
+            for (int entry_index = 0; entry_index < entry_count; entry_index++) {
+                iotdata_mesh_dedup_window_check_and_add(&mesh_state.dedup, dedup_packet_get_entry_station(pkt, entry_index), dedup_packet_get_entry_sequence(pkt, entry_index), now, dedup_state.timeout);
+                dedup_state.stat_injected++;
             }
+            dedup_state.stat_recv_cycles++;
+            dedup_state.stat_recv_entries += (uint32_t)entry_count;
+            if (dedup_state.debug)
+                printf("dedup: rx from gateway=0x%04" PRIX16 ", entries=%d\n", dedup_packet_get_gateway_id(pkt), entry_count);
         }
-    }
+    } while (recv_count == DEDUP_MMSG_MAX || (recv_count < 0 && errno == EINTR));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
@@ -440,86 +701,133 @@ int dedup_send_setup(void) {
     return send_fd;
 }
 
-int dedup_send_collect(iotdata_mesh_dedup_entry_t *send_entries) {
-    int send_count = 0;
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-    pthread_mutex_lock(&dedup_state.mutex);
-    if (dedup_state.pending_count > 0) {
-        const int32_t elapsed_ms = (int32_t)((now.tv_sec - dedup_state.pending_first.tv_sec) * 1000L) + (int32_t)((now.tv_nsec - dedup_state.pending_first.tv_nsec) / 1000000L);
-        if (elapsed_ms > 0 && (uint32_t)elapsed_ms >= dedup_state.delay_ms) {
-            send_count = dedup_state.pending_count;
-            memcpy(send_entries, dedup_state.pending, (size_t)send_count * sizeof(iotdata_mesh_dedup_entry_t));
-            dedup_state.pending_count = 0;
-        }
+void dedup_pending_init(void) {
+    for (uint32_t i = 0; i < DEDUP_PENDING_MAX; i++)
+        atomic_init(&dedup_state.pending[i].turn, i);
+    atomic_init(&dedup_state.pending_head, 0);
+    dedup_state.pending_tail = 0;
+}
+
+/* any thread: claim the slot at head, fill it, then hand it to the consumer; false if full */
+bool dedup_pending_push(uint16_t station_id, uint16_t sequence) {
+    uint32_t head = atomic_load_explicit(&dedup_state.pending_head, memory_order_relaxed);
+    for (;;) {
+        dedup_pending_slot_t *slot = &dedup_state.pending[head & (DEDUP_PENDING_MAX - 1)];
+        const int32_t lag = (int32_t)(atomic_load_explicit(&slot->turn, memory_order_acquire) - head);
+        if (lag == 0) {
+            if (atomic_compare_exchange_weak_explicit(&dedup_state.pending_head, &head, head + 1, memory_order_relaxed, memory_order_relaxed)) {
+                slot->entry.station_id = station_id;
+                slot->entry.sequence = sequence;
+                atomic_store_explicit(&slot->turn, head + 1, memory_order_release);
+                return true;
+            }
+        } else if (lag < 0)
+            return false; /* still holds an entry from a lap ago */
+        else
+            head = atomic_load_explicit(&dedup_state.pending_head, memory_order_relaxed);
+    }
+}
+
+/* event loop only: false if empty, or the next slot is claimed but not yet filled (its producer re-arms the timer) */
+bool dedup_pending_pop(iotdata_mesh_dedup_entry_t *entry) {
+    const uint32_t tail = dedup_state.pending_tail;
+    dedup_pending_slot_t *slot = &dedup_state.pending[tail & (DEDUP_PENDING_MAX - 1)];
+    if (atomic_load_explicit(&slot->turn, memory_order_acquire) != tail + 1)
+        return false;
+    *entry = slot->entry;
+    atomic_store_explicit(&slot->turn, tail + DEDUP_PENDING_MAX, memory_order_release);
+    dedup_state.pending_tail = tail + 1;
+    return true;
+}
+
+void dedup_timer_arm(void) {
+    const struct itimerspec spec = { .it_value = { .tv_sec = (time_t)(dedup_state.delay_ms / 1000), .tv_nsec = (long)(dedup_state.delay_ms % 1000) * 1000000L + (dedup_state.delay_ms == 0 ? 1 : 0) } };
+    if (timerfd_settime(dedup_state.timer_fd, 0, &spec, NULL) < 0)
+        fprintf(stderr, "dedup: timerfd_settime: %s\n", strerror(errno));
+}
+
+void dedup_send_messages(int send_fd, int msgs_count) {
+    int msgs_offset = 0;
+    while (msgs_offset < msgs_count) {
+        const int sent = sendmmsg(send_fd, dedup_state.send_msgs + msgs_offset, (unsigned int)(msgs_count - msgs_offset), 0);
+        dedup_state.stat_send_calls++;
+        if (sent > 0)
+            msgs_offset += sent;
+        else if (errno != EINTR)
+            msgs_offset++; /* skip the datagram that failed, as sendto did */
     }
-    pthread_mutex_unlock(&dedup_state.mutex);
-    return send_count;
 }
 
-void dedup_send_to_peers(int send_fd, iotdata_mesh_dedup_entry_t *send_entries, int send_count) {
-    int send_offset = 0;
-    while (send_offset < send_count) {
-        const int entry_count = DEDUP_MIN(send_count - send_offset, DEDUP_BATCH_MAX);
-        dedup_packet_t pkt;
+void dedup_send_to_peers(int send_fd, const iotdata_mesh_dedup_entry_t *send_entries, int send_count) {
+    int pkts_count = 0;
+    size_t wire_offset = 0;
+    for (int send_offset = 0; send_offset < send_count;) {
+        const int entry_count = DEDUP_MIN(send_count - send_offset, dedup_state.batch_size);
+        uint8_t *pkt = dedup_state.send_wire + wire_offset;
         dedup_packet_set_gateway_id(pkt, mesh_state.station_id);
         dedup_packet_set_entry_count(pkt, entry_count);
         for (int entry_index = 0; entry_index < entry_count; entry_index++) {
             dedup_packet_set_entry_station(pkt, entry_index, send_entries[send_offset + entry_index].station_id);
             dedup_packet_set_entry_sequence(pkt, entry_index, send_entries[send_offset + entry_index].sequence);
         }
-        const size_t pkt_len = dedup_packet_get_length(pkt);
-        for (int peer = 0; peer < dedup_state.peers_count; peer++)
-            if (dedup_state.peers[peer].resolved)
-                (void)sendto(send_fd, pkt, pkt_len, 0, (const struct sockaddr *)&dedup_state.peers[peer].addr, (socklen_t)sizeof(dedup_state.peers[peer].addr));
+        dedup_state.send_iovs[pkts_count++] = (struct iovec) { .iov_base = pkt, .iov_len = dedup_packet_get_length(pkt) };
+        wire_offset += dedup_packet_get_length(pkt);
         dedup_state.stat_send_cycles++;
         dedup_state.stat_send_entries += (uint32_t)entry_count;
         send_offset += entry_count;
     }
+    int msgs_count = 0;
+    for (int peer = 0; peer < dedup_state.peers_count; peer++) {
+        if (!dedup_state.peers[peer].resolved)
+            continue;
+        for (int pkt_index = 0; pkt_index < pkts_count; pkt_index++) {
+            dedup_state.send_msgs[msgs_count++].msg_hdr = (struct msghdr) { .msg_name = &dedup_state.peers[peer].addr, .msg_namelen = (socklen_t)sizeof(dedup_state.peers[peer].addr), .msg_iov = &dedup_state.send_iovs[pkt_index], .msg_iovlen = 1 };
+            if (msgs_count == DEDUP_MMSG_MAX) {
+                dedup_send_messages(send_fd, msgs_count);
+                msgs_count = 0;
+            }
+        }
+    }
+    if (msgs_count > 0)
+        dedup_send_messages(send_fd, msgs_count);
     if (dedup_state.debug)
-        printf("dedup: tx %d entries to %d peers\n", send_count, dedup_state.peers_count);
+        printf("dedup: tx %d entries in %d datagrams to %d peers\n", send_count, pkts_count, dedup_state.peers_count);
 }
 
-// -----------------------------------------------------------------------------------------------------------------------------------------
-
-void *dedup_thread_func(void *arg) {
-    (void)arg;
-
-    int recv_fd, send_fd;
-    if ((recv_fd = dedup_recv_setup()) < 0)
-        goto dedup_end_all;
-    if ((send_fd = dedup_send_setup()) < 0)
-        goto dedup_end_send;
-
+/* on timer expiry: disarm first, so an entry pushed from here on arms it again, then send everything pending */
+void dedup_flush(void) {
+    uint64_t expirations;
+    (void)!read(dedup_state.timer_fd, &expirations, sizeof(expirations));
+    atomic_store(&dedup_state.timer_armed, false);
     iotdata_mesh_dedup_entry_t send_entries[DEDUP_PENDING_MAX];
-    while (running) {
-        dedup_recv_from_peers(recv_fd);
-        if (dedup_state.peers_count > 0) {
-            const int send_count = dedup_send_collect(send_entries);
-            if (send_count > 0)
-                dedup_send_to_peers(send_fd, send_entries, send_count);
-        }
-    }
-
-    close(send_fd);
-dedup_end_send:
-    close(recv_fd);
-dedup_end_all:
-    return NULL;
+    int send_count = 0;
+    while (send_count < DEDUP_PENDING_MAX && dedup_pending_pop(&send_entries[send_count]))
+        send_count++;
+    if (send_count > 0)
+        dedup_send_to_peers(dedup_state.send_fd, send_entries, send_count);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
 void config_populate_dedup(void) {
     memset(&dedup_state, 0, sizeof(dedup_state));
+    dedup_state.recv_fd = dedup_state.send_fd = dedup_state.timer_fd = -1;
     dedup_state.enabled = config_get_bool("dedup-enable", false);
     dedup_state.port = (uint16_t)config_get_integer("dedup-port", DEDUP_PORT_DEFAULT);
     dedup_state.delay_ms = (uint32_t)config_get_integer("dedup-delay", DEDUP_DELAY_MS_DEFAULT);
+    dedup_state.batch_size = config_get_integer("dedup-batch", DEDUP_BATCH_DEFAULT);
+    const int timeout = config_get_integer("dedup-timeout", DEDUP_TIMEOUT_DEFAULT);
+    dedup_state.timeout = timeout < DEDUP_TIMEOUT_MIN ? DEDUP_TIMEOUT_MIN : (uint32_t)timeout;
+    if (dedup_state.batch_size < 1)
+        dedup_state.batch_size = 1;
+    else if (dedup_state.batch_size > DEDUP_BATCH_MAX)
+        dedup_state.batch_size = DEDUP_BATCH_MAX;
     const char *peers = config_get_string("dedup-peers", "");
     dedup_peers_parse(peers);
     dedup_state.debug = config_get_bool("debug-dedup", false);
 
-    printf("config: dedup: enabled=%c, port=%" PRIu16 ", peers=%s, delay=%" PRIu32 "ms, debug=%s\n", dedup_state.enabled ? 'y' : 'n', dedup_state.port, peers, dedup_state.delay_ms, dedup_state.debug ? "on" : "off");
+    printf("config: dedup: enabled=%c, port=%" PRIu16 ", peers=%s, delay=%" PRIu32 "ms, batch=%d, timeout=%" PRIu32 "s, debug=%s\n", dedup_state.enabled ? 'y' : 'n', dedup_state.port, peers, dedup_state.delay_ms,
+           dedup_state.batch_size, dedup_state.timeout, dedup_state.debug ? "on" : "off");
 }
 
 bool dedup_begin(void) {
@@ -531,11 +839,16 @@ bool dedup_begin(void) {
     printf("dedup: enabled, port=%" PRIu16 ", peers=%d, delay=%" PRIu32 "ms\n", dedup_state.port, dedup_state.peers_count, dedup_state.delay_ms);
 
     dedup_peers_resolve();
-    pthread_mutex_init(&dedup_state.mutex, NULL);
-    if (pthread_create(&dedup_state.thread, NULL, dedup_thread_func, NULL) != 0) {
+    dedup_pending_init();
+    if ((dedup_state.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) < 0)
+        fprintf(stderr, "dedup: timerfd_create: %s\n", strerror(errno));
+    if (dedup_state.timer_fd < 0 || (dedup_state.recv_fd = dedup_recv_setup()) < 0 || (dedup_state.send_fd = dedup_send_setup()) < 0) {
+        if (dedup_state.recv_fd >= 0)
+            close(dedup_state.recv_fd);
+        if (dedup_state.timer_fd >= 0)
+            close(dedup_state.timer_fd);
+        dedup_state.recv_fd = dedup_state.timer_fd = -1;
         dedup_state.enabled = false;
-        fprintf(stderr, "dedup: thread create failed: %s\n", strerror(errno));
-        pthread_mutex_destroy(&dedup_state.mutex);
         return false;
     }
 
@@ -545,25 +858,23 @@ bool dedup_begin(void) {
 void dedup_end(void) {
     if (!dedup_state.enabled)
         return;
-    pthread_join(dedup_state.thread, NULL);
-    pthread_mutex_destroy(&dedup_state.mutex);
+    close(dedup_state.timer_fd);
+    close(dedup_state.send_fd);
+    close(dedup_state.recv_fd);
+    dedup_state.recv_fd = dedup_state.send_fd = dedup_state.timer_fd = -1;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
+/* any thread: a new pair is queued for the peers, and the first one queued since the last flush arms the flush timer */
 bool dedup_check_and_add(uint16_t station_id, uint16_t sequence) {
-    if (!dedup_state.enabled)
-        return iotdata_mesh_dedup_check_and_add(&mesh_state.dedup, station_id, sequence);
-    bool is_new;
-    pthread_mutex_lock(&dedup_state.mutex);
-    is_new = iotdata_mesh_dedup_check_and_add(&mesh_state.dedup, station_id, sequence);
-    if (is_new && dedup_state.pending_count < DEDUP_PENDING_MAX) {
-        dedup_state.pending[dedup_state.pending_count].station_id = station_id;
-        dedup_state.pending[dedup_state.pending_count].sequence = sequence;
-        if (dedup_state.pending_count++ == 0)
-            clock_gettime(CLOCK_MONOTONIC, &dedup_state.pending_first);
-    }
-    pthread_mutex_unlock(&dedup_state.mutex);
+    const bool is_new = iotdata_mesh_dedup_window_check_and_add(&mesh_state.dedup, station_id, sequence, dedup_now(), dedup_state.timeout);
+    if (!is_new || !dedup_state.enabled || dedup_state.peers_count == 0)
+        return is_new;
+    if (!dedup_pending_push(station_id, sequence))
+        dedup_state.stat_pending_full++;
+    else if (!atomic_exchange(&dedup_state.timer_armed, true))
+        dedup_timer_arm();
     return is_new;
 }
 
@@ -585,7 +896,7 @@ bool mesh_begin(void) {
         printf("mesh: disabled, not starting\n");
         return true;
     }
-    iotdata_mesh_dedup_init(&mesh_state.dedup);
+    iotdata_mesh_dedup_window_init(&mesh_state.dedup);
     printf("mesh: enabled, station=0x%04" PRIX16 ", beacon-interval=%" PRIu32 "s\n", mesh_state.station_id, (uint32_t)mesh_state.beacon_interval);
     return true;
 }
@@ -609,12 +920,18 @@ void mesh_beacon_send(void) {
     iotdata_mesh_pack_beacon(buf, &beacon);
     if (mesh_state.debug)
         printf("mesh: tx BEACON generation=%" PRIu16 ", station=0x%04" PRIX16 "\n", beacon.generation, beacon.sender_station);
-    if (device_packet_write(buf, IOTDATA_MESH_BEACON_SIZE))
-        mesh_state.stat_beacons_tx++;
-    else
-        fprintf(stderr, "mesh: tx BEACON failed\n");
+    for (int i = 0; i < radio_state.radios_count; i++) {
+        if (radio_state.radios[i].fd < 0)
+            continue;
+        radio_select(&radio_state.radios[i]);
+        if (device_packet_write(buf, IOTDATA_MESH_BEACON_SIZE))
+            mesh_state.stat_beacons_tx++;
+        else
+            fprintf(stderr, "mesh: tx BEACON failed (interface=%d)\n", i);
+    }
 }
 
+/* on the radio selected for the FORWARD being handled */
 void mesh_ack_send(uint16_t fwd_station, uint16_t fwd_seq) {
     uint8_t buf[IOTDATA_MESH_ACK_SIZE];
     const iotdata_mesh_ack_t ack = {
@@ -701,16 +1018,11 @@ struct {
     time_t interval_stat;
     time_t interval_rssi;
     time_t interval_stat_last;
-    time_t interval_rssi_last;
     bool debug;
     /* statistics */
-    uint32_t stat_rssi_channel_cnt;
-    uint8_t stat_rssi_channel_ema;
-    uint32_t stat_rssi_packet_cnt;
-    uint8_t stat_rssi_packet_ema;
-    uint32_t stat_packets_okay;
-    uint32_t stat_packets_drop;
-    uint32_t stat_packets_decode_err;
+    _Atomic uint32_t stat_packets_okay;       /* publisher */
+    _Atomic uint32_t stat_packets_drop;       /* radio and publisher */
+    _Atomic uint32_t stat_packets_decode_err; /* workers */
 } process_state;
 
 void config_populate_process(void) {
@@ -725,7 +1037,803 @@ void config_populate_process(void) {
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
-void process_sensor_packet(const uint8_t *packet_buffer, int packet_length, uint8_t variant_id, uint16_t station_id, uint16_t sequence, const char *topic_prefix, const char *via) {
+bool process_sensor_decode(const uint8_t *packet_buffer, int packet_length, uint8_t variant_id, uint16_t station_id, const char *topic_prefix, char *topic, char *json, size_t *json_length) {
+    const iotdata_variant_def_t *vdef = iotdata_get_variant(variant_id);
+    iotdata_decode_to_json_scratch_t scratch;
+    iotdata_status_t rc;
+    if ((rc = iotdata_decode_to_json_buffer(packet_buffer, (size_t)packet_length, json, PROCESS_JSON_SIZE_MAX, json_length, &scratch)) != IOTDATA_OK) {
+        fprintf(stderr, "process: decode failed: %s (variant=%" PRIu8 ", station=0x%04" PRIX16 ", size=%d)\n", iotdata_strerror(rc), variant_id, station_id, packet_length);
+        process_state.stat_packets_decode_err++;
+        return false;
+    }
+    snprintf(topic, PROCESS_TOPIC_SIZE_MAX, "%s/%s/%04" PRIX16, topic_prefix, vdef->name, station_id);
+    return true;
+}
+
+bool process_sensor_publish(const char *topic, const char *json, size_t json_length, const char *via) {
+    const bool sent = mqtt_send(topic, json, (int)json_length);
+    if (sent)
+        process_state.stat_packets_okay++;
+    else {
+        fprintf(stderr, "process: mqtt send failed (topic=%s, size=%d)\n", topic, (int)json_length);
+        process_state.stat_packets_drop++;
+    }
+    if (process_state.debug)
+        printf("  -> %s (%d bytes%s%s)\n", topic, (int)json_length, via ? " via " : "", via ? via : "");
+    return sent;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+#define PIPELINE_WORKERS_MAX       8
+#define PIPELINE_PACKETS_DEPTH     64 /* slots per radio -> worker ring, power of two */
+#define PIPELINE_MESSAGES_DEPTH    16 /* slots per worker -> publisher ring, power of two: each holds a full JSON buffer */
+#define PIPELINE_SNAPSHOTS_DEPTH   8 /* slots in the radio -> publisher ring of station snapshots, power of two */
+#define PIPELINE_SNAPSHOT_SIZE_MAX (PROCESS_JSON_SIZE_MAX + 512) /* a station's counters around its last packet's JSON */
+#define PIPELINE_WAIT_MS           100
+#define PIPELINE_PACKET_MAX        (E22900T22_PACKET_MAXSIZE + 1) /* as radio_t frame: no RSSI byte is stripped without rssi-packet */
+#define PIPELINE_BATCH_SIZE_MAX    256
+#define PIPELINE_BATCH_BUFFER      (PROCESS_JSON_SIZE_MAX * 4) /* per variant: a batch is published early rather than overflow */
+
+/* single-producer/single-consumer ring of fixed-size slots: the producer fills a slot in place then commits it, the consumer reads in place then releases it */
+typedef struct {
+    uint8_t *slots;
+    size_t slot_size;
+    uint32_t depth;
+    _Alignas(64) _Atomic uint32_t head; /* producer */
+    _Alignas(64) _Atomic uint32_t tail; /* consumer */
+} pipeline_ring_t;
+
+bool pipeline_ring_init(pipeline_ring_t *ring, uint32_t depth, size_t slot_size) {
+    ring->slots = calloc(depth, slot_size);
+    ring->slot_size = slot_size;
+    ring->depth = depth;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return ring->slots != NULL;
+}
+
+void pipeline_ring_free(pipeline_ring_t *ring) {
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+void *pipeline_ring_acquire(pipeline_ring_t *ring) {
+    const uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) >= ring->depth)
+        return NULL; /* full */
+    return ring->slots + (head & (ring->depth - 1)) * ring->slot_size;
+}
+
+void pipeline_ring_commit(pipeline_ring_t *ring) {
+    atomic_store_explicit(&ring->head, atomic_load_explicit(&ring->head, memory_order_relaxed) + 1, memory_order_release);
+}
+
+void *pipeline_ring_peek(pipeline_ring_t *ring) {
+    const uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (tail == atomic_load_explicit(&ring->head, memory_order_acquire))
+        return NULL; /* empty */
+    return ring->slots + (tail & (ring->depth - 1)) * ring->slot_size;
+}
+
+void pipeline_ring_release(pipeline_ring_t *ring) {
+    atomic_store_explicit(&ring->tail, atomic_load_explicit(&ring->tail, memory_order_relaxed) + 1, memory_order_release);
+}
+
+uint32_t pipeline_ring_count(pipeline_ring_t *ring) {
+    return atomic_load_explicit(&ring->head, memory_order_acquire) - atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+typedef struct {
+    const char *topic_prefix;
+    uint16_t station_id;
+    uint8_t variant_id;
+    bool via_mesh;
+    uint64_t received_us;
+    int packet_length;
+    uint8_t packet_buffer[PIPELINE_PACKET_MAX];
+} pipeline_packet_t;
+
+typedef struct {
+    uint8_t variant_id;
+    bool via_mesh;
+    uint64_t received_us;
+    size_t json_length;
+    char topic[PROCESS_TOPIC_SIZE_MAX];
+    char json[PROCESS_JSON_SIZE_MAX];
+} pipeline_message_t;
+
+typedef struct {
+    size_t json_length;
+    char topic[PROCESS_TOPIC_SIZE_MAX];
+    char json[PIPELINE_SNAPSHOT_SIZE_MAX];
+} pipeline_snapshot_t;
+
+typedef struct {
+    pthread_t thread;
+    sem_t wake;
+    pipeline_ring_t packets;  /* radio -> worker */
+    pipeline_ring_t messages; /* worker -> publisher */
+    /* statistics */
+    _Atomic uint32_t stat_decoded;
+    _Atomic uint32_t stat_stalls; /* messages ring full, waited for the publisher */
+} pipeline_worker_t;
+
+typedef enum {
+    PIPELINE_BATCH_OFF = 0, /* one publish per message */
+    PIPELINE_BATCH_NDJSON,  /* one publish per variant batch: newline-delimited documents */
+    PIPELINE_BATCH_ARRAY,   /* one publish per variant batch: a JSON array of documents */
+    PIPELINE_BATCH_BURST,   /* messages held, then published back-to-back into a corked socket */
+} pipeline_batch_mode_t;
+
+const char *const pipeline_batch_modes[] = { "off", "ndjson", "array", "burst" };
+
+/* a batch for one variant, published to <prefix>/<variant_name> */
+typedef struct {
+    char topic[PROCESS_TOPIC_SIZE_MAX];
+    char *buffer;
+    size_t length;
+    uint32_t count;
+    uint64_t opened_us;       /* linger runs from the first message */
+    uint64_t received_sum_us; /* for latency at publish */
+    uint64_t received_min_us;
+} pipeline_batch_t;
+
+struct {
+    int workers_count;
+    pipeline_worker_t workers[PIPELINE_WORKERS_MAX];
+    pipeline_ring_t snapshots; /* radio -> publisher */
+    pthread_t publisher;
+    int publisher_wake; /* eventfd, polled with the MQTT socket: the publisher owns all MQTT I/O while it runs */
+    atomic_bool active;
+    pipeline_batch_mode_t batch_mode;
+    uint32_t batch_linger_ms;
+    uint32_t batch_size;
+    pipeline_batch_t batches[IOTDATA_VARIANT_MAPS_COUNT]; /* publisher only */
+    /* statistics */
+    uint32_t stat_queued; /* radio thread only */
+    uint32_t stat_full;   /* packets ring full, dropped: the radio never waits */
+    _Atomic uint32_t stat_published;
+    _Atomic uint32_t stat_batches;
+    _Atomic uint32_t stat_batch_drops;    /* messages lost with a failed batch or burst publish */
+    _Atomic uint64_t stat_latency_sum_us; /* receipt to publish */
+    _Atomic uint32_t stat_latency_count;
+    _Atomic uint32_t stat_latency_max_us;
+} pipeline_state;
+
+uint64_t pipeline_now_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000ULL + (uint64_t)now.tv_nsec / 1000ULL;
+}
+
+void pipeline_wait(sem_t *sem, int wait_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += wait_ms / 1000;
+    deadline.tv_nsec += (wait_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    while (sem_timedwait(sem, &deadline) < 0 && errno == EINTR)
+        ;
+}
+
+void pipeline_publisher_wake(void) {
+    (void)eventfd_write(pipeline_state.publisher_wake, 1);
+}
+
+/* publisher: waits for messages or MQTT socket readiness and services the socket; mosquitto is not thread safe as used (no
+ * mosquitto_threaded_set), so with workers every MQTT call is made here, and output queued by a publish is written as soon as the
+ * socket takes it */
+void pipeline_publisher_wait(int wait_ms) {
+    struct pollfd fds[2] = {
+        { .fd = pipeline_state.publisher_wake, .events = POLLIN },
+        { .fd = mqtt_socket(), .events = (short)(POLLIN | (mqtt_want_write() ? POLLOUT : 0)) }, /* -1 while down: ignored */
+    };
+    if (poll(fds, 2, wait_ms) <= 0)
+        return;
+    eventfd_t count;
+    if (fds[0].revents & POLLIN)
+        (void)eventfd_read(pipeline_state.publisher_wake, &count);
+    if (fds[1].revents & (POLLIN | POLLERR | POLLHUP))
+        mqtt_loop_read();
+    if (fds[1].revents & POLLOUT)
+        mqtt_loop_write();
+}
+
+void *pipeline_worker_func(void *arg) {
+    pipeline_worker_t *worker = (pipeline_worker_t *)arg;
+    while (atomic_load(&pipeline_state.active)) {
+        pipeline_wait(&worker->wake, PIPELINE_WAIT_MS);
+        const pipeline_packet_t *packet;
+        while ((packet = pipeline_ring_peek(&worker->packets)) != NULL) {
+            pipeline_message_t *message;
+            bool stalled = false;
+            while ((message = pipeline_ring_acquire(&worker->messages)) == NULL && atomic_load(&pipeline_state.active)) {
+                if (!stalled) {
+                    worker->stat_stalls++;
+                    stalled = true;
+                }
+                __sleep_ms(1);
+            }
+            if (message == NULL)
+                break;
+            if (process_sensor_decode(packet->packet_buffer, packet->packet_length, packet->variant_id, packet->station_id, packet->topic_prefix, message->topic, message->json, &message->json_length)) {
+                message->variant_id = packet->variant_id;
+                message->via_mesh = packet->via_mesh;
+                message->received_us = packet->received_us;
+                pipeline_ring_commit(&worker->messages);
+                pipeline_publisher_wake();
+                worker->stat_decoded++;
+            }
+            pipeline_ring_release(&worker->packets);
+        }
+    }
+    return NULL;
+}
+
+void pipeline_latency(uint32_t count, uint64_t sum_us, uint64_t max_us) {
+    pipeline_state.stat_latency_sum_us += sum_us;
+    pipeline_state.stat_latency_count += count;
+    if (max_us > atomic_load(&pipeline_state.stat_latency_max_us)) /* single writer */
+        atomic_store(&pipeline_state.stat_latency_max_us, (uint32_t)(max_us > UINT32_MAX ? UINT32_MAX : max_us));
+}
+
+bool pipeline_publish_message(const pipeline_message_t *message) {
+    const bool sent = process_sensor_publish(message->topic, message->json, message->json_length, message->via_mesh ? "mesh" : NULL);
+    const uint64_t latency_us = pipeline_now_us() - message->received_us;
+    pipeline_latency(1, latency_us, latency_us);
+    return sent;
+}
+
+void pipeline_batch_flush(pipeline_batch_t *batch) {
+    if (batch->count == 0)
+        return;
+    if (pipeline_state.batch_mode == PIPELINE_BATCH_ARRAY)
+        batch->buffer[batch->length++] = ']';
+    if (mqtt_send(batch->topic, batch->buffer, (int)batch->length))
+        process_state.stat_packets_okay += batch->count;
+    else {
+        fprintf(stderr, "process: mqtt send failed (topic=%s, size=%d, batch=%" PRIu32 ")\n", batch->topic, (int)batch->length, batch->count);
+        process_state.stat_packets_drop += batch->count;
+        pipeline_state.stat_batch_drops += batch->count;
+    }
+    if (process_state.debug)
+        printf("  -> %s (%d bytes, %" PRIu32 " messages)\n", batch->topic, (int)batch->length, batch->count);
+    const uint64_t now_us = pipeline_now_us();
+    pipeline_latency(batch->count, now_us * batch->count - batch->received_sum_us, now_us - batch->received_min_us);
+    pipeline_state.stat_batches++;
+    batch->count = 0;
+    batch->length = 0;
+}
+
+/* appends to the variant's batch, publishing it when full; false if the message cannot be batched */
+bool pipeline_batch_add(const pipeline_message_t *message) {
+    if (message->variant_id >= IOTDATA_VARIANT_MAPS_COUNT || message->json_length + 2 > PIPELINE_BATCH_BUFFER)
+        return false;
+    pipeline_batch_t *batch = &pipeline_state.batches[message->variant_id];
+    const char *station = strrchr(message->topic, '/');
+    const size_t topic_length = station != NULL ? (size_t)(station - message->topic) : strlen(message->topic);
+    if (batch->count > 0 && (batch->length + message->json_length + 2 > PIPELINE_BATCH_BUFFER || strncmp(batch->topic, message->topic, topic_length) != 0 || batch->topic[topic_length] != '\0'))
+        pipeline_batch_flush(batch);
+    if (batch->count == 0) {
+        memcpy(batch->topic, message->topic, topic_length);
+        batch->topic[topic_length] = '\0';
+        batch->opened_us = pipeline_now_us();
+        batch->received_sum_us = 0;
+        batch->received_min_us = message->received_us;
+        if (pipeline_state.batch_mode == PIPELINE_BATCH_ARRAY)
+            batch->buffer[batch->length++] = '[';
+    } else if (pipeline_state.batch_mode == PIPELINE_BATCH_ARRAY)
+        batch->buffer[batch->length++] = ',';
+    memcpy(batch->buffer + batch->length, message->json, message->json_length);
+    batch->length += message->json_length;
+    if (pipeline_state.batch_mode == PIPELINE_BATCH_NDJSON)
+        batch->buffer[batch->length++] = '\n';
+    batch->received_sum_us += message->received_us;
+    if (message->received_us < batch->received_min_us)
+        batch->received_min_us = message->received_us;
+    if (++batch->count >= pipeline_state.batch_size)
+        pipeline_batch_flush(batch);
+    return true;
+}
+
+bool pipeline_batch_message(const pipeline_message_t *message) {
+    return pipeline_batch_add(message) || pipeline_publish_message(message);
+}
+
+/* takes every pending message, one per worker per pass so no worker starves another; returns the number that failed */
+uint32_t pipeline_drain(bool (*take)(const pipeline_message_t *message)) {
+    uint32_t failed = 0;
+    bool busy;
+    do {
+        busy = false;
+        for (int i = 0; i < pipeline_state.workers_count; i++) {
+            pipeline_worker_t *worker = &pipeline_state.workers[i];
+            const pipeline_message_t *message = pipeline_ring_peek(&worker->messages);
+            if (message != NULL) {
+                if (!take(message))
+                    failed++;
+                pipeline_ring_release(&worker->messages);
+                pipeline_state.stat_published++;
+                busy = true;
+            }
+        }
+    } while (busy && atomic_load(&pipeline_state.active));
+    return failed;
+}
+
+/* returns milliseconds until the oldest open batch lingers out */
+int pipeline_publish_batched(void) {
+    pipeline_drain(pipeline_batch_message);
+    const uint64_t now_us = pipeline_now_us();
+    int wait_ms = PIPELINE_WAIT_MS;
+    for (int i = 0; i < IOTDATA_VARIANT_MAPS_COUNT; i++) {
+        pipeline_batch_t *batch = &pipeline_state.batches[i];
+        if (batch->count == 0)
+            continue;
+        const uint64_t age_ms = (now_us - batch->opened_us) / 1000;
+        if (age_ms >= pipeline_state.batch_linger_ms)
+            pipeline_batch_flush(batch);
+        else if ((int)(pipeline_state.batch_linger_ms - age_ms) < wait_ms)
+            wait_ms = (int)(pipeline_state.batch_linger_ms - age_ms);
+    }
+    return wait_ms;
+}
+
+/* holds messages in the rings until enough are pending, one ring fills or the oldest lingers out, then publishes them all
+ * into a corked socket so they leave in as few segments as possible; returns milliseconds until the oldest lingers out */
+int pipeline_publish_burst(void) {
+    uint32_t pending = 0;
+    uint64_t oldest_us = UINT64_MAX;
+    bool full = false;
+    for (int i = 0; i < pipeline_state.workers_count; i++) {
+        pipeline_worker_t *worker = &pipeline_state.workers[i];
+        const uint32_t count = pipeline_ring_count(&worker->messages);
+        const pipeline_message_t *message = pipeline_ring_peek(&worker->messages);
+        if (message != NULL && message->received_us < oldest_us)
+            oldest_us = message->received_us;
+        pending += count;
+        if (count >= PIPELINE_MESSAGES_DEPTH)
+            full = true;
+    }
+    if (pending == 0)
+        return PIPELINE_WAIT_MS;
+    const uint64_t age_ms = (pipeline_now_us() - oldest_us) / 1000;
+    if (pending < pipeline_state.batch_size && !full && age_ms < pipeline_state.batch_linger_ms)
+        return (int)(pipeline_state.batch_linger_ms - age_ms);
+    /* this thread writes each publish as it is made (see pipeline_publisher_wait), so the cork spans exactly the burst's writes */
+    const bool corked = mqtt_cork(true);
+    pipeline_state.stat_batch_drops += pipeline_drain(pipeline_publish_message);
+    if (corked)
+        mqtt_cork(false);
+    if (mqtt_want_write()) /* whatever the socket did not take during the burst, rather than at the next poll */
+        mqtt_loop_write();
+    pipeline_state.stat_batches++;
+    return PIPELINE_WAIT_MS;
+}
+
+/* radio thread: a slot for a station snapshot that the publisher will publish, NULL if the ring is full */
+pipeline_snapshot_t *pipeline_snapshot_acquire(void) {
+    return pipeline_ring_acquire(&pipeline_state.snapshots);
+}
+
+void pipeline_snapshot_commit(void) {
+    pipeline_ring_commit(&pipeline_state.snapshots);
+    pipeline_publisher_wake();
+}
+
+void pipeline_publish_snapshots(void) {
+    const pipeline_snapshot_t *snapshot;
+    while ((snapshot = pipeline_ring_peek(&pipeline_state.snapshots)) != NULL) {
+        (void)mqtt_send(snapshot->topic, snapshot->json, (int)snapshot->json_length);
+        pipeline_ring_release(&pipeline_state.snapshots);
+    }
+}
+
+void *pipeline_publisher_func(void *arg) {
+    (void)arg;
+    int wait_ms = PIPELINE_WAIT_MS;
+    while (atomic_load(&pipeline_state.active)) {
+        pipeline_publisher_wait(wait_ms);
+        mqtt_loop_misc(); /* keepalive, reconnect: at least every PIPELINE_WAIT_MS */
+        switch (pipeline_state.batch_mode) {
+        case PIPELINE_BATCH_NDJSON:
+        case PIPELINE_BATCH_ARRAY:
+            wait_ms = pipeline_publish_batched();
+            break;
+        case PIPELINE_BATCH_BURST:
+            wait_ms = pipeline_publish_burst();
+            break;
+        default:
+            pipeline_drain(pipeline_publish_message);
+            wait_ms = PIPELINE_WAIT_MS;
+            break;
+        }
+        pipeline_publish_snapshots();
+    }
+    for (int i = 0; i < IOTDATA_VARIANT_MAPS_COUNT; i++)
+        pipeline_batch_flush(&pipeline_state.batches[i]);
+    return NULL;
+}
+
+/* radio thread: queue a packet for its station's worker, or drop it if that worker is backed up */
+bool pipeline_dispatch(const uint8_t *packet_buffer, int packet_length, uint8_t variant_id, uint16_t station_id, const char *topic_prefix, const char *via) {
+    if (packet_length > PIPELINE_PACKET_MAX)
+        return false;
+    pipeline_worker_t *worker = &pipeline_state.workers[station_id % pipeline_state.workers_count];
+    pipeline_packet_t *packet = pipeline_ring_acquire(&worker->packets);
+    if (packet == NULL) {
+        pipeline_state.stat_full++;
+        return false;
+    }
+    packet->topic_prefix = topic_prefix;
+    packet->station_id = station_id;
+    packet->variant_id = variant_id;
+    packet->via_mesh = via != NULL;
+    packet->received_us = pipeline_now_us();
+    packet->packet_length = packet_length;
+    memcpy(packet->packet_buffer, packet_buffer, (size_t)packet_length);
+    pipeline_ring_commit(&worker->packets);
+    sem_post(&worker->wake);
+    pipeline_state.stat_queued++;
+    return true;
+}
+
+void pipeline_stats(void) {
+    uint32_t decoded = 0, stalls = 0, backlog_packets = 0, backlog_messages = 0;
+    for (int i = 0; i < pipeline_state.workers_count; i++) {
+        pipeline_worker_t *worker = &pipeline_state.workers[i];
+        decoded += atomic_exchange(&worker->stat_decoded, 0);
+        stalls += atomic_exchange(&worker->stat_stalls, 0);
+        backlog_packets += pipeline_ring_count(&worker->packets);
+        backlog_messages += pipeline_ring_count(&worker->messages);
+    }
+    printf(", pipeline{workers=%d, queued=%" PRIu32 ", full=%" PRIu32 ", decoded=%" PRIu32 ", stalls=%" PRIu32 ", published=%" PRIu32 ", backlog=%" PRIu32 "/%" PRIu32, pipeline_state.workers_count, pipeline_state.stat_queued,
+           pipeline_state.stat_full, decoded, stalls, atomic_exchange(&pipeline_state.stat_published, 0), backlog_packets, backlog_messages);
+    pipeline_state.stat_queued = pipeline_state.stat_full = 0;
+    const uint64_t latency_sum_us = atomic_exchange(&pipeline_state.stat_latency_sum_us, 0);
+    const uint32_t latency_count = atomic_exchange(&pipeline_state.stat_latency_count, 0);
+    printf(", latency{avg=%" PRIu64 "us, max=%" PRIu32 "us}", latency_count > 0 ? latency_sum_us / latency_count : 0, atomic_exchange(&pipeline_state.stat_latency_max_us, 0));
+    if (pipeline_state.batch_mode != PIPELINE_BATCH_OFF)
+        printf(", batch{mode=%s, batches=%" PRIu32 ", drops=%" PRIu32 "}", pipeline_batch_modes[pipeline_state.batch_mode], atomic_exchange(&pipeline_state.stat_batches, 0), atomic_exchange(&pipeline_state.stat_batch_drops, 0));
+    printf("}");
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+void config_populate_pipeline(void) {
+    memset(&pipeline_state, 0, sizeof(pipeline_state));
+    pipeline_state.publisher_wake = -1;
+    pipeline_state.workers_count = (int)config_get_integer("process-workers", PROCESS_WORKERS_DEFAULT);
+    if (pipeline_state.workers_count < 0)
+        pipeline_state.workers_count = 0;
+    else if (pipeline_state.workers_count > PIPELINE_WORKERS_MAX)
+        pipeline_state.workers_count = PIPELINE_WORKERS_MAX;
+
+    const char *batch_mode = config_get_string("mqtt-batch", MQTT_BATCH_DEFAULT);
+    pipeline_state.batch_mode = PIPELINE_BATCH_OFF;
+    for (int i = 0; i < (int)(sizeof(pipeline_batch_modes) / sizeof(pipeline_batch_modes[0])); i++)
+        if (strcmp(batch_mode, pipeline_batch_modes[i]) == 0)
+            pipeline_state.batch_mode = (pipeline_batch_mode_t)i;
+    if (pipeline_state.batch_mode == PIPELINE_BATCH_OFF && strcmp(batch_mode, pipeline_batch_modes[PIPELINE_BATCH_OFF]) != 0)
+        fprintf(stderr, "config: pipeline: unknown mqtt-batch '%s', batching off\n", batch_mode);
+    if (pipeline_state.batch_mode != PIPELINE_BATCH_OFF && pipeline_state.workers_count == 0) {
+        fprintf(stderr, "config: pipeline: mqtt-batch requires process-workers, batching off\n");
+        pipeline_state.batch_mode = PIPELINE_BATCH_OFF;
+    }
+    const int batch_linger_ms = config_get_integer("mqtt-batch-linger", MQTT_BATCH_LINGER_DEFAULT), batch_size = config_get_integer("mqtt-batch-size", MQTT_BATCH_SIZE_DEFAULT);
+    pipeline_state.batch_linger_ms = batch_linger_ms < 0 ? 0 : (uint32_t)batch_linger_ms;
+    pipeline_state.batch_size = batch_size < 1 ? 1 : batch_size > PIPELINE_BATCH_SIZE_MAX ? PIPELINE_BATCH_SIZE_MAX : (uint32_t)batch_size;
+
+    printf("config: pipeline: workers=%d%s, batch=%s", pipeline_state.workers_count, pipeline_state.workers_count == 0 ? " (inline)" : "", pipeline_batch_modes[pipeline_state.batch_mode]);
+    if (pipeline_state.batch_mode != PIPELINE_BATCH_OFF)
+        printf(" (linger=%" PRIu32 "ms, size=%" PRIu32 ")", pipeline_state.batch_linger_ms, pipeline_state.batch_size);
+    printf("\n");
+}
+
+void pipeline_workers_stop(void) {
+    atomic_store(&pipeline_state.active, false);
+    for (int i = 0; i < pipeline_state.workers_count; i++) {
+        pipeline_worker_t *worker = &pipeline_state.workers[i];
+        pthread_join(worker->thread, NULL);
+        pipeline_ring_free(&worker->packets);
+        pipeline_ring_free(&worker->messages);
+        sem_destroy(&worker->wake);
+    }
+    if (pipeline_state.publisher_wake >= 0)
+        close(pipeline_state.publisher_wake);
+    pipeline_state.publisher_wake = -1;
+    pipeline_ring_free(&pipeline_state.snapshots);
+    for (int i = 0; i < IOTDATA_VARIANT_MAPS_COUNT; i++) {
+        free(pipeline_state.batches[i].buffer);
+        pipeline_state.batches[i].buffer = NULL;
+    }
+}
+
+bool pipeline_begin(void) {
+    if (pipeline_state.workers_count == 0) {
+        printf("pipeline: no workers, processing inline\n");
+        return true;
+    }
+
+    const int workers_count = pipeline_state.workers_count;
+    int err;
+    atomic_store(&pipeline_state.active, true);
+    if ((pipeline_state.publisher_wake = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) < 0) {
+        fprintf(stderr, "pipeline: eventfd: %s\n", strerror(errno));
+        pipeline_state.workers_count = 0;
+        goto pipeline_fail;
+    }
+    if (!pipeline_ring_init(&pipeline_state.snapshots, PIPELINE_SNAPSHOTS_DEPTH, sizeof(pipeline_snapshot_t))) {
+        fprintf(stderr, "pipeline: ring allocation failed\n");
+        pipeline_state.workers_count = 0;
+        goto pipeline_fail;
+    }
+    if (pipeline_state.batch_mode == PIPELINE_BATCH_NDJSON || pipeline_state.batch_mode == PIPELINE_BATCH_ARRAY)
+        for (int i = 0; i < IOTDATA_VARIANT_MAPS_COUNT; i++)
+            if ((pipeline_state.batches[i].buffer = malloc(PIPELINE_BATCH_BUFFER)) == NULL) {
+                fprintf(stderr, "pipeline: batch allocation failed\n");
+                pipeline_state.workers_count = 0;
+                goto pipeline_fail;
+            }
+    for (pipeline_state.workers_count = 0; pipeline_state.workers_count < workers_count; pipeline_state.workers_count++) {
+        pipeline_worker_t *worker = &pipeline_state.workers[pipeline_state.workers_count];
+        sem_init(&worker->wake, 0, 0);
+        if (!pipeline_ring_init(&worker->packets, PIPELINE_PACKETS_DEPTH, sizeof(pipeline_packet_t)) || !pipeline_ring_init(&worker->messages, PIPELINE_MESSAGES_DEPTH, sizeof(pipeline_message_t))) {
+            fprintf(stderr, "pipeline: ring allocation failed\n");
+            goto pipeline_fail_worker;
+        }
+        if ((err = pthread_create(&worker->thread, NULL, pipeline_worker_func, worker)) != 0) {
+            fprintf(stderr, "pipeline: worker thread create failed: %s\n", strerror(err));
+            goto pipeline_fail_worker;
+        }
+    }
+    if ((err = pthread_create(&pipeline_state.publisher, NULL, pipeline_publisher_func, NULL)) != 0) {
+        fprintf(stderr, "pipeline: publisher thread create failed: %s\n", strerror(err));
+        goto pipeline_fail;
+    }
+
+    printf("pipeline: started, workers=%d, ring-depth=%d/%d, batch=%s\n", pipeline_state.workers_count, PIPELINE_PACKETS_DEPTH, PIPELINE_MESSAGES_DEPTH, pipeline_batch_modes[pipeline_state.batch_mode]);
+    return true;
+
+pipeline_fail_worker:
+    pipeline_ring_free(&pipeline_state.workers[pipeline_state.workers_count].packets);
+    pipeline_ring_free(&pipeline_state.workers[pipeline_state.workers_count].messages);
+    sem_destroy(&pipeline_state.workers[pipeline_state.workers_count].wake);
+pipeline_fail:
+    pipeline_workers_stop();
+    pipeline_state.workers_count = 0;
+    return false;
+}
+
+void pipeline_end(void) {
+    if (pipeline_state.workers_count == 0)
+        return;
+    atomic_store(&pipeline_state.active, false);
+    pthread_join(pipeline_state.publisher, NULL);
+    pipeline_workers_stop();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+#define STATION_COUNT            (IOTDATA_STATION_MAX + 1) /* indexed directly by station id */
+#define STATION_TOPIC            "state"                   /* snapshots go to <prefix>/state/<station_id> */
+#define STATION_JSON_SIZE        PIPELINE_SNAPSHOT_SIZE_MAX
+#define STATION_SNAPSHOT_STEP    32 /* stations rendered per loop pass, so that a sweep of the table never holds up the radios */
+#define STATION_SNAPSHOT_WAIT_MS 10 /* loop pass interval while a sweep is under way */
+
+/* one slot per station, owned by the radio thread: updated as each packet is accepted and rendered from there for snapshots */
+typedef struct {
+    _Alignas(64) time_t seen; /* 0 if never heard */
+    uint32_t packets;
+    uint32_t gaps;       /* sequence jumped forward */
+    uint32_t lost;       /* packets missing across those jumps */
+    uint32_t duplicates; /* sequence repeated */
+    uint32_t resets;     /* sequence went backwards: station restarted */
+    uint32_t rssi_cnt;
+    uint16_t sequence;
+    uint8_t rssi_ema;
+    uint8_t variant_id;
+    bool via_mesh;
+    uint8_t packet_length;
+    uint8_t packet_buffer[E22900T22_PACKET_MAXSIZE]; /* last packet, decoded only when a snapshot is taken */
+} station_t;
+
+struct {
+    time_t interval_snapshot;
+    time_t interval_snapshot_last;
+    int snapshot_cursor; /* next station of the sweep under way, STATION_COUNT if none */
+    station_t stations[STATION_COUNT];
+    /* statistics */
+    uint32_t stat_snapshots;
+} station_state;
+
+void config_populate_station(void) {
+    memset(&station_state, 0, sizeof(station_state));
+    station_state.interval_snapshot = config_get_integer("interval-snapshot", INTERVAL_SNAPSHOT_DEFAULT);
+    station_state.snapshot_cursor = STATION_COUNT;
+
+    printf("config: station: slots=%d (%zu bytes each), snapshot=%" PRIu32 "s%s\n", STATION_COUNT, sizeof(station_t), (uint32_t)station_state.interval_snapshot, station_state.interval_snapshot > 0 ? "" : " (disabled)");
+}
+
+void station_update(const uint8_t *packet_buffer, int packet_length, uint8_t variant_id, uint16_t station_id, uint16_t sequence, uint8_t rssi, bool via_mesh) {
+    if (station_id >= STATION_COUNT || packet_length > (int)sizeof(station_state.stations[0].packet_buffer))
+        return;
+    station_t *station = &station_state.stations[station_id];
+    if (station->packets > 0) {
+        const uint16_t advance = (uint16_t)(sequence - station->sequence);
+        if (advance == 0)
+            station->duplicates++;
+        else if (advance >= 0x8000)
+            station->resets++;
+        else if (advance > 1) {
+            station->gaps++;
+            station->lost += advance - 1U;
+        }
+    }
+    station->seen = time(NULL);
+    station->packets++;
+    station->sequence = sequence;
+    station->variant_id = variant_id;
+    station->via_mesh = via_mesh;
+    if (rssi > 0) /* only for packets heard directly */
+        ema_update(rssi, &station->rssi_ema, &station->rssi_cnt);
+    station->packet_length = (uint8_t)packet_length;
+    memcpy(station->packet_buffer, packet_buffer, (size_t)packet_length);
+}
+
+/* {"station":..,"variant":..,"seen":..,"age":..,"via":..,"packets":..,"sequence":..,"gaps":..,"lost":..,"duplicates":..,"resets":..[,"rssi":..],"last":{..}|null} */
+size_t station_snapshot_json(uint16_t station_id, const station_t *station, time_t now, char *json, size_t json_size) {
+    const iotdata_variant_def_t *vdef = iotdata_get_variant(station->variant_id);
+    size_t n = (size_t)snprintf(json, json_size,
+                                "{\"station\":%" PRIu16 ",\"variant\":\"%s\",\"seen\":%lld,\"age\":%lld,\"via\":\"%s\",\"packets\":%" PRIu32 ",\"sequence\":%" PRIu16 ",\"gaps\":%" PRIu32 ",\"lost\":%" PRIu32
+                                ",\"duplicates\":%" PRIu32 ",\"resets\":%" PRIu32,
+                                station_id, vdef != NULL ? vdef->name : "unknown", (long long)station->seen, (long long)(now - station->seen), station->via_mesh ? "mesh" : "direct", station->packets, station->sequence, station->gaps,
+                                station->lost, station->duplicates, station->resets);
+    if (station->rssi_cnt > 0)
+        n += (size_t)snprintf(json + n, json_size - n, ",\"rssi\":%d", get_rssi_dbm(station->rssi_ema));
+    n += (size_t)snprintf(json + n, json_size - n, ",\"last\":");
+    iotdata_decode_to_json_scratch_t scratch;
+    size_t last_length = 0;
+    if (iotdata_decode_to_json_buffer(station->packet_buffer, station->packet_length, json + n, json_size - n - 1, &last_length, &scratch) == IOTDATA_OK)
+        n += last_length;
+    else
+        n += (size_t)snprintf(json + n, json_size - n, "null");
+    json[n++] = '}';
+    json[n] = '\0';
+    return n;
+}
+
+/* starts a sweep publishing the state of every station heard so far, so a dashboard can start from here rather than replay the
+ * stream; station_snapshot_step() carries it out a few stations per loop pass */
+void station_snapshot_begin(void) {
+    station_state.snapshot_cursor = 0;
+}
+
+bool station_snapshot_active(void) {
+    return station_state.snapshot_cursor < STATION_COUNT;
+}
+
+/* renders the sweep's next STATION_SNAPSHOT_STEP stations heard, handing each to the publisher thread, or publishing it here when
+ * there are no workers (this thread then owns the MQTT client); while the publisher's ring is full the sweep waits for a later pass */
+void station_snapshot_step(void) {
+    static char json[STATION_JSON_SIZE];
+    char topic[PROCESS_TOPIC_SIZE_MAX];
+    const time_t now = time(NULL);
+    for (int rendered = 0; station_state.snapshot_cursor < STATION_COUNT && rendered < STATION_SNAPSHOT_STEP; station_state.snapshot_cursor++) {
+        const int i = station_state.snapshot_cursor;
+        const station_t *station = &station_state.stations[i];
+        if (station->packets == 0)
+            continue;
+        if (pipeline_state.workers_count > 0) {
+            pipeline_snapshot_t *snapshot = pipeline_snapshot_acquire();
+            if (snapshot == NULL)
+                return; /* resumes at this station */
+            snapshot->json_length = station_snapshot_json((uint16_t)i, station, now, snapshot->json, sizeof(snapshot->json));
+            snprintf(snapshot->topic, sizeof(snapshot->topic), "%s/" STATION_TOPIC "/%04X", process_state.mqtt_topic_prefix, i);
+            pipeline_snapshot_commit();
+            station_state.stat_snapshots++;
+        } else {
+            const size_t json_length = station_snapshot_json((uint16_t)i, station, now, json, sizeof(json));
+            snprintf(topic, sizeof(topic), "%s/" STATION_TOPIC "/%04X", process_state.mqtt_topic_prefix, i);
+            if (mqtt_send(topic, json, (int)json_length))
+                station_state.stat_snapshots++;
+        }
+        rendered++;
+    }
+}
+
+void station_stats(time_t period_stat) {
+    const time_t now = time(NULL);
+    uint32_t known = 0, active = 0;
+    for (int i = 0; i < STATION_COUNT; i++)
+        if (station_state.stations[i].packets > 0) {
+            known++;
+            if (now - station_state.stations[i].seen <= period_stat)
+                active++;
+        }
+    printf(", stations{known=%" PRIu32 ", active=%" PRIu32 ", snapshots=%" PRIu32 "}", known, active, station_state.stat_snapshots);
+    station_state.stat_snapshots = 0;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+struct {
+    bool enabled;
+    const char *path;
+    size_t segment_size;
+    uint32_t segments;
+    iotdata_capture_writer_t writer; /* radio thread only */
+    /* statistics */
+    uint32_t stat_records_last;
+    uint32_t stat_rotations_last;
+    uint32_t stat_errors_last;
+} capture_state;
+
+void config_populate_capture(void) {
+    memset(&capture_state, 0, sizeof(capture_state));
+    capture_state.path = config_get_string("capture-path", CAPTURE_PATH_DEFAULT);
+    capture_state.enabled = capture_state.path[0] != '\0';
+    capture_state.segment_size = (size_t)config_get_integer("capture-segment-size", CAPTURE_SEGMENT_SIZE_DEFAULT) * 1024 * 1024;
+    capture_state.segments = (uint32_t)config_get_integer("capture-segments", CAPTURE_SEGMENTS_DEFAULT);
+
+    if (capture_state.enabled)
+        printf("config: capture: path=%s, segment-size=%zuMB, segments=%" PRIu32 "%s\n", capture_state.path, capture_state.segment_size / (1024 * 1024), capture_state.segments, capture_state.segments > 0 ? "" : " (all kept)");
+}
+
+uint64_t capture_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+bool capture_begin(void) {
+    if (!capture_state.enabled)
+        return true;
+    if (!iotdata_capture_open(&capture_state.writer, capture_state.path, capture_state.segment_size, capture_state.segments, capture_now_ns())) {
+        fprintf(stderr, "capture: failed to open segment (path=%s): %s\n", capture_state.path, strerror(errno));
+        return false;
+    }
+    printf("capture: started (segment=%" PRIu32 ")\n", capture_state.writer.segment);
+    return true;
+}
+
+void capture_end(void) {
+    if (!capture_state.enabled)
+        return;
+    printf("capture: stopped (segment=%" PRIu32 ", records=%" PRIu32 ")\n", capture_state.writer.segment, capture_state.writer.stat_records);
+    iotdata_capture_close(&capture_state.writer);
+}
+
+/* appends the raw frame before any processing, so replay sees exactly what the radio delivered */
+void capture_frame(const radio_t *radio, const uint8_t *packet_buffer, int packet_length, uint8_t packet_rssi) {
+    if (capture_state.enabled && packet_length > 0)
+        iotdata_capture_write(&capture_state.writer, capture_now_ns(), (uint8_t)(radio - radio_state.radios), packet_rssi, packet_buffer, (size_t)packet_length);
+}
+
+void capture_stats(void) {
+    if (!capture_state.enabled)
+        return;
+    const iotdata_capture_writer_t *writer = &capture_state.writer;
+    printf(", capture{records=%" PRIu32 ", rotations=%" PRIu32 ", errors=%" PRIu32 ", segment=%" PRIu32 "}", writer->stat_records - capture_state.stat_records_last, writer->stat_rotations - capture_state.stat_rotations_last,
+           writer->stat_errors - capture_state.stat_errors_last, writer->segment);
+    capture_state.stat_records_last = writer->stat_records;
+    capture_state.stat_rotations_last = writer->stat_rotations;
+    capture_state.stat_errors_last = writer->stat_errors;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+void process_sensor_packet(const uint8_t *packet_buffer, int packet_length, uint8_t variant_id, uint16_t station_id, uint16_t sequence, uint8_t rssi, const char *topic_prefix, const char *via) {
     if (via == NULL && mesh_state.enabled)
         if (!dedup_check_and_add(station_id, sequence)) {
             mesh_state.stat_duplicates++;
@@ -733,31 +1841,22 @@ void process_sensor_packet(const uint8_t *packet_buffer, int packet_length, uint
                 printf("mesh: direct packet duplicate suppressed (station=0x%04" PRIX16 ", sequence=%" PRIu16 ")\n", station_id, sequence);
             return;
         }
-    const iotdata_variant_def_t *vdef = iotdata_get_variant(variant_id);
-    if (vdef == NULL) {
+    if (iotdata_get_variant(variant_id) == NULL) {
         fprintf(stderr, "process: unknown variant %" PRIu8 " (station=0x%04" PRIX16 ", size=%d)\n", variant_id, station_id, packet_length);
         process_state.stat_packets_drop++;
         return;
     }
-    char *json = NULL;
-    iotdata_decode_to_json_scratch_t scratch;
-    iotdata_status_t rc;
-    if ((rc = iotdata_decode_to_json(packet_buffer, (size_t)packet_length, &json, &scratch)) != IOTDATA_OK) {
-        fprintf(stderr, "process: decode failed: %s (variant=%" PRIu8 ", station=0x%04" PRIX16 ", size=%d)\n", iotdata_strerror(rc), variant_id, station_id, packet_length);
-        process_state.stat_packets_decode_err++;
+    station_update(packet_buffer, packet_length, variant_id, station_id, sequence, rssi, via != NULL);
+    if (pipeline_state.workers_count > 0) {
+        if (!pipeline_dispatch(packet_buffer, packet_length, variant_id, station_id, topic_prefix, via))
+            process_state.stat_packets_drop++;
         return;
     }
-    char topic[255];
-    snprintf(topic, sizeof(topic), "%s/%s/%04" PRIX16, topic_prefix, vdef->name, station_id);
-    if (mqtt_send(topic, json, (int)strlen(json)))
-        process_state.stat_packets_okay++;
-    else {
-        fprintf(stderr, "process: mqtt send failed (topic=%s, size=%d)\n", topic, (int)strlen(json));
-        process_state.stat_packets_drop++;
-    }
-    if (process_state.debug)
-        printf("  -> %s (%d bytes%s%s)\n", topic, (int)strlen(json), via ? " via " : "", via ? via : "");
-    free(json);
+    static char json[PROCESS_JSON_SIZE_MAX];
+    char topic[PROCESS_TOPIC_SIZE_MAX];
+    size_t json_length = 0;
+    if (process_sensor_decode(packet_buffer, packet_length, variant_id, station_id, topic_prefix, topic, json, &json_length))
+        process_sensor_publish(topic, json, json_length, via);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
@@ -779,7 +1878,7 @@ void process_mesh_packet(const uint8_t *packet_buffer, int packet_length, uint8_
                 fprintf(stderr, "mesh: FORWARD inner packet peek failed (len=%d)\n", inner_len);
                 process_state.stat_packets_drop++;
             } else
-                process_sensor_packet(inner, inner_len, inner_variant, inner_station, inner_sequence, topic_prefix, "mesh");
+                process_sensor_packet(inner, inner_len, inner_variant, inner_station, inner_sequence, 0, topic_prefix, "mesh");
         }
         break;
     }
@@ -815,14 +1914,20 @@ void process_stats(time_t period_stat) {
     printf("packets{okay=%" PRIu32 " (%" PRIu32 ".%02" PRIu32 "/min), drop=%" PRIu32 " (%" PRIu32 ".%02" PRIu32 "/min)}", process_state.stat_packets_okay, rate_okay / 100, rate_okay % 100, process_state.stat_packets_drop, rate_drop / 100,
            rate_drop % 100);
     process_state.stat_packets_okay = process_state.stat_packets_drop = process_state.stat_packets_decode_err = 0;
-    if (process_state.capture_rssi_channel || process_state.capture_rssi_packet) {
-        printf(", rssi{");
-        if (process_state.capture_rssi_channel)
-            printf("channel=%d dBm (%" PRIu32 ")", get_rssi_dbm(process_state.stat_rssi_channel_ema), process_state.stat_rssi_channel_cnt);
-        if (process_state.capture_rssi_channel && process_state.capture_rssi_packet)
-            printf(", ");
-        if (process_state.capture_rssi_packet)
-            printf("packet=%d dBm (%" PRIu32 ")", get_rssi_dbm(process_state.stat_rssi_packet_ema), process_state.stat_rssi_packet_cnt);
+    for (int i = 0; i < radio_state.radios_count; i++) {
+        radio_t *radio = &radio_state.radios[i];
+        printf(", radio[%d]{channel=%d, frames=%" PRIu32 ", bytes=%" PRIu32, i, radio->e22900t22u.channel, radio->stat_frames, radio->stat_bytes);
+        radio->stat_frames = radio->stat_bytes = 0;
+        if (process_state.capture_rssi_channel || process_state.capture_rssi_packet) {
+            printf(", rssi{");
+            if (process_state.capture_rssi_channel)
+                printf("channel=%d dBm (%" PRIu32 ")", get_rssi_dbm(radio->stat_rssi_channel_ema), radio->stat_rssi_channel_cnt);
+            if (process_state.capture_rssi_channel && process_state.capture_rssi_packet)
+                printf(", ");
+            if (process_state.capture_rssi_packet)
+                printf("packet=%d dBm (%" PRIu32 ")", get_rssi_dbm(radio->stat_rssi_packet_ema), radio->stat_rssi_packet_cnt);
+            printf("}");
+        }
         printf("}");
     }
     if (mesh_state.enabled) {
@@ -833,22 +1938,57 @@ void process_stats(time_t period_stat) {
         mesh_state.stat_mesh_ctrl_rx = mesh_state.stat_mesh_unknown = 0;
     }
     if (dedup_state.enabled) {
-        printf(", dedup{sends=%" PRIu32 "/%" PRIu32 ", recvs=%" PRIu32 "/%" PRIu32 ", injected=%" PRIu32 "}", dedup_state.stat_send_cycles, dedup_state.stat_send_entries, dedup_state.stat_recv_cycles, dedup_state.stat_recv_entries,
-               dedup_state.stat_injected);
-        dedup_state.stat_send_cycles = dedup_state.stat_send_entries = 0;
-        dedup_state.stat_recv_cycles = dedup_state.stat_recv_entries = 0;
+        printf(", dedup{sends=%" PRIu32 "/%" PRIu32 " (%" PRIu32 " calls), recvs=%" PRIu32 "/%" PRIu32 " (%" PRIu32 " calls), injected=%" PRIu32 ", full=%" PRIu32 "}", dedup_state.stat_send_cycles, dedup_state.stat_send_entries,
+               dedup_state.stat_send_calls, dedup_state.stat_recv_cycles, dedup_state.stat_recv_entries, dedup_state.stat_recv_calls, dedup_state.stat_injected, atomic_exchange(&dedup_state.stat_pending_full, 0));
+        dedup_state.stat_send_cycles = dedup_state.stat_send_entries = dedup_state.stat_send_calls = 0;
+        dedup_state.stat_recv_cycles = dedup_state.stat_recv_entries = dedup_state.stat_recv_calls = 0;
         dedup_state.stat_injected = 0;
     }
+    station_stats(period_stat);
+    capture_stats();
+    if (pipeline_state.workers_count > 0)
+        pipeline_stats();
     printf(", mqtt{%s, disconnects=%" PRIu32 "}", mqtt_is_connected() ? "up" : "down", mqtt_stat_disconnects);
     printf("\n");
 }
 
-void process_begin(void) {
-    uint8_t packet_buffer[E22900T22_PACKET_MAXSIZE + 1]; /* +1 for RSSI byte */
-    int packet_length;
+void process_frame(radio_t *radio) {
+    uint8_t packet_buffer[E22900T22_PACKET_MAXSIZE + 1], packet_rssi;
+    const int packet_length = radio_frame_take(radio, packet_buffer, &packet_rssi);
+    capture_frame(radio, packet_buffer, packet_length, packet_rssi);
+    radio_select(radio); /* mesh replies go out on the radio the packet came in on */
+    if (process_state.capture_rssi_packet && packet_rssi > 0)
+        ema_update(packet_rssi, &radio->stat_rssi_packet_ema, &radio->stat_rssi_packet_cnt);
+    uint8_t variant_id;
+    uint16_t station_id, sequence;
+    if (iotdata_peek(packet_buffer, (size_t)packet_length, &variant_id, &station_id, &sequence) != IOTDATA_OK) {
+        fprintf(stderr, "process: packet too short for iotdata header (size=%d)\n", packet_length);
+        process_state.stat_packets_drop++;
+    } else if (variant_id == IOTDATA_MESH_VARIANT)
+        process_mesh_packet(packet_buffer, packet_length, variant_id, station_id, sequence, process_state.mqtt_topic_prefix);
+    else
+        process_sensor_packet(packet_buffer, packet_length, variant_id, station_id, sequence, packet_rssi, process_state.mqtt_topic_prefix, NULL);
+}
+
+#define PROCESS_EVENTS_MAX        (RADIO_INTERFACES_MAX + 3)
+#define PROCESS_EVENT_MQTT        RADIO_INTERFACES_MAX /* epoll tags: radios are 0 .. RADIO_INTERFACES_MAX - 1 */
+#define PROCESS_EVENT_DEDUP       (RADIO_INTERFACES_MAX + 1)
+#define PROCESS_EVENT_DEDUP_TIMER (RADIO_INTERFACES_MAX + 2)
+#define PROCESS_WAIT_MS_MAX       1000 /* mqtt keepalive and the interval tasks */
+
+bool process_watch(int epoll_fd, int op, int fd, uint32_t events, uint32_t tag) {
+    struct epoll_event event = { .events = events, .data.u32 = tag };
+    if (epoll_ctl(epoll_fd, op, fd, &event) < 0) {
+        fprintf(stderr, "process: epoll_ctl (fd=%d): %s\n", fd, strerror(errno));
+        return false;
+    }
+    return true;
+}
 
-    printf("process: iotdata gateway (stat=%" PRIu32 "s, rssi=%" PRIu32 "s [packets=%c, channel=%c], topic-prefix=%s", (uint32_t)process_state.interval_stat, (uint32_t)process_state.interval_rssi,
-           process_state.capture_rssi_packet ? 'y' : 'n', process_state.capture_rssi_channel ? 'y' : 'n', process_state.mqtt_topic_prefix);
+/* false if the loop stopped on a failure rather than shutdown, so that the service manager restarts (and reopens the radios) */
+bool process_begin(void) {
+    printf("process: iotdata gateway (stat=%" PRIu32 "s, rssi=%" PRIu32 "s [packets=%c, channel=%c], topic-prefix=%s, workers=%d, radios=%d", (uint32_t)process_state.interval_stat, (uint32_t)process_state.interval_rssi,
+           process_state.capture_rssi_packet ? 'y' : 'n', process_state.capture_rssi_channel ? 'y' : 'n', process_state.mqtt_topic_prefix, pipeline_state.workers_count, radio_state.radios_count);
     if (mesh_state.enabled)
         printf(", mesh=on, beacon=%" PRIu32 "s", (uint32_t)mesh_state.beacon_interval);
     printf(")\n");
@@ -860,45 +2000,125 @@ void process_begin(void) {
     if (mesh_state.enabled)
         printf("process: variant[15] = mesh control (gateway station=0x%04" PRIX16 ")\n", mesh_state.station_id);
 
-    while (running) {
+    const int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        fprintf(stderr, "process: epoll_create1: %s\n", strerror(errno));
+        return false;
+    }
+    bool watching = true;
+    for (int i = 0; i < radio_state.radios_count; i++)
+        watching = watching && process_watch(epoll_fd, EPOLL_CTL_ADD, radio_state.radios[i].fd, EPOLLIN, (uint32_t)i);
+    if (dedup_state.enabled) {
+        watching = watching && process_watch(epoll_fd, EPOLL_CTL_ADD, dedup_state.recv_fd, EPOLLIN, PROCESS_EVENT_DEDUP);
+        watching = watching && process_watch(epoll_fd, EPOLL_CTL_ADD, dedup_state.timer_fd, EPOLLIN, PROCESS_EVENT_DEDUP_TIMER);
+    }
+    /* with workers the publisher thread owns the MQTT client, otherwise this loop does */
+    const bool mqtt_owned = pipeline_state.workers_count == 0;
+    int mqtt_fd = -1;
+    uint32_t mqtt_events = 0;
+
+    while (running && watching) {
+
+        // mqtt socket: replaced on reconnect, writable interest only while mosquitto has output queued
+        const int mqtt_fd_now = mqtt_owned ? mqtt_socket() : -1;
+        const uint32_t mqtt_events_now = EPOLLIN | (mqtt_owned && mqtt_want_write() ? EPOLLOUT : 0);
+        if (mqtt_fd_now != mqtt_fd) {
+            if (mqtt_fd >= 0)
+                (void)epoll_ctl(epoll_fd, EPOLL_CTL_DEL, mqtt_fd, NULL); /* fails harmlessly if already closed */
+            if (mqtt_fd_now >= 0 && !process_watch(epoll_fd, EPOLL_CTL_ADD, mqtt_fd_now, mqtt_events_now, PROCESS_EVENT_MQTT))
+                break;
+            mqtt_fd = mqtt_fd_now;
+            mqtt_events = mqtt_events_now;
+        } else if (mqtt_fd >= 0 && mqtt_events_now != mqtt_events) {
+            if (!process_watch(epoll_fd, EPOLL_CTL_MOD, mqtt_fd, mqtt_events_now, PROCESS_EVENT_MQTT))
+                break;
+            mqtt_events = mqtt_events_now;
+        }
 
-        // packet processing
-        uint8_t packet_rssi = 0, channel_rssi = 0;
-        if (device_packet_read(packet_buffer, sizeof(packet_buffer), &packet_length, &packet_rssi) && running) {
-            if (process_state.capture_rssi_packet && packet_rssi > 0)
-                ema_update(packet_rssi, &process_state.stat_rssi_packet_ema, &process_state.stat_rssi_packet_cnt);
-            uint8_t variant_id;
-            uint16_t station_id, sequence;
-            if (iotdata_peek(packet_buffer, (size_t)packet_length, &variant_id, &station_id, &sequence) != IOTDATA_OK) {
-                fprintf(stderr, "process: packet too short for iotdata header (size=%d)\n", packet_length);
-                process_state.stat_packets_drop++;
-            } else if (variant_id == IOTDATA_MESH_VARIANT)
-                process_mesh_packet(packet_buffer, packet_length, variant_id, station_id, sequence, process_state.mqtt_topic_prefix);
-            else
-                process_sensor_packet(packet_buffer, packet_length, variant_id, station_id, sequence, process_state.mqtt_topic_prefix, NULL);
+        // wait: until a frame goes quiet, the next step of a snapshot sweep or the housekeeping tick (dedup flushes have their own timer)
+        int wait_ms = station_snapshot_active() ? STATION_SNAPSHOT_WAIT_MS : PROCESS_WAIT_MS_MAX, due_ms;
+        for (int i = 0; i < radio_state.radios_count; i++)
+            if ((due_ms = radio_frame_due_ms(&radio_state.radios[i])) >= 0 && due_ms < wait_ms)
+                wait_ms = due_ms;
+        struct epoll_event events[PROCESS_EVENTS_MAX];
+        const int events_count = epoll_wait(epoll_fd, events, PROCESS_EVENTS_MAX, wait_ms);
+        if (events_count < 0 && errno != EINTR) {
+            fprintf(stderr, "process: epoll_wait: %s\n", strerror(errno));
+            break;
+        }
+        for (int i = 0; i < events_count; i++) {
+            const uint32_t tag = events[i].data.u32;
+            if (tag < RADIO_INTERFACES_MAX) {
+                radio_t *radio = &radio_state.radios[tag];
+                errno = 0;
+                /* read while data is waiting, so a hangup only takes the interface down once what it delivered is drained */
+                if (radio->fd >= 0 && ((events[i].events & EPOLLIN) ? !radio_receive(radio) : (events[i].events & (EPOLLERR | EPOLLHUP)) != 0)) {
+                    (void)epoll_ctl(epoll_fd, EPOLL_CTL_DEL, radio->fd, NULL);
+                    radio_down(radio);
+                    if (radio_up_count() == 0) {
+                        fprintf(stderr, "process: no radio interfaces remaining, stopping\n");
+                        watching = false;
+                    }
+                }
+            } else if (tag == PROCESS_EVENT_DEDUP)
+                dedup_recv_from_peers(dedup_state.recv_fd);
+            else if (tag == PROCESS_EVENT_DEDUP_TIMER)
+                dedup_flush();
+            else if (tag == PROCESS_EVENT_MQTT) {
+                if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+                    mqtt_loop_read();
+                if (events[i].events & EPOLLOUT)
+                    mqtt_loop_write();
+            }
         }
 
+        // packet processing
+        for (int i = 0; i < radio_state.radios_count && running; i++)
+            if (radio_frame_due_ms(&radio_state.radios[i]) == 0)
+                process_frame(&radio_state.radios[i]);
+
+        // mqtt keepalive, reconnect
+        if (mqtt_owned)
+            mqtt_loop_misc();
+
         // rssi update
-        if (running && process_state.capture_rssi_channel && intervalable(process_state.interval_rssi, &process_state.interval_rssi_last))
-            if (device_channel_rssi_read(&channel_rssi) && running)
-                ema_update(channel_rssi, &process_state.stat_rssi_channel_ema, &process_state.stat_rssi_channel_cnt);
+        if (running && process_state.capture_rssi_channel)
+            for (int i = 0; i < radio_state.radios_count; i++) {
+                radio_t *radio = &radio_state.radios[i];
+                uint8_t channel_rssi = 0;
+                /* deferred while a frame is part received: the command's response read would consume the rest of it */
+                if (radio->fd >= 0 && radio->frame_length == 0 && intervalable(process_state.interval_rssi, &radio->interval_rssi_last)) {
+                    radio_select(radio);
+                    if (device_channel_rssi_read(&channel_rssi) && running)
+                        ema_update(channel_rssi, &radio->stat_rssi_channel_ema, &radio->stat_rssi_channel_cnt);
+                }
+            }
 
         // mesh beacons
         if (running && mesh_state.enabled && intervalable(mesh_state.beacon_interval, &mesh_state.beacon_last))
             mesh_beacon_send();
 
+        // station snapshots: a sweep starts on the interval, unless the last is still under way, and advances a step per pass
+        if (running && station_state.interval_snapshot > 0 && !station_snapshot_active() && intervalable(station_state.interval_snapshot, &station_state.interval_snapshot_last))
+            station_snapshot_begin();
+        if (running && station_snapshot_active())
+            station_snapshot_step();
+
         // stats output
         time_t period_stat;
         if (running && (period_stat = intervalable(process_state.interval_stat, &process_state.interval_stat_last)) > 0)
             process_stats(period_stat);
     }
+
+    close(epoll_fd);
+    return !running;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
-serial_config_t serial_config;
-e22900t22_config_t e22900t22u_config;
+serial_config_t serial_config;         /* common to all radios */
+e22900t22_config_t e22900t22u_config; /* common to all radios */
 mqtt_config_t mqtt_config;
 
 bool config_setup(const int argc, char *argv[]) {
@@ -908,10 +2128,14 @@ bool config_setup(const int argc, char *argv[]) {
 
     config_populate_serial(&serial_config);
     config_populate_e22900t22u(&e22900t22u_config);
+    config_populate_radio(&serial_config, &e22900t22u_config);
     config_populate_mqtt(&mqtt_config);
     config_populate_mesh();
     config_populate_dedup();
     config_populate_process();
+    config_populate_pipeline();
+    config_populate_station();
+    config_populate_capture();
 
     return true;
 }
@@ -930,42 +2154,42 @@ int main(int argc, char *argv[]) {
     int ret = EXIT_FAILURE;
 
     setbuf(stdout, NULL);
-    printf("starting (iotdata gateway: variants=%d, features=mesh,dedup)\n", IOTDATA_VARIANT_MAPS_COUNT);
+    printf("starting (iotdata gateway: variants=%d, features=mesh,dedup,pipeline,capture)\n", IOTDATA_VARIANT_MAPS_COUNT);
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
     if (!config_setup(argc, argv))
         goto end_all;
 
-    if (!serial_begin(&serial_config) || !serial_connect()) {
-        fprintf(stderr, "device: connect failure (port=%s, rate=%d, bits=%s)\n", serial_config.port, serial_config.rate, serial_bits_str(serial_config.bits));
+    if (!radio_begin())
         goto end_all;
-    }
-    if (!device_connect(E22900T22_MODULE_USB, &e22900t22u_config))
-        goto end_serial;
-    printf("device: connect success (port=%s, rate=%d, bits=%s)\n", serial_config.port, serial_config.rate, serial_bits_str(serial_config.bits));
-
-    if (!(device_mode_config() && device_info_read() && device_config_read_and_update() && device_mode_transfer()))
-        goto end_device;
     if (!mqtt_begin(&mqtt_config))
-        goto end_device;
+        goto end_radio;
     if (!mesh_begin())
         goto end_mqtt;
     if (!dedup_begin())
         goto end_mesh;
+    if (!capture_begin())
+        goto end_dedup;
+    if (!pipeline_begin()) {
+        running = false;
+        goto end_capture;
+    }
 
-    process_begin();
-    ret = EXIT_SUCCESS;
+    if (process_begin())
+        ret = EXIT_SUCCESS;
 
+    pipeline_end();
+end_capture:
+    capture_end();
+end_dedup:
     dedup_end();
 end_mesh:
     mesh_end();
 end_mqtt:
     mqtt_end();
-end_device:
-    device_disconnect();
-end_serial:
-    serial_end();
+end_radio:
+    radio_end();
 end_all:
     return ret;
 }
@@ -0,0 +1,304 @@
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+/*
+ * IoT Sensor Telemetry Protocol
+ * Copyright(C) 2026 Matthew Gream (https://libiotdata.org)
+ *
+ * iotdata_replay.c - decode gateway capture files
+ *
+ * Reads the segment files written by the gateway (capture-path), in the
+ * order given, and decodes every frame with the batch decoder: frames are
+ * referenced in place in the mapped files and decoded in batches, so a
+ * capture replays at decoder speed. Mesh FORWARD frames are unwrapped to
+ * their inner packet; other mesh control frames are counted and skipped.
+ *
+ * Useful to reprocess history after variant map changes (the variant maps
+ * are those compiled in here, not those of the gateway that captured) and
+ * to benchmark the decoder on real traffic.
+ *
+ *   iotdata_replay [options] <file.iotcap> ...
+ *     --batch <n>      frames per decode batch (default 256)
+ *     --realtime       pace frames at their captured intervals
+ *     --speed <x>      as --realtime, x times faster
+ *     --json           print each decoded frame as a JSON line on stdout
+ *
+ * The summary goes to stderr: frames, decode errors by status, frames per
+ * variant, and decode rate.
+ */
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+#include <getopt.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "iotdata_variant_suite.h"
+#include "iotdata.c"
+#include "iotdata_mesh.h"
+#include "iotdata_capture.h"
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+#define REPLAY_BATCH_DEFAULT   256
+#define REPLAY_BATCH_MAX       4096
+#define REPLAY_JSON_SIZE_MAX   16384
+#define REPLAY_STATUS_MAX      256 /* iotdata_status_t values counted */
+#define REPLAY_VARIANTS_COUNT  16 /* 4-bit variant field */
+
+volatile bool running = true;
+
+typedef struct {
+    const iotdata_capture_record_t *record;
+    bool via_mesh;
+} replay_frame_t;
+
+struct {
+    size_t batch_size;
+    bool realtime;
+    double speed;
+    bool json;
+    /* batch, frames referenced in place in the mapped segment */
+    size_t count;
+    const uint8_t **bufs;
+    size_t *lens;
+    replay_frame_t *frames;
+    iotdata_decoded_t *decoded;
+    iotdata_status_t *status;
+    /* pacing */
+    uint64_t pace_capture_ns;
+    uint64_t pace_start_ns;
+    /* statistics */
+    uint32_t stat_files;
+    uint32_t stat_frames;
+    uint32_t stat_short;
+    uint32_t stat_mesh_forwards;
+    uint32_t stat_mesh_control;
+    uint32_t stat_decoded;
+    uint32_t stat_errors;
+    uint32_t stat_batches;
+    uint64_t stat_bytes;
+    uint64_t stat_decode_ns;
+    uint32_t stat_status[REPLAY_STATUS_MAX];
+    uint32_t stat_variants[REPLAY_VARIANTS_COUNT];
+} replay_state;
+
+uint64_t replay_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+void replay_json(const replay_frame_t *frame, const uint8_t *buf, size_t len) {
+    static char json[REPLAY_JSON_SIZE_MAX];
+    iotdata_decode_to_json_scratch_t scratch;
+    size_t json_length;
+    if (iotdata_decode_to_json_buffer(buf, len, json, sizeof(json), &json_length, &scratch) != IOTDATA_OK)
+        return;
+    const iotdata_capture_record_t *record = frame->record;
+    printf("{\"time\":%" PRIu64 ".%09" PRIu64 ",\"interface\":%" PRIu8 ",\"rssi\":%" PRIu8 ",\"via\":\"%s\",\"data\":%.*s}\n", record->timestamp_ns / UINT64_C(1000000000), record->timestamp_ns % UINT64_C(1000000000), record->interface, record->rssi,
+           frame->via_mesh ? "mesh" : "direct", (int)json_length, json);
+}
+
+void replay_flush(void) {
+    if (replay_state.count == 0)
+        return;
+    const uint64_t start_ns = replay_now_ns();
+    const size_t decoded = iotdata_decode_many(replay_state.bufs, replay_state.lens, replay_state.count, replay_state.decoded, replay_state.status);
+    replay_state.stat_decode_ns += replay_now_ns() - start_ns;
+    replay_state.stat_batches++;
+    replay_state.stat_decoded += (uint32_t)decoded;
+    replay_state.stat_errors += (uint32_t)(replay_state.count - decoded);
+    for (size_t i = 0; i < replay_state.count; i++) {
+        const iotdata_status_t rc = replay_state.status[i];
+        if ((unsigned)rc < REPLAY_STATUS_MAX)
+            replay_state.stat_status[rc]++;
+        if (rc != IOTDATA_OK)
+            continue;
+        replay_state.stat_variants[replay_state.decoded[i].variant % REPLAY_VARIANTS_COUNT]++;
+        if (replay_state.json)
+            replay_json(&replay_state.frames[i], replay_state.bufs[i], replay_state.lens[i]);
+    }
+    replay_state.count = 0;
+}
+
+/* holds the frame back until its captured offset from the first frame, scaled by speed, has elapsed */
+void replay_pace(uint64_t timestamp_ns) {
+    if (replay_state.pace_start_ns == 0) {
+        replay_state.pace_start_ns = replay_now_ns();
+        replay_state.pace_capture_ns = timestamp_ns;
+        return;
+    }
+    if (timestamp_ns <= replay_state.pace_capture_ns)
+        return;
+    const uint64_t due_ns = replay_state.pace_start_ns + (uint64_t)((double)(timestamp_ns - replay_state.pace_capture_ns) / replay_state.speed), now_ns = replay_now_ns();
+    if (due_ns <= now_ns)
+        return;
+    replay_flush(); /* frames already due go out before waiting */
+    const uint64_t wait_ns = due_ns - now_ns;
+    const struct timespec ts = { .tv_sec = (time_t)(wait_ns / 1000000000ULL), .tv_nsec = (long)(wait_ns % 1000000000ULL) };
+    nanosleep(&ts, NULL);
+}
+
+void replay_frame(const iotdata_capture_record_t *record, const uint8_t *buf) {
+    size_t len = record->length;
+    replay_state.stat_frames++;
+    replay_state.stat_bytes += len;
+    if (replay_state.realtime)
+        replay_pace(record->timestamp_ns);
+    uint8_t variant_id;
+    uint16_t station_id, sequence;
+    if (iotdata_peek(buf, len, &variant_id, &station_id, &sequence) != IOTDATA_OK) {
+        replay_state.stat_short++;
+        return;
+    }
+    bool via_mesh = false;
+    if (variant_id == IOTDATA_MESH_VARIANT) {
+        iotdata_mesh_forward_t fwd;
+        if (iotdata_mesh_peek_ctrl_type(buf, (int)len) != IOTDATA_MESH_CTRL_FORWARD || !iotdata_mesh_unpack_forward(buf, (int)len, &fwd)) {
+            replay_state.stat_mesh_control++;
+            return;
+        }
+        replay_state.stat_mesh_forwards++;
+        buf = fwd.inner_packet;
+        len = (size_t)fwd.inner_len;
+        via_mesh = true;
+    }
+    replay_state.bufs[replay_state.count] = buf;
+    replay_state.lens[replay_state.count] = len;
+    replay_state.frames[replay_state.count].record = record;
+    replay_state.frames[replay_state.count].via_mesh = via_mesh;
+    if (++replay_state.count == replay_state.batch_size)
+        replay_flush();
+}
+
+bool replay_file(const char *file) {
+    iotdata_capture_reader_t reader;
+    if (!iotdata_capture_reader_open(&reader, file)) {
+        fprintf(stderr, "replay: cannot read '%s': %s\n", file, strerror(errno));
+        return false;
+    }
+    replay_state.stat_files++;
+    const iotdata_capture_record_t *record;
+    const uint8_t *buf;
+    while (running && (record = iotdata_capture_next(&reader, &buf)) != NULL)
+        replay_frame(record, buf);
+    replay_flush(); /* the batch refers into this mapping */
+    iotdata_capture_reader_close(&reader);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+void replay_summary(uint64_t elapsed_ns) {
+    fprintf(stderr, "replay: files=%" PRIu32 ", frames=%" PRIu32 " (%" PRIu64 " bytes), short=%" PRIu32 ", mesh{forwards=%" PRIu32 ", control=%" PRIu32 "}, decoded=%" PRIu32 ", errors=%" PRIu32 "\n", replay_state.stat_files,
+            replay_state.stat_frames, replay_state.stat_bytes, replay_state.stat_short, replay_state.stat_mesh_forwards, replay_state.stat_mesh_control, replay_state.stat_decoded, replay_state.stat_errors);
+    for (int i = 1; i < REPLAY_STATUS_MAX; i++)
+        if (replay_state.stat_status[i] > 0)
+            fprintf(stderr, "replay: error %s: %" PRIu32 "\n", iotdata_strerror((iotdata_status_t)i), replay_state.stat_status[i]);
+    for (int i = 0; i < REPLAY_VARIANTS_COUNT; i++)
+        if (replay_state.stat_variants[i] > 0) {
+            const iotdata_variant_def_t *vdef = iotdata_get_variant((uint8_t)i);
+            fprintf(stderr, "replay: variant %d (%s): %" PRIu32 "\n", i, vdef != NULL ? vdef->name : "unknown", replay_state.stat_variants[i]);
+        }
+    const double decode_s = (double)replay_state.stat_decode_ns / 1e9, frames = (double)(replay_state.stat_decoded + replay_state.stat_errors);
+    fprintf(stderr, "replay: elapsed=%.3fs, decode=%.3fs in %" PRIu32 " batches (%.0f frames/s, %.1f MB/s)\n", (double)elapsed_ns / 1e9, decode_s, replay_state.stat_batches, decode_s > 0 ? frames / decode_s : 0.0,
+            decode_s > 0 ? (double)replay_state.stat_bytes / decode_s / 1e6 : 0.0);
+}
+
+void replay_usage(const char *name) {
+    fprintf(stderr, "usage: %s [--batch <n>] [--realtime] [--speed <x>] [--json] <file.iotcap> ...\n", name);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+void signal_handler(const int sig __attribute__((unused))) {
+    running = false;
+}
+
+int main(int argc, char *argv[]) {
+    // clang-format off
+    static const struct option options[] = {
+        {"batch",    required_argument, 0, 'b'},
+        {"realtime", no_argument,       0, 'r'},
+        {"speed",    required_argument, 0, 's'},
+        {"json",     no_argument,       0, 'j'},
+        {"help",     no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+    // clang-format on
+
+    replay_state.batch_size = REPLAY_BATCH_DEFAULT;
+    replay_state.speed = 1.0;
+    int option;
+    while ((option = getopt_long(argc, argv, "b:rs:jh", options, NULL)) != -1)
+        switch (option) {
+        case 'b':
+            replay_state.batch_size = (size_t)strtoul(optarg, NULL, 0);
+            if (replay_state.batch_size < 1 || replay_state.batch_size > REPLAY_BATCH_MAX) {
+                fprintf(stderr, "replay: batch must be 1 to %d\n", REPLAY_BATCH_MAX);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'r':
+            replay_state.realtime = true;
+            break;
+        case 's':
+            replay_state.realtime = true;
+            replay_state.speed = strtod(optarg, NULL);
+            if (!(replay_state.speed > 0)) {
+                fprintf(stderr, "replay: speed must be positive\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'j':
+            replay_state.json = true;
+            break;
+        default:
+            replay_usage(argv[0]);
+            return option == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    if (optind >= argc) {
+        replay_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    replay_state.bufs = calloc(replay_state.batch_size, sizeof(*replay_state.bufs));
+    replay_state.lens = calloc(replay_state.batch_size, sizeof(*replay_state.lens));
+    replay_state.frames = calloc(replay_state.batch_size, sizeof(*replay_state.frames));
+    replay_state.decoded = calloc(replay_state.batch_size, sizeof(*replay_state.decoded));
+    replay_state.status = calloc(replay_state.batch_size, sizeof(*replay_state.status));
+    if (!replay_state.bufs || !replay_state.lens || !replay_state.frames || !replay_state.decoded || !replay_state.status) {
+        fprintf(stderr, "replay: out of memory (batch=%zu)\n", replay_state.batch_size);
+        return EXIT_FAILURE;
+    }
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    int ret = EXIT_SUCCESS;
+    const uint64_t start_ns = replay_now_ns();
+    for (int i = optind; i < argc && running; i++)
+        if (!replay_file(argv[i]))
+            ret = EXIT_FAILURE;
+    replay_summary(replay_now_ns() - start_ns);
+
+    free(replay_state.bufs);
+    free(replay_state.lens);
+    free(replay_state.frames);
+    free(replay_state.decoded);
+    free(replay_state.status);
+    return ret;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------------------------
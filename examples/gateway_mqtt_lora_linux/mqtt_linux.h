@@ -10,6 +10,10 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
 #include <mosquitto.h>
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
@@ -30,6 +34,8 @@ void (*mqtt_message_callback)(const char *, const unsigned char *, const int) =
 bool mqtt_synchronous = false;
 bool mqtt_connected = false;
 uint32_t mqtt_stat_disconnects = 0;
+unsigned int mqtt_reconnect_delay = 0, mqtt_reconnect_delay_max = 0, mqtt_reconnect_delay_next = 0;
+time_t mqtt_reconnect_last = 0;
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
@@ -114,6 +120,7 @@ static void __mqtt_connect_callback(struct mosquitto *m, void *o __attribute__((
         return;
     }
     mqtt_connected = true;
+    mqtt_reconnect_delay_next = mqtt_reconnect_delay;
     printf("mqtt: connected\n");
 }
 
@@ -137,6 +144,56 @@ void mqtt_loop(const int timeout_ms) {
 
 // -----------------------------------------------------------------------------------------------------------------------------------------
 
+/* synchronous mode with an external event loop: watch mqtt_socket() (it changes across reconnects, -1 while down) for reading, and
+ * for writing while mqtt_want_write(), then call mqtt_loop_read/mqtt_loop_write on readiness and mqtt_loop_misc at least once a second;
+ * the client is not made thread safe (mosquitto_threaded_set), so all of these and every publish must come from the one thread */
+
+int mqtt_socket(void) {
+    return mosq ? mosquitto_socket(mosq) : -1;
+}
+
+bool mqtt_want_write(void) {
+    return mosq && mosquitto_want_write(mosq);
+}
+
+/* hold back partial segments while publishing a burst, then uncork to flush them together; only from the thread driving the client,
+ * as mosquitto_publish writes on the caller's thread and the cork must cover those writes */
+bool mqtt_cork(const bool cork) {
+    const int fd = mqtt_socket();
+    const int value = cork ? 1 : 0;
+    return fd >= 0 && setsockopt(fd, IPPROTO_TCP, TCP_CORK, &value, sizeof(value)) == 0;
+}
+
+void mqtt_loop_read(void) {
+    if (mosq)
+        mosquitto_loop_read(mosq, 1);
+}
+
+void mqtt_loop_write(void) {
+    if (mosq)
+        mosquitto_loop_write(mosq, 1);
+}
+
+void mqtt_loop_misc(void) {
+    if (!mosq)
+        return;
+    if (mosquitto_socket(mosq) >= 0) {
+        mosquitto_loop_misc(mosq);
+        return;
+    }
+    /* no loop thread to reconnect for us: back off exponentially as mosquitto_loop_forever would */
+    const time_t now = time(NULL);
+    if (mqtt_reconnect_delay == 0 || now - mqtt_reconnect_last < (time_t)mqtt_reconnect_delay_next)
+        return;
+    mqtt_reconnect_last = now;
+    const int result = mosquitto_reconnect_async(mosq);
+    if (result != MOSQ_ERR_SUCCESS)
+        fprintf(stderr, "mqtt: reconnect error: %s\n", mosquitto_strerror(result));
+    mqtt_reconnect_delay_next = mqtt_reconnect_delay_next * 2 > mqtt_reconnect_delay_max ? mqtt_reconnect_delay_max : mqtt_reconnect_delay_next * 2;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
 bool mqtt_begin(const mqtt_config_t *cfg) {
     char host[256];
     int port;
@@ -166,6 +223,8 @@ bool mqtt_begin(const mqtt_config_t *cfg) {
     mosquitto_message_callback_set(mosq, __mqtt_message_callback_wrapper);
     if (cfg->reconnect_delay > 0)
         mosquitto_reconnect_delay_set(mosq, cfg->reconnect_delay, cfg->reconnect_delay_max, true);
+    mqtt_reconnect_delay = mqtt_reconnect_delay_next = cfg->reconnect_delay;
+    mqtt_reconnect_delay_max = cfg->reconnect_delay_max > cfg->reconnect_delay ? cfg->reconnect_delay_max : cfg->reconnect_delay;
     int result;
     if ((result = mosquitto_connect(mosq, host, port, MQTT_CONNECT_TIMEOUT)) != MOSQ_ERR_SUCCESS) {
         fprintf(stderr, "mqtt: error connecting to broker: %s\n", mosquitto_strerror(result));
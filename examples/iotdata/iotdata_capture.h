@@ -0,0 +1,281 @@
+/* iotdata_capture.h
+ *
+ * Append-only capture of raw received frames, for later replay.
+ *
+ * A capture is a series of segment files <path>-NNNNNN.iotcap, each a
+ * fixed header followed by records: a fixed record header (timestamp,
+ * RSSI, interface, length) then the raw frame bytes, padded to 8 bytes.
+ * Segments are preallocated and written through a shared mapping, so a
+ * record costs a copy and no system call; the segment header's length
+ * is advanced after each record, so a reader never sees a partial one,
+ * even after a crash. When a record does not fit the writer rotates to
+ * the next segment, optionally deleting the oldest beyond a limit.
+ *
+ * Fields are in host byte order. Linux (POSIX mmap) only.
+ */
+
+#ifndef IOTDATA_CAPTURE_H
+#define IOTDATA_CAPTURE_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------
+ * Format
+ * ----------------------------------------------------------------------- */
+
+#define IOTDATA_CAPTURE_MAGIC                "IOTDCAP"
+#define IOTDATA_CAPTURE_VERSION              1
+#define IOTDATA_CAPTURE_SUFFIX               ".iotcap"
+#define IOTDATA_CAPTURE_ALIGN                8
+#define IOTDATA_CAPTURE_SEGMENT_SIZE_DEFAULT (16 * 1024 * 1024)
+#define IOTDATA_CAPTURE_SEGMENT_SIZE_MIN     (64 * 1024)
+#define IOTDATA_CAPTURE_PATH_MAX             256
+#define IOTDATA_CAPTURE_FILE_MAX             (IOTDATA_CAPTURE_PATH_MAX + 24) /* path, "-", segment, suffix */
+
+typedef struct {
+    char magic[8];        /* IOTDATA_CAPTURE_MAGIC, NUL padded */
+    uint16_t version;     /* IOTDATA_CAPTURE_VERSION */
+    uint16_t header_size; /* offset of the first record */
+    uint32_t segment;     /* sequence number, as in the file name */
+    uint64_t created_ns;  /* CLOCK_REALTIME */
+    uint64_t length;      /* bytes committed, including this header */
+} iotdata_capture_header_t;
+
+typedef struct {
+    uint64_t timestamp_ns; /* CLOCK_REALTIME when the frame was complete */
+    uint16_t length;       /* frame bytes that follow */
+    uint8_t rssi;          /* raw module RSSI byte, 0 if not reported */
+    uint8_t interface;     /* radio index */
+    uint32_t reserved;
+} iotdata_capture_record_t;
+
+#define IOTDATA_CAPTURE_RECORD_SIZE(length) ((sizeof(iotdata_capture_record_t) + (size_t)(length) + IOTDATA_CAPTURE_ALIGN - 1) & ~(size_t)(IOTDATA_CAPTURE_ALIGN - 1))
+
+static inline void iotdata_capture_segment_path(char *out, size_t out_size, const char *path, uint32_t segment) {
+    snprintf(out, out_size, "%s-%06" PRIu32 IOTDATA_CAPTURE_SUFFIX, path, segment);
+}
+
+/* finds the lowest and highest segment numbers present for path, false if there are none */
+static inline bool iotdata_capture_segment_scan(const char *path, uint32_t *first, uint32_t *last) {
+    char directory[IOTDATA_CAPTURE_PATH_MAX];
+    const char *slash = strrchr(path, '/'), *prefix = slash != NULL ? slash + 1 : path;
+    snprintf(directory, sizeof(directory), "%.*s", slash != NULL ? (int)(slash - path) + 1 : 1, slash != NULL ? path : ".");
+    DIR *dir = opendir(directory);
+    if (dir == NULL)
+        return false;
+    const size_t prefix_length = strlen(prefix);
+    bool found = false;
+    const struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        const char *name = entry->d_name;
+        char *end;
+        if (strncmp(name, prefix, prefix_length) != 0 || name[prefix_length] != '-' || name[prefix_length + 1] < '0' || name[prefix_length + 1] > '9')
+            continue;
+        const unsigned long segment = strtoul(name + prefix_length + 1, &end, 10);
+        if (strcmp(end, IOTDATA_CAPTURE_SUFFIX) != 0 || segment > UINT32_MAX)
+            continue;
+        if (!found || (uint32_t)segment < *first)
+            *first = (uint32_t)segment;
+        if (!found || (uint32_t)segment > *last)
+            *last = (uint32_t)segment;
+        found = true;
+    }
+    closedir(dir);
+    return found;
+}
+
+/* -------------------------------------------------------------------------
+ * Writer
+ * ----------------------------------------------------------------------- */
+
+typedef struct {
+    char path[IOTDATA_CAPTURE_PATH_MAX];
+    size_t segment_size;
+    uint32_t segments_max; /* segments kept on disk, 0 for all */
+    uint32_t segment;
+    uint32_t segment_first; /* oldest on disk */
+    int fd;
+    uint8_t *map;
+    size_t offset;
+    /* statistics */
+    uint32_t stat_records;
+    uint32_t stat_rotations;
+    uint32_t stat_errors;
+} iotdata_capture_writer_t;
+
+static inline void iotdata_capture_segment_close(iotdata_capture_writer_t *w) {
+    if (w->map != NULL) {
+        ((iotdata_capture_header_t *)w->map)->length = w->offset;
+        munmap(w->map, w->segment_size);
+        w->map = NULL;
+    }
+    if (w->fd >= 0) {
+        if (ftruncate(w->fd, (off_t)w->offset) < 0) /* give back the unused preallocation */
+            w->stat_errors++;
+        close(w->fd);
+        w->fd = -1;
+    }
+}
+
+/* creates the next free segment at or after w->segment, never overwriting an existing one */
+static inline bool iotdata_capture_segment_open(iotdata_capture_writer_t *w, uint64_t now_ns) {
+    char file[IOTDATA_CAPTURE_FILE_MAX];
+    for (;; w->segment++) {
+        iotdata_capture_segment_path(file, sizeof(file), w->path, w->segment);
+        if ((w->fd = open(file, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644)) >= 0)
+            break;
+        if (errno != EEXIST)
+            return false;
+    }
+    if (posix_fallocate(w->fd, 0, (off_t)w->segment_size) != 0 || (w->map = mmap(NULL, w->segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, w->fd, 0)) == MAP_FAILED) {
+        w->map = NULL;
+        close(w->fd);
+        w->fd = -1;
+        unlink(file);
+        return false;
+    }
+    iotdata_capture_header_t *header = (iotdata_capture_header_t *)w->map;
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, IOTDATA_CAPTURE_MAGIC, sizeof(IOTDATA_CAPTURE_MAGIC));
+    header->version = IOTDATA_CAPTURE_VERSION;
+    header->header_size = sizeof(iotdata_capture_header_t);
+    header->segment = w->segment;
+    header->created_ns = now_ns;
+    header->length = w->offset = sizeof(iotdata_capture_header_t);
+    return true;
+}
+
+/* deletes the oldest segments beyond segments_max, counting the one being written */
+static inline void iotdata_capture_segment_expire(iotdata_capture_writer_t *w) {
+    char file[IOTDATA_CAPTURE_FILE_MAX];
+    if (w->segments_max > 0)
+        while (w->segment - w->segment_first >= w->segments_max) {
+            iotdata_capture_segment_path(file, sizeof(file), w->path, w->segment_first++);
+            unlink(file);
+        }
+}
+
+static inline bool iotdata_capture_open(iotdata_capture_writer_t *w, const char *path, size_t segment_size, uint32_t segments_max, uint64_t now_ns) {
+    memset(w, 0, sizeof(*w));
+    w->fd = -1;
+    snprintf(w->path, sizeof(w->path), "%s", path);
+    w->segment_size = segment_size < IOTDATA_CAPTURE_SEGMENT_SIZE_MIN ? IOTDATA_CAPTURE_SEGMENT_SIZE_MIN : segment_size;
+    w->segments_max = segments_max;
+    uint32_t first, last;
+    if (iotdata_capture_segment_scan(w->path, &first, &last)) { /* continue after segments left by earlier runs */
+        w->segment_first = first;
+        w->segment = last + 1;
+    }
+    if (!iotdata_capture_segment_open(w, now_ns))
+        return false;
+    iotdata_capture_segment_expire(w);
+    return true;
+}
+
+static inline bool iotdata_capture_write(iotdata_capture_writer_t *w, uint64_t timestamp_ns, uint8_t interface, uint8_t rssi, const uint8_t *frame, size_t length) {
+    const size_t size = IOTDATA_CAPTURE_RECORD_SIZE(length);
+    if (length > UINT16_MAX || sizeof(iotdata_capture_header_t) + size > w->segment_size)
+        return false;
+    if (w->map == NULL || w->offset + size > w->segment_size) {
+        iotdata_capture_segment_close(w);
+        w->segment++;
+        if (!iotdata_capture_segment_open(w, timestamp_ns)) {
+            w->stat_errors++;
+            return false;
+        }
+        iotdata_capture_segment_expire(w);
+        w->stat_rotations++;
+    }
+    iotdata_capture_record_t *record = (iotdata_capture_record_t *)(w->map + w->offset);
+    record->timestamp_ns = timestamp_ns;
+    record->length = (uint16_t)length;
+    record->rssi = rssi;
+    record->interface = interface;
+    record->reserved = 0;
+    memcpy(record + 1, frame, length);
+    w->offset += size;
+    __atomic_store_n(&((iotdata_capture_header_t *)w->map)->length, (uint64_t)w->offset, __ATOMIC_RELEASE); /* commit */
+    w->stat_records++;
+    return true;
+}
+
+static inline void iotdata_capture_close(iotdata_capture_writer_t *w) {
+    iotdata_capture_segment_close(w);
+}
+
+/* -------------------------------------------------------------------------
+ * Reader
+ * ----------------------------------------------------------------------- */
+
+typedef struct {
+    int fd;
+    const uint8_t *map;
+    size_t size;   /* mapped */
+    size_t length; /* committed */
+    size_t offset;
+    const iotdata_capture_header_t *header;
+} iotdata_capture_reader_t;
+
+static inline bool iotdata_capture_reader_open(iotdata_capture_reader_t *r, const char *file) {
+    memset(r, 0, sizeof(*r));
+    struct stat st;
+    if ((r->fd = open(file, O_RDONLY | O_CLOEXEC)) < 0)
+        return false;
+    if (fstat(r->fd, &st) < 0 || (size_t)st.st_size < sizeof(iotdata_capture_header_t) || (r->map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, r->fd, 0)) == MAP_FAILED) {
+        r->map = NULL;
+        close(r->fd);
+        r->fd = -1;
+        return false;
+    }
+    r->size = (size_t)st.st_size;
+    r->header = (const iotdata_capture_header_t *)r->map;
+    if (memcmp(r->header->magic, IOTDATA_CAPTURE_MAGIC, sizeof(IOTDATA_CAPTURE_MAGIC)) != 0 || r->header->version != IOTDATA_CAPTURE_VERSION || r->header->header_size < sizeof(iotdata_capture_header_t)) {
+        munmap((void *)(uintptr_t)r->map, r->size);
+        close(r->fd);
+        r->map = NULL;
+        r->fd = -1;
+        errno = EINVAL;
+        return false;
+    }
+    const uint64_t length = __atomic_load_n(&r->header->length, __ATOMIC_ACQUIRE);
+    r->length = length < r->size ? (size_t)length : r->size;
+    r->offset = r->header->header_size;
+    return true;
+}
+
+/* the next record, its frame bytes following it; NULL at the end of the committed data */
+static inline const iotdata_capture_record_t *iotdata_capture_next(iotdata_capture_reader_t *r, const uint8_t **frame) {
+    if (r->offset + sizeof(iotdata_capture_record_t) > r->length)
+        return NULL;
+    const iotdata_capture_record_t *record = (const iotdata_capture_record_t *)(r->map + r->offset);
+    const size_t size = IOTDATA_CAPTURE_RECORD_SIZE(record->length);
+    if (r->offset + size > r->length)
+        return NULL;
+    *frame = (const uint8_t *)(record + 1);
+    r->offset += size;
+    return record;
+}
+
+static inline void iotdata_capture_reader_close(iotdata_capture_reader_t *r) {
+    if (r->map != NULL)
+        munmap((void *)(uintptr_t)r->map, r->size);
+    if (r->fd >= 0)
+        close(r->fd);
+    r->map = NULL;
+    r->fd = -1;
+}
+
+#endif /* IOTDATA_CAPTURE_H */
@@ -19,6 +19,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
+#if !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#endif
 
 /* -------------------------------------------------------------------------
  * Constants
@@ -67,6 +70,10 @@
 /* Dedup ring default size */
 #define IOTDATA_MESH_DEDUP_RING_SIZE    64
 
+/* Dedup window (gateways): one entry per 12-bit station_id */
+#define IOTDATA_MESH_DEDUP_WINDOW_STATIONS 4096
+#define IOTDATA_MESH_DEDUP_WINDOW_BITS     64 /* sequences remembered behind the highest */
+
 /* -------------------------------------------------------------------------
  * iotdata header peek — extract fields from the standard 4-byte header
  * ----------------------------------------------------------------------- */
@@ -282,6 +289,78 @@ static inline bool iotdata_mesh_dedup_check_and_add(iotdata_mesh_dedup_ring_t *r
     return true; /* new */
 }
 
+#if !defined(__STDC_NO_ATOMICS__)
+
+/* -------------------------------------------------------------------------
+ * Duplicate suppression window (per station)
+ *
+ * Anti-replay window in the manner of IPsec (RFC 4303 3.4.3): for each
+ * station the highest sequence seen, a bitmap of the 64 sequences at and
+ * below it, bit n marking highest - n, and when it last accepted a packet.
+ * Sequences are compared modulo 2^16, so wraparound needs no special case.
+ * A sequence ahead of the highest slides the window; one within it is looked
+ * up and marked; one further behind is rejected, being too old to tell from
+ * a replay. A station that has accepted nothing for the caller's timeout
+ * (seconds on the caller's clock, longer than any relay or peer path) starts
+ * a fresh window from its next packet, which is how a restarted station's
+ * sequence is picked up. Fixed at 4096 x 16 bytes = 64 KB, O(1) per packet
+ * and exact over the window. Each entry has its own spinlock, held for a few
+ * instructions, so threads contend only on the same station at the same
+ * moment.
+ * ----------------------------------------------------------------------- */
+
+typedef struct {
+    uint32_t window[2]; /* bit n of the 64 = sequence highest - n seen; split to keep the entry 4-byte aligned */
+    uint32_t accepted;  /* caller's clock at the last new packet */
+    uint16_t highest;
+    bool valid;
+    atomic_flag lock;
+} iotdata_mesh_dedup_window_entry_t;
+
+typedef struct {
+    iotdata_mesh_dedup_window_entry_t stations[IOTDATA_MESH_DEDUP_WINDOW_STATIONS];
+} iotdata_mesh_dedup_window_t;
+
+static inline void iotdata_mesh_dedup_window_init(iotdata_mesh_dedup_window_t *w) {
+    for (int i = 0; i < IOTDATA_MESH_DEDUP_WINDOW_STATIONS; i++) {
+        memset(w->stations[i].window, 0, sizeof(w->stations[i].window));
+        w->stations[i].accepted = 0;
+        w->stations[i].highest = 0;
+        w->stations[i].valid = false;
+        atomic_flag_clear(&w->stations[i].lock);
+    }
+}
+
+/* returns true if this is a NEW packet (not a duplicate); safe to call from any number of threads */
+static inline bool iotdata_mesh_dedup_window_check_and_add(iotdata_mesh_dedup_window_t *w, uint16_t station_id, uint16_t sequence, uint32_t now, uint32_t timeout) {
+    iotdata_mesh_dedup_window_entry_t *e = &w->stations[station_id % IOTDATA_MESH_DEDUP_WINDOW_STATIONS];
+    bool is_new = true;
+    while (atomic_flag_test_and_set_explicit(&e->lock, memory_order_acquire))
+        ;
+    uint64_t window = (uint64_t)e->window[1] << 32 | e->window[0];
+    const int16_t diff = (int16_t)(uint16_t)(sequence - e->highest);
+    if (!e->valid || (int32_t)(now - e->accepted) >= (int32_t)timeout) { /* negative: stamped by a caller slightly ahead */
+        e->valid = true; /* first sight, or quiet long enough to have restarted */
+        e->highest = sequence;
+        window = 1;
+    } else if (diff > 0) {
+        e->highest = sequence;
+        window = diff < IOTDATA_MESH_DEDUP_WINDOW_BITS ? window << diff | 1 : 1;
+    } else if (diff <= -IOTDATA_MESH_DEDUP_WINDOW_BITS || (window & (UINT64_C(1) << -diff)))
+        is_new = false; /* left of the window, or duplicate */
+    else
+        window |= UINT64_C(1) << -diff;
+    if (is_new) {
+        e->window[0] = (uint32_t)window;
+        e->window[1] = (uint32_t)(window >> 32);
+        e->accepted = now;
+    }
+    atomic_flag_clear_explicit(&e->lock, memory_order_release);
+    return is_new;
+}
+
+#endif /* !__STDC_NO_ATOMICS__ */
+
 /* -------------------------------------------------------------------------
  * Generation comparison (modular, 12-bit)
  *
@@ -193,7 +193,7 @@ static e22900t22_config_t e22_config = {
 /*
  * Strip everything except the encoder for minimal ESP32 build:
  *   - NO_DECODE:  no decoder (encoder-only)
- *   - NO_JSON:    no cJSON dependency
+ *   - NO_JSON:    no JSON conversion
  *   - NO_DUMP:    no dump output
  *   - NO_PRINT:   no print output
  *   - NO_FLOATING: iotdata_float_t = int32_t (value * 100)
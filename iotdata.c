@@ -5,7 +5,7 @@
  * iotdata.c - reference implementation body
  *
  * Architecture:
- *   1. Per-field functions (pack, unpack, json_set, json_get, dump, print)
+ *   1. Per-field functions (pack, unpack, json_write, json_get, dump, print)
  *   2. Field dispatcher switches on field type, calls per-field functions
  *   3. Variant table maps field presence bit fields to field types
  *   4. Encoder/decoder iterate fields via variant table, supporting N presence bytes
@@ -26,9 +26,13 @@
 #endif
 
 #if !defined(IOTDATA_NO_JSON)
-#include <cjson/cJSON.h>
+#include <stdlib.h>
+#if !defined(IOTDATA_NO_FLOATING)
+#include <float.h>
+#endif
 #endif
 
+
 /* =========================================================================
  * External Variant maps
  * ========================================================================= */
@@ -100,6 +104,19 @@ const iotdata_variant_def_t *iotdata_get_variant(uint8_t variant) {
 #endif
 #endif
 
+#if defined(IOTDATA_ENABLE_LINK) || defined(IOTDATA_ENABLE_TEMPERATURE) || defined(IOTDATA_ENABLE_ENVIRONMENT) || defined(IOTDATA_ENABLE_WIND_SPEED) || defined(IOTDATA_ENABLE_WIND_GUST) || defined(IOTDATA_ENABLE_WIND) || defined(IOTDATA_ENABLE_RADIATION_DOSE) || \
+    defined(IOTDATA_ENABLE_RADIATION) || defined(IOTDATA_ENABLE_POSITION)
+#define _IOTDATA_NEED_FIXED
+#endif
+
+#if defined(IOTDATA_ENABLE_TLV) || defined(IOTDATA_ENABLE_BATTERY) || defined(IOTDATA_ENABLE_LINK) || defined(IOTDATA_ENABLE_ENVIRONMENT) || defined(IOTDATA_ENABLE_WIND) || defined(IOTDATA_ENABLE_RAIN) || defined(IOTDATA_ENABLE_SOLAR) || defined(IOTDATA_ENABLE_RADIATION) || \
+    defined(IOTDATA_ENABLE_POSITION)
+#define _IOTDATA_NEED_JSON_MEMBER
+#endif
+#if defined(_IOTDATA_NEED_JSON_MEMBER) || defined(IOTDATA_ENABLE_AIR_QUALITY) || defined(IOTDATA_ENABLE_AIR_QUALITY_PM) || defined(IOTDATA_ENABLE_AIR_QUALITY_GAS) || defined(IOTDATA_ENABLE_IMAGE)
+#define _IOTDATA_NEED_JSON_OBJECT
+#endif
+
 #if defined(IOTDATA_ENABLE_TLV)
 #if !defined(IOTDATA_NO_ENCODE)
 #define _IOTDATA_NEED_SIXBIT_ENCODE
@@ -128,7 +145,7 @@ typedef bool (*iotdata_pack_fn)(uint8_t *buf, size_t bb, size_t *bp, const iotda
 #endif
 
 #if !defined(IOTDATA_NO_DECODE)
-typedef bool (*iotdata_unpack_fn)(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec);
+typedef bool (*iotdata_unpack_fn)(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec);
 #define _IOTDATA_FIELD_OP_UNPACK iotdata_unpack_fn unpack;
 #define _IOTDATA_OP_UNPACK(fn)   .unpack = (fn),
 #else
@@ -177,17 +194,524 @@ typedef void (*iotdata_print_fn)(const iotdata_decoded_t *dec, iotdata_buf_t *bp
 #define _IOTDATA_OP_PRINT(fn)
 #endif
 
+#if defined(_IOTDATA_NEED_FIXED) && (!defined(IOTDATA_NO_DUMP) || (!defined(IOTDATA_NO_DECODE) && (!defined(IOTDATA_NO_PRINT) || !defined(IOTDATA_NO_JSON))))
+/*
+ * Fixed-point decimal formatting for quantised values. Each such field has a
+ * resolution that is exact at a known number of decimal places (the field's
+ * _DECIMALS, which is also its NO_FLOATING scale), so the value is taken as an
+ * integer count of units and written digit by digit: no printf, no locale, and
+ * the same text in every build mode. places selects the fractional digits
+ * shown (rounding half away from zero); places < 0 shows all decimals with
+ * trailing zeros trimmed, the shortest text that is exact at the resolution.
+ */
+#define _IOTDATA_FIXED_MAX 24
+static size_t fmt_fixed(char *out, iotdata_double_t v, int decimals, int places) {
+    static const int64_t pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+    int d = places < 0 ? decimals : places;
+#if !defined(IOTDATA_NO_FLOATING)
+    const double s = (double)v * (double)pow10[d];
+    const int64_t units = (int64_t)(s < 0 ? s - 0.5 : s + 0.5);
+#else
+    int64_t units = v;
+    if (d < decimals) {
+        const int64_t q = pow10[decimals - d];
+        units = (units < 0 ? units - q / 2 : units + q / 2) / q;
+    } else
+        units *= pow10[d - decimals];
+#endif
+    uint64_t u = units < 0 ? (uint64_t)0 - (uint64_t)units : (uint64_t)units;
+    if (places < 0)
+        for (; d > 0 && u % 10 == 0; d--)
+            u /= 10;
+    char tmp[_IOTDATA_FIXED_MAX];
+    size_t n = sizeof(tmp);
+    tmp[--n] = '\0';
+    for (int i = 0; i < d; i++, u /= 10)
+        tmp[--n] = (char)('0' + (u % 10));
+    if (d > 0)
+        tmp[--n] = '.';
+    do {
+        tmp[--n] = (char)('0' + (u % 10));
+        u /= 10;
+    } while (u);
+    if (units < 0)
+        tmp[--n] = '-';
+    memcpy(out, &tmp[n], sizeof(tmp) - n);
+    return sizeof(tmp) - n - 1;
+}
+#endif
+
+#if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
+/*
+ * Streaming JSON writer: emits compact JSON directly into a caller buffer,
+ * byte-identical to cJSON_PrintUnformatted() of the equivalent tree but
+ * without any allocation. Like snprintf, output beyond the buffer is
+ * discarded while pos keeps counting, so a zero-size pass measures.
+ */
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t pos;
+    bool first;
+} iotdata_json_t;
+static void jw_put(iotdata_json_t *jw, const char *s, size_t n) {
+    if (jw->pos < jw->size)
+        memcpy(jw->buf + jw->pos, s, n < (jw->size - jw->pos) ? n : (jw->size - jw->pos));
+    jw->pos += n;
+}
+static void jw_putc(iotdata_json_t *jw, char c) {
+    if (jw->pos < jw->size)
+        jw->buf[jw->pos] = c;
+    jw->pos++;
+}
+static void jw_quoted(iotdata_json_t *jw, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    jw_putc(jw, '"');
+    while (*s) {
+        const char *r = s;
+        while ((unsigned char)*r >= 32 && *r != '"' && *r != '\\')
+            r++;
+        jw_put(jw, s, (size_t)(r - s));
+        if (!*r)
+            break;
+        const unsigned char c = (unsigned char)*r;
+        char e[6] = { '\\', (char)c, '0', '0', hex[c >> 4], hex[c & 0x0F] };
+        switch (c) {
+        case '"':
+        case '\\':
+            break;
+        case '\b':
+            e[1] = 'b';
+            break;
+        case '\f':
+            e[1] = 'f';
+            break;
+        case '\n':
+            e[1] = 'n';
+            break;
+        case '\r':
+            e[1] = 'r';
+            break;
+        case '\t':
+            e[1] = 't';
+            break;
+        default:
+            e[1] = 'u';
+            break;
+        }
+        jw_put(jw, e, e[1] == 'u' ? 6 : 2);
+        s = r + 1;
+    }
+    jw_putc(jw, '"');
+}
+static void jw_key(iotdata_json_t *jw, const char *key) {
+    if (!jw->first)
+        jw_putc(jw, ',');
+    jw->first = false;
+    if (key) {
+        jw_quoted(jw, key);
+        jw_putc(jw, ':');
+    }
+}
+static void jw_object_begin(iotdata_json_t *jw, const char *key) {
+    jw_key(jw, key);
+    jw_putc(jw, '{');
+    jw->first = true;
+}
+static void jw_object_end(iotdata_json_t *jw) {
+    jw_putc(jw, '}');
+    jw->first = false;
+}
+#if defined(IOTDATA_ENABLE_TLV)
+static void jw_array_begin(iotdata_json_t *jw, const char *key) {
+    jw_key(jw, key);
+    jw_putc(jw, '[');
+    jw->first = true;
+}
+static void jw_array_end(iotdata_json_t *jw) {
+    jw_putc(jw, ']');
+    jw->first = false;
+}
+#endif
+#if defined(IOTDATA_ENABLE_TLV) || defined(IOTDATA_ENABLE_IMAGE)
+static void jw_string(iotdata_json_t *jw, const char *key, const char *str) {
+    jw_key(jw, key);
+    jw_quoted(jw, str);
+}
+#endif
+#if defined(IOTDATA_ENABLE_BATTERY) || defined(IOTDATA_ENABLE_IMAGE)
+static void jw_bool(iotdata_json_t *jw, const char *key, bool v) {
+    jw_key(jw, key);
+    if (v)
+        jw_put(jw, "true", 4);
+    else
+        jw_put(jw, "false", 5);
+}
+#endif
+static void jw_integer(iotdata_json_t *jw, int64_t v) {
+    char tmp[24];
+    size_t n = sizeof(tmp);
+    uint64_t u = v < 0 ? (uint64_t)0 - (uint64_t)v : (uint64_t)v;
+    do {
+        tmp[--n] = (char)('0' + (u % 10));
+        u /= 10;
+    } while (u);
+    if (v < 0)
+        tmp[--n] = '-';
+    jw_put(jw, &tmp[n], sizeof(tmp) - n);
+}
+#if !defined(IOTDATA_NO_FLOATING)
+static void jw_number(iotdata_json_t *jw, const char *key, double d) {
+    jw_key(jw, key);
+    if (isnan(d) || isinf(d)) {
+        jw_put(jw, "null", 4);
+        return;
+    }
+    /* integral values in int range print as integers, as cJSON's valueint check does */
+    if (d >= (double)INT32_MIN && d <= (double)INT32_MAX) {
+        const double i = (double)(int32_t)d;
+        if (!(i < d) && !(i > d)) {
+            jw_integer(jw, (int32_t)d);
+            return;
+        }
+    }
+    /* shortest of 15 or 17 significant digits that reads back within DBL_EPSILON */
+    char tmp[32];
+    int n = snprintf(tmp, sizeof(tmp), "%1.15g", d);
+    const double r = strtod(tmp, NULL), m = fabs(r) > fabs(d) ? fabs(r) : fabs(d);
+    if (!(fabs(r - d) <= m * DBL_EPSILON))
+        n = snprintf(tmp, sizeof(tmp), "%1.17g", d);
+    if (n > 0)
+        jw_put(jw, tmp, (size_t)n);
+}
+#else
+static void jw_number(iotdata_json_t *jw, const char *key, int64_t v) {
+    jw_key(jw, key);
+    jw_integer(jw, v);
+}
+#endif
+#if defined(_IOTDATA_NEED_FIXED)
+/* Quantised values: the shortest exact decimal, or in NO_FLOATING the scaled integer as before */
+static void jw_fixed(iotdata_json_t *jw, const char *key, iotdata_double_t v, int decimals) {
+#if !defined(IOTDATA_NO_FLOATING)
+    char tmp[_IOTDATA_FIXED_MAX];
+    jw_key(jw, key);
+    jw_put(jw, tmp, fmt_fixed(tmp, v, decimals, -1));
+#else
+    (void)decimals;
+    jw_number(jw, key, v);
+#endif
+}
+#endif
+#endif
+
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-typedef void (*iotdata_json_set_fn)(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch);
-#define _IOTDATA_FIELD_OP_JSON_SET iotdata_json_set_fn json_set;
-#define _IOTDATA_OP_JSON_SET(fn)   .json_set = (iotdata_json_set_fn)(fn),
+typedef void (*iotdata_json_write_fn)(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch);
+#define _IOTDATA_FIELD_OP_JSON_WRITE iotdata_json_write_fn json_write;
+#define _IOTDATA_OP_JSON_WRITE(fn)   .json_write = (iotdata_json_write_fn)(fn),
+#else
+#define _IOTDATA_FIELD_OP_JSON_WRITE
+#define _IOTDATA_OP_JSON_WRITE(fn)
+#endif
+
+#if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
+/*
+ * JSON reader: a single-pass validating scanner over NUL-terminated text.
+ * A value is referenced by a pointer to its first character and read on
+ * demand by the accessors below, so no tree is built and nothing is
+ * allocated. Accessors assume the value has already been validated by
+ * jr_skip(); keys compare case-insensitively, as cJSON_GetObjectItem did.
+ */
+#define _IOTDATA_JSON_DEPTH_MAX 32
+#define _IOTDATA_JSON_KEY_MAX   64
+static const char *jr_ws(const char *p) {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+        p++;
+    return p;
+}
+static bool jr_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+static int jr_hex(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    else if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    else
+        return -1;
+}
+static uint32_t jr_hex4(const char *p) {
+    return (uint32_t)(jr_hex(p[0]) << 12 | jr_hex(p[1]) << 8 | jr_hex(p[2]) << 4 | jr_hex(p[3]));
+}
+static const char *jr_skip_string(const char *p) {
+    for (p++; *p != '"'; p++) {
+        if (!*p)
+            return NULL;
+        if (*p == '\\') {
+            p++;
+            if (*p == 'u') {
+                if (jr_hex(p[1]) < 0 || jr_hex(p[2]) < 0 || jr_hex(p[3]) < 0 || jr_hex(p[4]) < 0)
+                    return NULL;
+                p += 4;
+            } else if (!*p || !strchr("\"\\/bfnrt", *p))
+                return NULL;
+        }
+    }
+    return p + 1;
+}
+static const char *jr_skip_number(const char *p) {
+    if (*p == '-')
+        p++;
+    if (*p == '0')
+        p++;
+    else if (*p >= '1' && *p <= '9')
+        while (jr_digit(*p))
+            p++;
+    else
+        return NULL;
+    if (*p == '.') {
+        if (!jr_digit(*++p))
+            return NULL;
+        while (jr_digit(*p))
+            p++;
+    }
+    if (*p == 'e' || *p == 'E') {
+        if (*++p == '+' || *p == '-')
+            p++;
+        if (!jr_digit(*p))
+            return NULL;
+        while (jr_digit(*p))
+            p++;
+    }
+    return p;
+}
+/* Validates the value at p (after whitespace); returns the position after it, NULL on a syntax error */
+static const char *jr_skip(const char *p, int depth) {
+    p = jr_ws(p);
+    switch (*p) {
+    case '"':
+        return jr_skip_string(p);
+    case '{':
+    case '[': {
+        const char close = *p == '{' ? '}' : ']';
+        if (depth >= _IOTDATA_JSON_DEPTH_MAX)
+            return NULL;
+        if (*(p = jr_ws(p + 1)) == close)
+            return p + 1;
+        for (;;) {
+            if (close == '}') {
+                if (*p != '"' || !(p = jr_skip_string(p)) || *(p = jr_ws(p)) != ':')
+                    return NULL;
+                p++;
+            }
+            if (!(p = jr_skip(p, depth + 1)))
+                return NULL;
+            if (*(p = jr_ws(p)) == close)
+                return p + 1;
+            if (*p != ',')
+                return NULL;
+            p = jr_ws(p + 1);
+        }
+    }
+    case 't':
+        return strncmp(p, "true", 4) == 0 ? p + 4 : NULL;
+    case 'f':
+        return strncmp(p, "false", 5) == 0 ? p + 5 : NULL;
+    case 'n':
+        return strncmp(p, "null", 4) == 0 ? p + 4 : NULL;
+    default:
+        return jr_skip_number(p);
+    }
+}
+/* Unescapes string value v into out (truncated, NUL-terminated); returns the full length, or -1 if v is not a string */
+static int jr_string(const char *v, char *out, size_t size) {
+    if (!v || *v != '"')
+        return -1;
+    size_t n = 0;
+    for (const char *p = v + 1; *p != '"'; p++) {
+        char u[4] = { *p };
+        size_t un = 1;
+        if (*p == '\\')
+            switch (*++p) {
+            case 'b':
+                u[0] = '\b';
+                break;
+            case 'f':
+                u[0] = '\f';
+                break;
+            case 'n':
+                u[0] = '\n';
+                break;
+            case 'r':
+                u[0] = '\r';
+                break;
+            case 't':
+                u[0] = '\t';
+                break;
+            case 'u': {
+                uint32_t c = jr_hex4(p + 1);
+                p += 4;
+                if (c >= 0xD800 && c < 0xDC00 && p[1] == '\\' && p[2] == 'u') {
+                    const uint32_t lo = jr_hex4(p + 3);
+                    if (lo >= 0xDC00 && lo < 0xE000) {
+                        c = 0x10000 + ((c - 0xD800) << 10) + (lo - 0xDC00);
+                        p += 6;
+                    }
+                }
+                if (c < 0x80)
+                    u[0] = (char)c;
+                else if (c < 0x800) {
+                    u[0] = (char)(0xC0 | (c >> 6));
+                    u[1] = (char)(0x80 | (c & 0x3F));
+                    un = 2;
+                } else if (c < 0x10000) {
+                    u[0] = (char)(0xE0 | (c >> 12));
+                    u[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+                    u[2] = (char)(0x80 | (c & 0x3F));
+                    un = 3;
+                } else {
+                    u[0] = (char)(0xF0 | (c >> 18));
+                    u[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+                    u[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+                    u[3] = (char)(0x80 | (c & 0x3F));
+                    un = 4;
+                }
+                break;
+            }
+            default:
+                u[0] = *p;
+                break;
+            }
+        for (size_t i = 0; i < un; i++, n++)
+            if (n + 1 < size)
+                out[n] = u[i];
+    }
+    if (size > 0)
+        out[n < size ? n : size - 1] = '\0';
+    return (int)n;
+}
+static bool jr_true(const char *v) {
+    return v && strncmp(v, "true", 4) == 0;
+}
+#if !defined(IOTDATA_NO_FLOATING)
+static double jr_number(const char *v) {
+    return v && (*v == '-' || jr_digit(*v)) ? strtod(v, NULL) : 0.0;
+}
+/* As cJSON valueint: numbers truncated and clamped to int range, true as 1 */
+static int32_t jr_int(const char *v) {
+    if (jr_true(v))
+        return 1;
+    const double d = jr_number(v);
+    return d >= (double)INT32_MAX ? INT32_MAX : d <= (double)INT32_MIN ? INT32_MIN : (int32_t)d;
+}
 #else
-#define _IOTDATA_FIELD_OP_JSON_SET
-#define _IOTDATA_OP_JSON_SET(fn)
+/* Integer-only: mantissa and decimal exponent, truncated toward zero and clamped */
+static int32_t jr_number(const char *v) {
+    if (!v || !(*v == '-' || jr_digit(*v)))
+        return 0;
+    const bool neg = *v == '-';
+    const char *p = v + (neg ? 1 : 0);
+    int64_t m = 0;
+    int e = 0;
+    for (; jr_digit(*p); p++)
+        if (m < INT64_C(100000000000000000))
+            m = m * 10 + (*p - '0');
+        else
+            e++;
+    if (*p == '.')
+        for (p++; jr_digit(*p); p++)
+            if (m < INT64_C(100000000000000000)) {
+                m = m * 10 + (*p - '0');
+                e--;
+            }
+    if (*p == 'e' || *p == 'E') {
+        const bool eneg = *++p == '-';
+        int x = 0;
+        if (*p == '+' || *p == '-')
+            p++;
+        for (; jr_digit(*p); p++)
+            if (x < 1000)
+                x = x * 10 + (*p - '0');
+        e += eneg ? -x : x;
+    }
+    for (; e > 0 && m && m <= INT32_MAX; e--)
+        m *= 10;
+    for (; e < 0 && m; e++)
+        m /= 10;
+    return neg ? (m > -(int64_t)INT32_MIN ? INT32_MIN : (int32_t)-m) : (m > INT32_MAX ? INT32_MAX : (int32_t)m);
+}
+static int32_t jr_int(const char *v) {
+    return jr_true(v) ? 1 : jr_number(v);
+}
+#endif
+static char jr_lower(char c) {
+    return c >= 'A' && c <= 'Z' ? (char)(c + ('a' - 'A')) : c;
+}
+static bool jr_key_eq(const char *a, const char *b) {
+    for (; *a && jr_lower(*a) == jr_lower(*b); a++, b++)
+        ;
+    return jr_lower(*a) == jr_lower(*b);
+}
+/* Iterates the members of a validated object (key receives the key's string value) or the elements of a validated array (key NULL) */
+typedef struct {
+    const char *p;
+} jr_iter_t;
+static bool jr_iter(jr_iter_t *it, const char *v, char open) {
+    if (!v || *v != open) {
+        it->p = "}"; /* iterates as empty */
+        return false;
+    }
+    it->p = jr_ws(v + 1);
+    return true;
+}
+static const char *jr_next(jr_iter_t *it, const char **key) {
+    const char *p = it->p, *v;
+    if (*p == '}' || *p == ']')
+        return NULL;
+    if (key) {
+        *key = p;
+        p = jr_ws(jr_ws(jr_skip_string(p)) + 1);
+    }
+    v = p;
+    if (*(p = jr_ws(jr_skip(p, 0))) == ',')
+        p = jr_ws(p + 1);
+    it->p = p;
+    return v;
+}
+#if defined(_IOTDATA_NEED_JSON_OBJECT)
+/* Looks up count names in one pass over object v, the first occurrence of each winning; false if v is not an object */
+static bool jr_object(const char *v, const char *const *names, int count, const char **values) {
+    jr_iter_t it;
+    char key[_IOTDATA_JSON_KEY_MAX];
+    for (int i = 0; i < count; i++)
+        values[i] = NULL;
+    if (!jr_iter(&it, v, '{'))
+        return false;
+    const char *m, *k;
+    while ((m = jr_next(&it, &k)) != NULL) {
+        if (jr_string(k, key, sizeof(key)) >= (int)sizeof(key))
+            continue; /* too long to match any name */
+        for (int i = 0; i < count; i++)
+            if (!values[i] && jr_key_eq(key, names[i])) {
+                values[i] = m;
+                break;
+            }
+    }
+    return true;
+}
+#endif
+#if defined(_IOTDATA_NEED_JSON_MEMBER)
+static const char *jr_member(const char *v, const char *name) {
+    const char *m;
+    return jr_object(v, &name, 1, &m) ? m : NULL;
+}
+#endif
 #endif
 
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-typedef iotdata_status_t (*iotdata_json_get_fn)(cJSON *root, const iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch);
+typedef iotdata_status_t (*iotdata_json_get_fn)(const char *json, const iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch);
 #define _IOTDATA_FIELD_OP_JSON_GET iotdata_json_get_fn json_get;
 #define _IOTDATA_OP_JSON_GET(fn)   .json_get = (iotdata_json_get_fn)(fn),
 #else
@@ -202,7 +726,7 @@ typedef struct {
     _IOTDATA_FIELD_OP_UNPACK
     _IOTDATA_FIELD_OP_DUMP
     _IOTDATA_FIELD_OP_PRINT
-    _IOTDATA_FIELD_OP_JSON_SET
+    _IOTDATA_FIELD_OP_JSON_WRITE
     _IOTDATA_FIELD_OP_JSON_GET
 } iotdata_field_ops_t;
 
@@ -216,28 +740,76 @@ static size_t bits_to_bytes(size_t bits) {
 }
 #endif
 
+/*
+ * Word-at-a-time access: fields are at most 32 bits, so a read always lies
+ * within the 64-bit big-endian window starting at its first byte, and a write
+ * within at most two consecutive 8-byte windows.  Windows are loaded and
+ * stored with single unaligned accesses where 8 bytes remain in the buffer,
+ * otherwise only the bytes that exist are assembled (bounds-checked tail).
+ */
+
+#if !defined(IOTDATA_NO_ENCODE) || !defined(IOTDATA_NO_DECODE) || !defined(IOTDATA_NO_DUMP) || defined(IOTDATA_ENABLE_IMAGE)
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && defined(__ORDER_BIG_ENDIAN__)
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define _IOTDATA_BITS_BE64(x) __builtin_bswap64(x)
+#elif __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define _IOTDATA_BITS_BE64(x) (x)
+#endif
+#endif
+static uint64_t bits_window_load(const uint8_t *p, size_t avail) {
+    uint64_t w = 0;
+#if defined(_IOTDATA_BITS_BE64)
+    if (avail >= 8) {
+        memcpy(&w, p, 8);
+        return _IOTDATA_BITS_BE64(w);
+    }
+#else
+    if (avail > 8)
+        avail = 8;
+#endif
+    for (size_t i = 0; i < avail; i++)
+        w |= (uint64_t)p[i] << (56 - 8 * i);
+    return w;
+}
+#endif
+
 #if !defined(IOTDATA_NO_ENCODE)
+static void bits_window_store(uint8_t *p, size_t avail, uint64_t w) {
+#if defined(_IOTDATA_BITS_BE64)
+    if (avail >= 8) {
+        w = _IOTDATA_BITS_BE64(w);
+        memcpy(p, &w, 8);
+        return;
+    }
+#else
+    if (avail > 8)
+        avail = 8;
+#endif
+    for (size_t i = 0; i < avail; i++)
+        p[i] = (uint8_t)(w >> (56 - 8 * i));
+}
+
 static bool bits_write(uint8_t *buf, size_t buf_bits, size_t *bp, uint32_t value, uint8_t nbits) {
     if (*bp + nbits > buf_bits)
         return false;
-    size_t pos = *bp;
-    int rem = nbits, off = pos & 7;
-    if (off) {
-        const int n = rem < (8 - off) ? rem : (8 - off);
-        buf[pos >> 3] = (buf[pos >> 3] & ~(uint8_t)(((1U << n) - 1) << ((8 - off) - n))) | (uint8_t)(((value >> (rem - n)) & ((1U << n) - 1)) << ((8 - off) - n));
-        pos += (size_t)n;
-        rem -= n;
-    }
-    while (rem >= 8) {
-        rem -= 8;
-        buf[pos >> 3] = (uint8_t)(value >> rem);
-        pos += 8;
-    }
-    if (rem > 0) {
-        buf[pos >> 3] = (buf[pos >> 3] & ~(uint8_t)(((1U << rem) - 1) << (8 - rem))) | (uint8_t)((value & ((1U << rem) - 1)) << (8 - rem));
-        pos += (size_t)rem;
+    if (nbits == 0)
+        return true;
+    value &= UINT32_MAX >> (32U - nbits); /* as the byte-wise writer did, bits above nbits are dropped */
+    /* windows are 8-byte aligned relative to buf so consecutive writes reload exactly what was stored */
+    const size_t base = (*bp >> 6) << 3, avail = bits_to_bytes(buf_bits) - base;
+    const unsigned off = (unsigned)(*bp & 63);
+    uint64_t w = bits_window_load(buf + base, avail);
+    if (off + nbits <= 64) {
+        const unsigned shift = 64U - off - nbits;
+        const uint64_t mask = (UINT64_MAX >> (64U - nbits)) << shift;
+        bits_window_store(buf + base, avail, (w & ~mask) | (((uint64_t)value << shift) & mask));
+    } else {
+        const unsigned spill = off + nbits - 64U;
+        bits_window_store(buf + base, avail, (w & ~(UINT64_MAX >> off)) | ((uint64_t)value >> spill));
+        w = bits_window_load(buf + base + 8, avail - 8);
+        bits_window_store(buf + base + 8, avail - 8, (w & (UINT64_MAX >> spill)) | ((uint64_t)value << (64U - spill)));
     }
-    *bp = pos;
+    *bp += nbits;
     return true;
 }
 #endif
@@ -250,26 +822,34 @@ static uint32_t bits_read(const uint8_t *buf, size_t buf_bits, size_t *bp, uint8
             value |= ((uint32_t)((buf[*bp / 8] >> (7 - (*bp % 8))) & 1U) << i);
         return value;
     }
-    uint32_t value = 0;
-    size_t pos = *bp;
-    int rem = nbits, off = pos & 7;
-    if (off) {
-        const int n = rem < (8 - off) ? rem : (8 - off);
-        value = (buf[pos >> 3] >> ((8 - off) - n)) & ((1U << n) - 1);
-        pos += (size_t)n;
-        rem -= n;
-    }
-    while (rem >= 8) {
-        value = (value << 8) | buf[pos >> 3];
-        pos += 8;
-        rem -= 8;
+    if (nbits == 0)
+        return 0;
+    const size_t byte = *bp >> 3;
+    const uint64_t w = bits_window_load(buf + byte, bits_to_bytes(buf_bits) - byte);
+    const uint32_t value = (uint32_t)((w << (*bp & 7)) >> (64U - nbits));
+    *bp += nbits;
+    return value;
+}
+#endif
+
+#if !defined(IOTDATA_NO_DECODE) && (defined(IOTDATA_ENABLE_IMAGE) || defined(IOTDATA_ENABLE_TLV))
+/* Copies n whole bytes starting at bit bp, which the caller has bounds checked */
+static void bits_read_bytes(const uint8_t *buf, size_t bp, uint8_t *out, size_t n) {
+    if ((bp & 7) == 0) {
+        memcpy(out, buf + bp / 8, n);
+        return;
     }
-    if (rem > 0) {
-        value = (value << rem) | ((buf[pos >> 3] >> (8 - rem)) & ((1U << rem) - 1));
-        pos += (size_t)rem;
+    const size_t bb = bp + n * 8;
+    size_t i = 0;
+    for (uint32_t w; i + 4 <= n; i += 4) {
+        w = bits_read(buf, bb, &bp, 32);
+        out[i + 0] = (uint8_t)(w >> 24);
+        out[i + 1] = (uint8_t)(w >> 16);
+        out[i + 2] = (uint8_t)(w >> 8);
+        out[i + 3] = (uint8_t)w;
     }
-    *bp = pos;
-    return value;
+    for (; i < n; i++)
+        out[i] = (uint8_t)bits_read(buf, bb, &bp, 8);
 }
 #endif
 
@@ -327,33 +907,79 @@ static size_t _b64_decode(const char *in, uint8_t *out, size_t out_max) {
 }
 #endif
 
+/*
+ * Six-bit strings: ' ' = 0, 'a'..'z' = 1..26, '0'..'9' = 27..36, 'A'..'Z' =
+ * 37..62. Both directions are table lookups. Encoding flags characters
+ * outside the set with _IOTDATA_SIXBIT_INVALID, so validation is an OR over
+ * the codes in the same pass that produces them; unchecked, they pack as 63
+ * and decode as '?'. Byte-aligned runs convert 4 characters to or from 3
+ * bytes at a time, unaligned runs go through 64-bit windows.
+ */
 #if defined(_IOTDATA_NEED_SIXBIT_ENCODE)
-static int char_to_sixbit(char c) {
-    if (c == ' ')
-        return 0;
-    else if (c >= 'a' && c <= 'z')
-        return 1 + (c - 'a');
-    else if (c >= '0' && c <= '9')
-        return 27 + (c - '0');
-    else if (c >= 'A' && c <= 'Z')
-        return 37 + (c - 'A');
-    else
-        return -1;
+#define _IOTDATA_SIXBIT_INVALID 0x40
+#define _X                      (_IOTDATA_SIXBIT_INVALID | 63)
+static const uint8_t _sixbit_codes[128] = {
+    _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, /* control */
+    _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, /* control */
+    0,  _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, /* ' ' */
+    27, 28, 29, 30, 31, 32, 33, 34, 35, 36, _X, _X, _X, _X, _X, _X, /* '0'..'9' */
+    _X, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, /* 'A'..'O' */
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, _X, _X, _X, _X, _X, /* 'P'..'Z' */
+    _X, 1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, /* 'a'..'o' */
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, _X, _X, _X, _X, _X, /* 'p'..'z' */
+};
+#undef _X
+static uint8_t char_to_sixbit(char c) {
+    return (uint8_t)c < 128 ? _sixbit_codes[(uint8_t)c] : (_IOTDATA_SIXBIT_INVALID | 63);
+}
+#define _IOTDATA_SIXBIT(c) (uint32_t)(char_to_sixbit(c) & 63)
+static bool sixbit_write(uint8_t *buf, size_t bb, size_t *bp, const char *str, size_t n) {
+    if (*bp + n * IOTDATA_TLV_CHAR_BITS > bb)
+        return false;
+    size_t i = 0;
+    if ((*bp & 7) == 0) {
+        uint8_t *p = buf + *bp / 8;
+        for (; i + 4 <= n; i += 4, p += 3) {
+            const uint32_t g = _IOTDATA_SIXBIT(str[i]) << 18 | _IOTDATA_SIXBIT(str[i + 1]) << 12 | _IOTDATA_SIXBIT(str[i + 2]) << 6 | _IOTDATA_SIXBIT(str[i + 3]);
+            p[0] = (uint8_t)(g >> 16);
+            p[1] = (uint8_t)(g >> 8);
+            p[2] = (uint8_t)g;
+        }
+        *bp += i * IOTDATA_TLV_CHAR_BITS;
+    }
+    for (; i + 5 <= n; i += 5)
+        bits_write(buf, bb, bp, _IOTDATA_SIXBIT(str[i]) << 24 | _IOTDATA_SIXBIT(str[i + 1]) << 18 | _IOTDATA_SIXBIT(str[i + 2]) << 12 | _IOTDATA_SIXBIT(str[i + 3]) << 6 | _IOTDATA_SIXBIT(str[i + 4]), 30);
+    for (; i < n; i++)
+        bits_write(buf, bb, bp, _IOTDATA_SIXBIT(str[i]), IOTDATA_TLV_CHAR_BITS);
+    return true;
 }
+#undef _IOTDATA_SIXBIT
 #endif
 
 #if defined(_IOTDATA_NEED_SIXBIT_DECODE)
-static char sixbit_to_char(uint8_t val) {
-    if (val == 0)
-        return ' ';
-    else if (val >= 1 && val <= 26)
-        return 'a' + (char)(val - 1);
-    else if (val >= 27 && val <= 36)
-        return '0' + (char)(val - 27);
-    else if (val >= 37 && val <= 62)
-        return 'A' + (char)(val - 37);
-    else
-        return '?';
+static const char _sixbit_chars[64] = " abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ?";
+/* Unpacks n characters starting at bit bp, which the caller has bounds checked */
+static void sixbit_read(const uint8_t *buf, size_t bp, char *out, size_t n) {
+    const size_t bb = bp + n * IOTDATA_TLV_CHAR_BITS;
+    size_t i = 0;
+    if ((bp & 7) == 0) {
+        for (const uint8_t *p = buf + bp / 8; i + 4 <= n; i += 4, p += 3) {
+            const uint32_t g = (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+            out[i + 0] = _sixbit_chars[g >> 18];
+            out[i + 1] = _sixbit_chars[(g >> 12) & 63];
+            out[i + 2] = _sixbit_chars[(g >> 6) & 63];
+            out[i + 3] = _sixbit_chars[g & 63];
+        }
+        bp += i * IOTDATA_TLV_CHAR_BITS;
+    } else
+        /* 9 characters (54 bits) plus a sub-byte shift always fit one window */
+        for (; i + 9 <= n; i += 9, bp += 54) {
+            const uint64_t w = bits_window_load(buf + bp / 8, bits_to_bytes(bb) - bp / 8) << (bp & 7);
+            for (int k = 0; k < 9; k++)
+                out[i + (size_t)k] = _sixbit_chars[(w >> (58 - 6 * k)) & 63];
+        }
+    for (; i < n; i++)
+        out[i] = _sixbit_chars[bits_read(buf, bb, &bp, IOTDATA_TLV_CHAR_BITS)];
 }
 #endif
 
@@ -387,6 +1013,14 @@ static char sixbit_to_char(uint8_t val) {
 #define CHECK_NOT_DUPLICATE(enc, field_index)
 #endif
 
+/* Completes an encode_* call: store-then-pack records the field, streaming packs it now */
+#if !defined(IOTDATA_ENCODE_STREAMING)
+#define ENCODE_FIELD_DONE(enc, field_index) (IOTDATA_FIELD_SET((enc)->fields, field_index), IOTDATA_OK)
+#else
+static iotdata_status_t _iotdata_encode_stream(iotdata_encoder_t *enc, iotdata_field_type_t type);
+#define ENCODE_FIELD_DONE(enc, field_index) _iotdata_encode_stream(enc, field_index)
+#endif
+
 #endif
 
 #if !defined(IOTDATA_NO_DUMP)
@@ -401,14 +1035,18 @@ static const char *_padd(const char *label) {
 }
 #endif
 
-#if !defined(IOTDATA_NO_DUMP)
-#if defined(IOTDATA_NO_FLOATING)
-static int fmt_scaled(char *buf, size_t sz, int32_t val, int32_t divisor, const char *unit) {
-    const uint32_t a = (val < 0) ? -(uint32_t)val : (uint32_t)val;
-    return snprintf(buf, sz, "%s%" PRIu32 ".%01" PRIu32 "%s%s", val < 0 ? "-" : "", a / (uint32_t)divisor, a % (uint32_t)divisor, unit[0] ? " " : "", unit);
+#if !defined(IOTDATA_NO_DUMP) && defined(_IOTDATA_NEED_FIXED)
+static void fmt_fixed_unit(char *buf, size_t sz, iotdata_double_t v, int decimals, int places, const char *unit) {
+    char tmp[_IOTDATA_FIXED_MAX + 8];
+    size_t n = fmt_fixed(tmp, v, decimals, places);
+    if (unit[0])
+        for (tmp[n++] = ' '; *unit && n < sizeof(tmp) - 1;)
+            tmp[n++] = *unit++;
+    n = n < sz ? n : sz - 1;
+    memcpy(buf, tmp, n);
+    buf[n] = '\0';
 }
 #endif
-#endif
 
 /* =========================================================================
  * Field BATTERY
@@ -425,8 +1063,7 @@ iotdata_status_t iotdata_encode_battery(iotdata_encoder_t *enc, uint8_t level_pe
 #endif
     enc->battery_level = level_percent;
     enc->battery_charging = charging;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_BATTERY);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_BATTERY);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -455,7 +1092,7 @@ static bool pack_battery(uint8_t *buf, size_t bb, size_t *bp, const iotdata_enco
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_battery(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_battery(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_BATTERY_LEVEL_BITS + IOTDATA_BATTERY_CHARGE_BITS > bb)
         return false;
     dec->battery_level = dequantise_battery_level(bits_read(buf, bb, bp, IOTDATA_BATTERY_LEVEL_BITS));
@@ -464,23 +1101,21 @@ static bool unpack_battery(const uint8_t *buf, size_t bb, size_t *bp, iotdata_de
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_battery(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_battery(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    cJSON *j_level = cJSON_GetObjectItem(j, "level"), *j_charging = cJSON_GetObjectItem(j, "charging");
+    const char *j_level = jr_member(j, "level"), *j_charging = jr_member(j, "charging");
     if (!j_level)
         return IOTDATA_OK;
-    return iotdata_encode_battery(enc, (uint8_t)j_level->valueint, cJSON_IsTrue(j_charging));
+    return iotdata_encode_battery(enc, (uint8_t)jr_int(j_level), jr_true(j_charging));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_battery(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_battery(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *obj = cJSON_AddObjectToObject(root, label);
-    cJSON_AddNumberToObject(obj, "level", dec->battery_level);
-    cJSON_AddBoolToObject(obj, "charging", dec->battery_charging);
+    jw_object_begin(jw, label);
+    jw_number(jw, "level", dec->battery_level);
+    jw_bool(jw, "charging", dec->battery_charging);
+    jw_object_end(jw);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -510,7 +1145,7 @@ static const iotdata_field_ops_t _iotdata_field_def_battery = {
     _IOTDATA_OP_UNPACK(unpack_battery)
     _IOTDATA_OP_DUMP(dump_battery)
     _IOTDATA_OP_PRINT(print_battery)
-    _IOTDATA_OP_JSON_SET(json_set_battery)
+    _IOTDATA_OP_JSON_WRITE(json_write_battery)
     _IOTDATA_OP_JSON_GET(json_get_battery)
 };
 #define _IOTDATA_ENT_BATTERY [IOTDATA_FIELD_BATTERY] = &_iotdata_field_def_battery,
@@ -544,8 +1179,7 @@ iotdata_status_t iotdata_encode_link(iotdata_encoder_t *enc, int16_t rssi_dbm, i
 #endif
     enc->link_rssi = rssi_dbm;
     enc->link_snr = snr_db;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_LINK);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_LINK);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -587,7 +1221,7 @@ static bool pack_link(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encoder
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_link(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_link(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_LINK_RSSI_BITS + IOTDATA_LINK_SNR_BITS > bb)
         return false;
     dec->link_rssi = dequantise_link_rssi(bits_read(buf, bb, bp, IOTDATA_LINK_RSSI_BITS));
@@ -596,23 +1230,21 @@ static bool unpack_link(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decod
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_link(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_link(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    cJSON *j_rssi = cJSON_GetObjectItem(j, "rssi"), *j_snr = cJSON_GetObjectItem(j, "snr");
+    const char *j_rssi = jr_member(j, "rssi"), *j_snr = jr_member(j, "snr");
     if (!j_rssi || !j_snr)
         return IOTDATA_OK;
-    return iotdata_encode_link(enc, (int16_t)j_rssi->valueint, (iotdata_float_t)j_snr->valuedouble);
+    return iotdata_encode_link(enc, (int16_t)jr_int(j_rssi), (iotdata_float_t)jr_number(j_snr));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_link(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_link(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *obj = cJSON_AddObjectToObject(root, label);
-    cJSON_AddNumberToObject(obj, "rssi", dec->link_rssi);
-    cJSON_AddNumberToObject(obj, "snr", dec->link_snr);
+    jw_object_begin(jw, label);
+    jw_number(jw, "rssi", dec->link_rssi);
+    jw_fixed(jw, "snr", dec->link_snr, IOTDATA_LINK_SNR_DECIMALS);
+    jw_object_end(jw);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -624,22 +1256,16 @@ static int dump_link(const uint8_t *buf, size_t bb, size_t *bp, iotdata_dump_t *
     n = dump_add(dump, n, s, IOTDATA_LINK_RSSI_BITS, r, dump->_dec_buf, "-120..-60, 4dBm", "link_rssi");
     s = *bp;
     r = bits_read(buf, bb, bp, IOTDATA_LINK_SNR_BITS);
-#if !defined(IOTDATA_NO_FLOATING)
-    snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%.0f dB", dequantise_link_snr(r));
-#else
-    fmt_scaled(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_link_snr(r), 10, "dB");
-#endif
+    fmt_fixed_unit(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_link_snr(r), IOTDATA_LINK_SNR_DECIMALS, 0, "dB");
     n = dump_add(dump, n, s, IOTDATA_LINK_SNR_BITS, r, dump->_dec_buf, "-20..+10, 10dB", "link_snr");
     return n;
 }
 #endif
 #if !defined(IOTDATA_NO_PRINT) && !defined(IOTDATA_NO_DECODE)
 static void print_link(const iotdata_decoded_t *dec, iotdata_buf_t *bp, const char *label) {
-#if !defined(IOTDATA_NO_FLOATING)
-    bprintf(bp, "  %s:%s %" PRIu16 " dBm RSSI, %.0f dB SNR\n", label, _padd(label), dec->link_rssi, dec->link_snr);
-#else
-    bprintf(bp, "  %s:%s %" PRIu16 " dBm RSSI, %d.%d dB SNR\n", label, _padd(label), dec->link_rssi, dec->link_snr / 10, dec->link_snr % 10);
-#endif
+    char snr[_IOTDATA_FIXED_MAX];
+    fmt_fixed(snr, dec->link_snr, IOTDATA_LINK_SNR_DECIMALS, 0);
+    bprintf(bp, "  %s:%s %" PRIu16 " dBm RSSI, %s dB SNR\n", label, _padd(label), dec->link_rssi, snr);
 }
 #endif
 // clang-format off
@@ -650,7 +1276,7 @@ static const iotdata_field_ops_t _iotdata_field_def_link = {
     _IOTDATA_OP_UNPACK(unpack_link)
     _IOTDATA_OP_DUMP(dump_link)
     _IOTDATA_OP_PRINT(print_link)
-    _IOTDATA_OP_JSON_SET(json_set_link)
+    _IOTDATA_OP_JSON_WRITE(json_write_link)
     _IOTDATA_OP_JSON_GET(json_get_link)
 };
 #define _IOTDATA_ENT_LINK [IOTDATA_FIELD_LINK] = &_iotdata_field_def_link,
@@ -685,8 +1311,7 @@ iotdata_status_t iotdata_encode_temperature(iotdata_encoder_t *enc, iotdata_floa
         return IOTDATA_ERR_TEMPERATURE_HIGH;
 #endif
     enc->temperature = temperature_c;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_TEMPERATURE);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_TEMPERATURE);
 }
 #endif
 #if !defined(IOTDATA_NO_FLOATING)
@@ -718,7 +1343,7 @@ static bool pack_temperature(uint8_t *buf, size_t bb, size_t *bp, const iotdata_
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_temperature(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_temperature(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_TEMPERATURE_BITS > bb)
         return false;
     dec->temperature = dequantise_temperature(bits_read(buf, bb, bp, IOTDATA_TEMPERATURE_BITS));
@@ -726,18 +1351,15 @@ static bool unpack_temperature(const uint8_t *buf, size_t bb, size_t *bp, iotdat
 }
 #endif
 #if defined(IOTDATA_ENABLE_TEMPERATURE) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_temperature(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_temperature(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_temperature(enc, (iotdata_float_t)j->valuedouble);
+    return iotdata_encode_temperature(enc, (iotdata_float_t)jr_number(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_temperature(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_temperature(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->temperature);
+    jw_fixed(jw, label, dec->temperature, IOTDATA_TEMPERATURE_DECIMALS);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -745,23 +1367,16 @@ static int dump_temperature(const uint8_t *buf, size_t bb, size_t *bp, iotdata_d
     (void)label;
     size_t s = *bp;
     uint32_t r = bits_read(buf, bb, bp, IOTDATA_TEMPERATURE_BITS);
-#if !defined(IOTDATA_NO_FLOATING)
-    snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%.2f C", dequantise_temperature(r));
-#else
-    fmt_scaled(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_temperature(r), 100, "C");
-#endif
+    fmt_fixed_unit(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_temperature(r), IOTDATA_TEMPERATURE_DECIMALS, 2, "C");
     n = dump_add(dump, n, s, IOTDATA_TEMPERATURE_BITS, r, dump->_dec_buf, "-40..+80C, 0.25C", "temperature");
     return n;
 }
 #endif
 #if defined(IOTDATA_ENABLE_TEMPERATURE) && !defined(IOTDATA_NO_PRINT) && !defined(IOTDATA_NO_DECODE)
 static void print_temperature(const iotdata_decoded_t *dec, iotdata_buf_t *bp, const char *label) {
-#if !defined(IOTDATA_NO_FLOATING)
-    bprintf(bp, "  %s:%s %.2f C\n", label, _padd(label), dec->temperature);
-#else
-    const int32_t ta = dec->temperature < 0 ? -(dec->temperature) : dec->temperature;
-    bprintf(bp, "  %s:%s %s%d.%02d C\n", label, _padd(label), dec->temperature < 0 ? "-" : "", ta / 100, ta % 100);
-#endif
+    char t[_IOTDATA_FIXED_MAX];
+    fmt_fixed(t, dec->temperature, IOTDATA_TEMPERATURE_DECIMALS, 2);
+    bprintf(bp, "  %s:%s %s C\n", label, _padd(label), t);
 }
 #endif
 // clang-format off
@@ -773,7 +1388,7 @@ static const iotdata_field_ops_t _iotdata_field_def_temperature = {
     _IOTDATA_OP_UNPACK(unpack_temperature)
     _IOTDATA_OP_DUMP(dump_temperature)
     _IOTDATA_OP_PRINT(print_temperature)
-    _IOTDATA_OP_JSON_SET(json_set_temperature)
+    _IOTDATA_OP_JSON_WRITE(json_write_temperature)
     _IOTDATA_OP_JSON_GET(json_get_temperature)
 };
 #define _IOTDATA_ENT_TEMPERATURE [IOTDATA_FIELD_TEMPERATURE] = &_iotdata_field_def_temperature,
@@ -803,8 +1418,7 @@ iotdata_status_t iotdata_encode_pressure(iotdata_encoder_t *enc, uint16_t pressu
         return IOTDATA_ERR_PRESSURE_HIGH;
 #endif
     enc->pressure = pressure_hpa;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_PRESSURE);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_PRESSURE);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -823,7 +1437,7 @@ static bool pack_pressure(uint8_t *buf, size_t bb, size_t *bp, const iotdata_enc
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_pressure(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_pressure(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_PRESSURE_BITS > bb)
         return false;
     dec->pressure = dequantise_pressure(bits_read(buf, bb, bp, IOTDATA_PRESSURE_BITS));
@@ -831,18 +1445,15 @@ static bool unpack_pressure(const uint8_t *buf, size_t bb, size_t *bp, iotdata_d
 }
 #endif
 #if defined(IOTDATA_ENABLE_PRESSURE) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_pressure(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_pressure(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_pressure(enc, (uint16_t)j->valueint);
+    return iotdata_encode_pressure(enc, (uint16_t)jr_int(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_pressure(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_pressure(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->pressure);
+    jw_number(jw, label, dec->pressure);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -869,7 +1480,7 @@ static const iotdata_field_ops_t _iotdata_field_def_pressure = {
     _IOTDATA_OP_UNPACK(unpack_pressure)
     _IOTDATA_OP_DUMP(dump_pressure)
     _IOTDATA_OP_PRINT(print_pressure)
-    _IOTDATA_OP_JSON_SET(json_set_pressure)
+    _IOTDATA_OP_JSON_WRITE(json_write_pressure)
     _IOTDATA_OP_JSON_GET(json_get_pressure)
 };
 #define _IOTDATA_ENT_PRESSURE [IOTDATA_FIELD_PRESSURE] = &_iotdata_field_def_pressure,
@@ -897,8 +1508,7 @@ iotdata_status_t iotdata_encode_humidity(iotdata_encoder_t *enc, uint8_t humidit
         return IOTDATA_ERR_HUMIDITY_HIGH;
 #endif
     enc->humidity = humidity_pct;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_HUMIDITY);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_HUMIDITY);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -917,7 +1527,7 @@ static bool pack_humidity(uint8_t *buf, size_t bb, size_t *bp, const iotdata_enc
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_humidity(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_humidity(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_HUMIDITY_BITS > bb)
         return false;
     dec->humidity = dequantise_humidity(bits_read(buf, bb, bp, IOTDATA_HUMIDITY_BITS));
@@ -925,18 +1535,15 @@ static bool unpack_humidity(const uint8_t *buf, size_t bb, size_t *bp, iotdata_d
 }
 #endif
 #if defined(IOTDATA_ENABLE_HUMIDITY) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_humidity(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_humidity(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_humidity(enc, (uint8_t)j->valueint);
+    return iotdata_encode_humidity(enc, (uint8_t)jr_int(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_humidity(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_humidity(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->humidity);
+    jw_number(jw, label, dec->humidity);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -963,7 +1570,7 @@ static const iotdata_field_ops_t _iotdata_field_def_humidity = {
     _IOTDATA_OP_UNPACK(unpack_humidity)
     _IOTDATA_OP_DUMP(dump_humidity)
     _IOTDATA_OP_PRINT(print_humidity)
-    _IOTDATA_OP_JSON_SET(json_set_humidity)
+    _IOTDATA_OP_JSON_WRITE(json_write_humidity)
     _IOTDATA_OP_JSON_GET(json_get_humidity)
 };
 #define _IOTDATA_ENT_HUMIDITY [IOTDATA_FIELD_HUMIDITY] = &_iotdata_field_def_humidity,
@@ -999,8 +1606,7 @@ iotdata_status_t iotdata_encode_environment(iotdata_encoder_t *enc, iotdata_floa
     enc->temperature = temperature_c;
     enc->pressure = pressure_hpa;
     enc->humidity = humidity_pct;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_ENVIRONMENT);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_ENVIRONMENT);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -1009,28 +1615,26 @@ static bool pack_environment(uint8_t *buf, size_t bb, size_t *bp, const iotdata_
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_environment(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_environment(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     return unpack_temperature(buf, bb, bp, dec) && unpack_pressure(buf, bb, bp, dec) && unpack_humidity(buf, bb, bp, dec);
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_environment(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_environment(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    cJSON *j_temperature = cJSON_GetObjectItem(j, "temperature"), *j_pressure = cJSON_GetObjectItem(j, "pressure"), *j_humidity = cJSON_GetObjectItem(j, "humidity");
+    const char *j_temperature = jr_member(j, "temperature"), *j_pressure = jr_member(j, "pressure"), *j_humidity = jr_member(j, "humidity");
     if (!j_temperature || !j_pressure || !j_humidity)
         return IOTDATA_OK;
-    return iotdata_encode_environment(enc, (iotdata_float_t)j_temperature->valuedouble, (uint16_t)j_pressure->valueint, (uint8_t)j_humidity->valueint);
+    return iotdata_encode_environment(enc, (iotdata_float_t)jr_number(j_temperature), (uint16_t)jr_int(j_pressure), (uint8_t)jr_int(j_humidity));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_environment(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
-    cJSON *obj = cJSON_AddObjectToObject(root, label);
-    json_set_temperature(obj, dec, "temperature", scratch);
-    json_set_pressure(obj, dec, "pressure", scratch);
-    json_set_humidity(obj, dec, "humidity", scratch);
+static void json_write_environment(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+    jw_object_begin(jw, label);
+    json_write_temperature(jw, dec, "temperature", scratch);
+    json_write_pressure(jw, dec, "pressure", scratch);
+    json_write_humidity(jw, dec, "humidity", scratch);
+    jw_object_end(jw);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -1043,12 +1647,9 @@ static int dump_environment(const uint8_t *buf, size_t bb, size_t *bp, iotdata_d
 #endif
 #if !defined(IOTDATA_NO_PRINT) && !defined(IOTDATA_NO_DECODE)
 static void print_environment(const iotdata_decoded_t *dec, iotdata_buf_t *bp, const char *label) {
-#if !defined(IOTDATA_NO_FLOATING)
-    bprintf(bp, "  %s:%s %.2f C, %" PRIu16 " hPa, %" PRIu8 "%%\n", label, _padd(label), dec->temperature, dec->pressure, dec->humidity);
-#else
-    const int32_t ta = dec->temperature < 0 ? -(dec->temperature) : dec->temperature;
-    bprintf(bp, "  %s:%s %s%d.%02d C, %" PRIu16 " hPa, %" PRIu8 "%%\n", label, _padd(label), dec->temperature < 0 ? "-" : "", ta / 100, ta % 100, dec->pressure, dec->humidity);
-#endif
+    char t[_IOTDATA_FIXED_MAX];
+    fmt_fixed(t, dec->temperature, IOTDATA_TEMPERATURE_DECIMALS, 2);
+    bprintf(bp, "  %s:%s %s C, %" PRIu16 " hPa, %" PRIu8 "%%\n", label, _padd(label), t, dec->pressure, dec->humidity);
 }
 #endif
 // clang-format off
@@ -1059,7 +1660,7 @@ static const iotdata_field_ops_t _iotdata_field_def_environment = {
     _IOTDATA_OP_UNPACK(unpack_environment)
     _IOTDATA_OP_DUMP(dump_environment)
     _IOTDATA_OP_PRINT(print_environment)
-    _IOTDATA_OP_JSON_SET(json_set_environment)
+    _IOTDATA_OP_JSON_WRITE(json_write_environment)
     _IOTDATA_OP_JSON_GET(json_get_environment)
 };
 #define _IOTDATA_ENT_ENVIRONMENT [IOTDATA_FIELD_ENVIRONMENT] = &_iotdata_field_def_environment,
@@ -1084,8 +1685,7 @@ iotdata_status_t iotdata_encode_wind_speed(iotdata_encoder_t *enc, iotdata_float
         return IOTDATA_ERR_WIND_SPEED_HIGH;
 #endif
     enc->wind_speed = speed_ms;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_WIND_SPEED);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_WIND_SPEED);
 }
 #endif
 #if !defined(IOTDATA_NO_FLOATING)
@@ -1117,7 +1717,7 @@ static bool pack_wind_speed(uint8_t *buf, size_t bb, size_t *bp, const iotdata_e
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_wind_speed(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_wind_speed(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_WIND_SPEED_BITS > bb)
         return false;
     dec->wind_speed = dequantise_wind_speed(bits_read(buf, bb, bp, IOTDATA_WIND_SPEED_BITS));
@@ -1125,18 +1725,15 @@ static bool unpack_wind_speed(const uint8_t *buf, size_t bb, size_t *bp, iotdata
 }
 #endif
 #if defined(IOTDATA_ENABLE_WIND_SPEED) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_wind_speed(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_wind_speed(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_wind_speed(enc, (iotdata_float_t)j->valuedouble);
+    return iotdata_encode_wind_speed(enc, (iotdata_float_t)jr_number(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_wind_speed(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_wind_speed(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->wind_speed);
+    jw_fixed(jw, label, dec->wind_speed, IOTDATA_WIND_SPEED_DECIMALS);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -1144,22 +1741,16 @@ static int dump_wind_speed(const uint8_t *buf, size_t bb, size_t *bp, iotdata_du
     (void)label;
     size_t s = *bp;
     uint32_t r = bits_read(buf, bb, bp, IOTDATA_WIND_SPEED_BITS);
-#if !defined(IOTDATA_NO_FLOATING)
-    snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%.1f m/s", dequantise_wind_speed(r));
-#else
-    fmt_scaled(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_wind_speed(r), 100, "m/s");
-#endif
+    fmt_fixed_unit(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_wind_speed(r), IOTDATA_WIND_SPEED_DECIMALS, 1, "m/s");
     n = dump_add(dump, n, s, IOTDATA_WIND_SPEED_BITS, r, dump->_dec_buf, "0..63.5, 0.5m/s", "wind_speed");
     return n;
 }
 #endif
 #if defined(IOTDATA_ENABLE_WIND_SPEED) && !defined(IOTDATA_NO_PRINT) && !defined(IOTDATA_NO_DECODE)
 static void print_wind_speed(const iotdata_decoded_t *dec, iotdata_buf_t *bp, const char *label) {
-#if !defined(IOTDATA_NO_FLOATING)
-    bprintf(bp, "  %s:%s %.1f m/s\n", label, _padd(label), dec->wind_speed);
-#else
-    bprintf(bp, "  %s:%s %d.%02d m/s\n", label, _padd(label), dec->wind_speed / 100, dec->wind_speed % 100);
-#endif
+    char ws[_IOTDATA_FIXED_MAX];
+    fmt_fixed(ws, dec->wind_speed, IOTDATA_WIND_SPEED_DECIMALS, 1);
+    bprintf(bp, "  %s:%s %s m/s\n", label, _padd(label), ws);
 }
 #endif
 // clang-format off
@@ -1171,7 +1762,7 @@ static const iotdata_field_ops_t _iotdata_field_def_wind_speed = {
     _IOTDATA_OP_UNPACK(unpack_wind_speed)
     _IOTDATA_OP_DUMP(dump_wind_speed)
     _IOTDATA_OP_PRINT(print_wind_speed)
-    _IOTDATA_OP_JSON_SET(json_set_wind_speed)
+    _IOTDATA_OP_JSON_WRITE(json_write_wind_speed)
     _IOTDATA_OP_JSON_GET(json_get_wind_speed)
 };
 #define _IOTDATA_ENT_WIND_SPEED [IOTDATA_FIELD_WIND_SPEED] = &_iotdata_field_def_wind_speed,
@@ -1197,8 +1788,7 @@ iotdata_status_t iotdata_encode_wind_direction(iotdata_encoder_t *enc, uint16_t
         return IOTDATA_ERR_WIND_DIRECTION_HIGH;
 #endif
     enc->wind_direction = direction_deg;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_WIND_DIRECTION);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_WIND_DIRECTION);
 }
 #endif
 #if !defined(IOTDATA_NO_FLOATING)
@@ -1231,7 +1821,7 @@ static bool pack_wind_direction(uint8_t *buf, size_t bb, size_t *bp, const iotda
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_wind_direction(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_wind_direction(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_WIND_DIRECTION_BITS > bb)
         return false;
     dec->wind_direction = dequantise_wind_direction(bits_read(buf, bb, bp, IOTDATA_WIND_DIRECTION_BITS));
@@ -1239,18 +1829,15 @@ static bool unpack_wind_direction(const uint8_t *buf, size_t bb, size_t *bp, iot
 }
 #endif
 #if defined(IOTDATA_ENABLE_WIND_DIRECTION) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_wind_direction(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_wind_direction(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_wind_direction(enc, (uint16_t)j->valueint);
+    return iotdata_encode_wind_direction(enc, (uint16_t)jr_int(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_wind_direction(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_wind_direction(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->wind_direction);
+    jw_number(jw, label, dec->wind_direction);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -1277,7 +1864,7 @@ static const iotdata_field_ops_t _iotdata_field_def_wind_direction = {
     _IOTDATA_OP_UNPACK(unpack_wind_direction)
     _IOTDATA_OP_DUMP(dump_wind_direction)
     _IOTDATA_OP_PRINT(print_wind_direction)
-    _IOTDATA_OP_JSON_SET(json_set_wind_direction)
+    _IOTDATA_OP_JSON_WRITE(json_write_wind_direction)
     _IOTDATA_OP_JSON_GET(json_get_wind_direction)
 };
 #define _IOTDATA_ENT_WIND_DIRECTION [IOTDATA_FIELD_WIND_DIRECTION] = &_iotdata_field_def_wind_direction,
@@ -1303,8 +1890,7 @@ iotdata_status_t iotdata_encode_wind_gust(iotdata_encoder_t *enc, iotdata_float_
         return IOTDATA_ERR_WIND_GUST_HIGH;
 #endif
     enc->wind_gust = gust_ms;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_WIND_GUST);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_WIND_GUST);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -1313,7 +1899,7 @@ static bool pack_wind_gust(uint8_t *buf, size_t bb, size_t *bp, const iotdata_en
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_wind_gust(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_wind_gust(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_WIND_GUST_BITS > bb)
         return false;
     dec->wind_gust = dequantise_wind_speed(bits_read(buf, bb, bp, IOTDATA_WIND_GUST_BITS));
@@ -1321,18 +1907,15 @@ static bool unpack_wind_gust(const uint8_t *buf, size_t bb, size_t *bp, iotdata_
 }
 #endif
 #if defined(IOTDATA_ENABLE_WIND_GUST) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_wind_gust(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_wind_gust(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_wind_gust(enc, (iotdata_float_t)j->valuedouble);
+    return iotdata_encode_wind_gust(enc, (iotdata_float_t)jr_number(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_wind_gust(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_wind_gust(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->wind_gust);
+    jw_fixed(jw, label, dec->wind_gust, IOTDATA_WIND_SPEED_DECIMALS);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -1340,22 +1923,16 @@ static int dump_wind_gust(const uint8_t *buf, size_t bb, size_t *bp, iotdata_dum
     (void)label;
     size_t s = *bp;
     uint32_t r = bits_read(buf, bb, bp, IOTDATA_WIND_GUST_BITS);
-#if !defined(IOTDATA_NO_FLOATING)
-    snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%.1f m/s", dequantise_wind_speed(r));
-#else
-    fmt_scaled(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_wind_speed(r), 100, "m/s");
-#endif
+    fmt_fixed_unit(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_wind_speed(r), IOTDATA_WIND_SPEED_DECIMALS, 1, "m/s");
     n = dump_add(dump, n, s, IOTDATA_WIND_GUST_BITS, r, dump->_dec_buf, "0..63.5, 0.5m/s", "wind_gust");
     return n;
 }
 #endif
 #if defined(IOTDATA_ENABLE_WIND_GUST) && !defined(IOTDATA_NO_PRINT) && !defined(IOTDATA_NO_DECODE)
 static void print_wind_gust(const iotdata_decoded_t *dec, iotdata_buf_t *bp, const char *label) {
-#if !defined(IOTDATA_NO_FLOATING)
-    bprintf(bp, "  %s:%s %.1f m/s\n", label, _padd(label), dec->wind_gust);
-#else
-    bprintf(bp, "  %s:%s %d.%02d m/s\n", label, _padd(label), dec->wind_gust / 100, dec->wind_gust % 100);
-#endif
+    char wg[_IOTDATA_FIXED_MAX];
+    fmt_fixed(wg, dec->wind_gust, IOTDATA_WIND_SPEED_DECIMALS, 1);
+    bprintf(bp, "  %s:%s %s m/s\n", label, _padd(label), wg);
 }
 #endif
 // clang-format off
@@ -1367,7 +1944,7 @@ static const iotdata_field_ops_t _iotdata_field_def_wind_gust = {
     _IOTDATA_OP_UNPACK(unpack_wind_gust)
     _IOTDATA_OP_DUMP(dump_wind_gust)
     _IOTDATA_OP_PRINT(print_wind_gust)
-    _IOTDATA_OP_JSON_SET(json_set_wind_gust)
+    _IOTDATA_OP_JSON_WRITE(json_write_wind_gust)
     _IOTDATA_OP_JSON_GET(json_get_wind_gust)
 };
 #define _IOTDATA_ENT_WIND_GUST [IOTDATA_FIELD_WIND_GUST] = &_iotdata_field_def_wind_gust,
@@ -1399,8 +1976,7 @@ iotdata_status_t iotdata_encode_wind(iotdata_encoder_t *enc, iotdata_float_t spe
     enc->wind_speed = speed_ms;
     enc->wind_direction = direction_deg;
     enc->wind_gust = gust_ms;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_WIND);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_WIND);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -1409,28 +1985,26 @@ static bool pack_wind(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encoder
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_wind(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_wind(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     return unpack_wind_speed(buf, bb, bp, dec) && unpack_wind_direction(buf, bb, bp, dec) && unpack_wind_gust(buf, bb, bp, dec);
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_wind(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_wind(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    cJSON *j_speed = cJSON_GetObjectItem(j, "speed"), *j_direction = cJSON_GetObjectItem(j, "direction"), *j_gust = cJSON_GetObjectItem(j, "gust");
+    const char *j_speed = jr_member(j, "speed"), *j_direction = jr_member(j, "direction"), *j_gust = jr_member(j, "gust");
     if (!j_speed || !j_direction || !j_gust)
         return IOTDATA_OK;
-    return iotdata_encode_wind(enc, (iotdata_float_t)j_speed->valuedouble, (uint16_t)j_direction->valueint, (iotdata_float_t)j_gust->valuedouble);
+    return iotdata_encode_wind(enc, (iotdata_float_t)jr_number(j_speed), (uint16_t)jr_int(j_direction), (iotdata_float_t)jr_number(j_gust));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_wind(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
-    cJSON *obj = cJSON_AddObjectToObject(root, label);
-    json_set_wind_speed(obj, dec, "speed", scratch);
-    json_set_wind_direction(obj, dec, "direction", scratch);
-    json_set_wind_gust(obj, dec, "gust", scratch);
+static void json_write_wind(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+    jw_object_begin(jw, label);
+    json_write_wind_speed(jw, dec, "speed", scratch);
+    json_write_wind_direction(jw, dec, "direction", scratch);
+    json_write_wind_gust(jw, dec, "gust", scratch);
+    jw_object_end(jw);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -1443,11 +2017,10 @@ static int dump_wind(const uint8_t *buf, size_t bb, size_t *bp, iotdata_dump_t *
 #endif
 #if !defined(IOTDATA_NO_PRINT) && !defined(IOTDATA_NO_DECODE)
 static void print_wind(const iotdata_decoded_t *dec, iotdata_buf_t *bp, const char *label) {
-#if !defined(IOTDATA_NO_FLOATING)
-    bprintf(bp, "  %s:%s %.1f m/s, %" PRIu16 " deg, gust %.1f m/s\n", label, _padd(label), dec->wind_speed, dec->wind_direction, dec->wind_gust);
-#else
-    bprintf(bp, "  %s:%s %d.%02d m/s, %" PRIu16 " deg, gust %d.%02d m/s\n", label, _padd(label), dec->wind_speed / 100, dec->wind_speed % 100, dec->wind_direction, dec->wind_gust / 100, dec->wind_gust % 100);
-#endif
+    char ws[_IOTDATA_FIXED_MAX], wg[_IOTDATA_FIXED_MAX];
+    fmt_fixed(ws, dec->wind_speed, IOTDATA_WIND_SPEED_DECIMALS, 1);
+    fmt_fixed(wg, dec->wind_gust, IOTDATA_WIND_SPEED_DECIMALS, 1);
+    bprintf(bp, "  %s:%s %s m/s, %" PRIu16 " deg, gust %s m/s\n", label, _padd(label), ws, dec->wind_direction, wg);
 }
 #endif
 // clang-format off
@@ -1458,7 +2031,7 @@ static const iotdata_field_ops_t _iotdata_field_def_wind = {
     _IOTDATA_OP_UNPACK(unpack_wind)
     _IOTDATA_OP_DUMP(dump_wind)
     _IOTDATA_OP_PRINT(print_wind)
-    _IOTDATA_OP_JSON_SET(json_set_wind)
+    _IOTDATA_OP_JSON_WRITE(json_write_wind)
     _IOTDATA_OP_JSON_GET(json_get_wind)
 };
 #define _IOTDATA_ENT_WIND [IOTDATA_FIELD_WIND] = &_iotdata_field_def_wind,
@@ -1479,8 +2052,7 @@ iotdata_status_t iotdata_encode_rain_rate(iotdata_encoder_t *enc, uint8_t rate_m
     CHECK_CTX_ACTIVE(enc);
     CHECK_NOT_DUPLICATE(enc, IOTDATA_FIELD_RAIN_RATE);
     enc->rain_rate = rate_mmhr;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_RAIN_RATE);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_RAIN_RATE);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -1499,7 +2071,7 @@ static bool pack_rain_rate(uint8_t *buf, size_t bb, size_t *bp, const iotdata_en
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_rain_rate(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_rain_rate(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_RAIN_RATE_BITS > bb)
         return false;
     dec->rain_rate = dequantise_rain_rate(bits_read(buf, bb, bp, IOTDATA_RAIN_RATE_BITS));
@@ -1507,18 +2079,15 @@ static bool unpack_rain_rate(const uint8_t *buf, size_t bb, size_t *bp, iotdata_
 }
 #endif
 #if defined(IOTDATA_ENABLE_RAIN_RATE) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_rain_rate(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_rain_rate(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_rain_rate(enc, (uint8_t)j->valueint);
+    return iotdata_encode_rain_rate(enc, (uint8_t)jr_int(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_rain_rate(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_rain_rate(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->rain_rate);
+    jw_number(jw, label, dec->rain_rate);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -1545,7 +2114,7 @@ static const iotdata_field_ops_t _iotdata_field_def_rain_rate = {
     _IOTDATA_OP_UNPACK(unpack_rain_rate)
     _IOTDATA_OP_DUMP(dump_rain_rate)
     _IOTDATA_OP_PRINT(print_rain_rate)
-    _IOTDATA_OP_JSON_SET(json_set_rain_rate)
+    _IOTDATA_OP_JSON_WRITE(json_write_rain_rate)
     _IOTDATA_OP_JSON_GET(json_get_rain_rate)
 };
 #define _IOTDATA_ENT_RAIN_RATE [IOTDATA_FIELD_RAIN_RATE] = &_iotdata_field_def_rain_rate,
@@ -1571,8 +2140,7 @@ iotdata_status_t iotdata_encode_rain_size(iotdata_encoder_t *enc, uint8_t size10
         return IOTDATA_ERR_RAIN_SIZE_HIGH;
 #endif
     enc->rain_size10 = size10_mmd;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_RAIN_SIZE);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_RAIN_SIZE);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -1591,7 +2159,7 @@ static bool pack_rain_size(uint8_t *buf, size_t bb, size_t *bp, const iotdata_en
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_rain_size(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_rain_size(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_RAIN_SIZE_BITS > bb)
         return false;
     dec->rain_size10 = dequantise_rain_size(bits_read(buf, bb, bp, IOTDATA_RAIN_SIZE_BITS));
@@ -1599,18 +2167,15 @@ static bool unpack_rain_size(const uint8_t *buf, size_t bb, size_t *bp, iotdata_
 }
 #endif
 #if defined(IOTDATA_ENABLE_RAIN_SIZE) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_rain_size(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_rain_size(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_rain_size(enc, (uint8_t)j->valueint);
+    return iotdata_encode_rain_size(enc, (uint8_t)jr_int(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_rain_size(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_rain_size(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->rain_size10);
+    jw_number(jw, label, dec->rain_size10);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -1637,7 +2202,7 @@ static const iotdata_field_ops_t _iotdata_field_def_rain_size = {
     _IOTDATA_OP_UNPACK(unpack_rain_size)
     _IOTDATA_OP_DUMP(dump_rain_size)
     _IOTDATA_OP_PRINT(print_rain_size)
-    _IOTDATA_OP_JSON_SET(json_set_rain_size)
+    _IOTDATA_OP_JSON_WRITE(json_write_rain_size)
     _IOTDATA_OP_JSON_GET(json_get_rain_size)
 };
 #define _IOTDATA_ENT_RAIN_SIZE [IOTDATA_FIELD_RAIN_SIZE] = &_iotdata_field_def_rain_size,
@@ -1664,8 +2229,7 @@ iotdata_status_t iotdata_encode_rain(iotdata_encoder_t *enc, uint8_t rate_mmhr,
 #endif
     enc->rain_rate = rate_mmhr;
     enc->rain_size10 = size10_mmd;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_RAIN);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_RAIN);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -1674,27 +2238,25 @@ static bool pack_rain(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encoder
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_rain(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_rain(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     return unpack_rain_rate(buf, bb, bp, dec) && unpack_rain_size(buf, bb, bp, dec);
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_rain(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_rain(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    cJSON *j_rate = cJSON_GetObjectItem(j, "rate"), *j_size = cJSON_GetObjectItem(j, "size");
+    const char *j_rate = jr_member(j, "rate"), *j_size = jr_member(j, "size");
     if (!j_rate || !j_size)
         return IOTDATA_OK;
-    return iotdata_encode_rain(enc, (uint8_t)j_rate->valueint, (uint8_t)j_size->valueint);
+    return iotdata_encode_rain(enc, (uint8_t)jr_int(j_rate), (uint8_t)jr_int(j_size));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_rain(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
-    cJSON *obj = cJSON_AddObjectToObject(root, label);
-    json_set_rain_rate(obj, dec, "rate", scratch);
-    json_set_rain_size(obj, dec, "size", scratch);
+static void json_write_rain(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+    jw_object_begin(jw, label);
+    json_write_rain_rate(jw, dec, "rate", scratch);
+    json_write_rain_size(jw, dec, "size", scratch);
+    jw_object_end(jw);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -1717,7 +2279,7 @@ static const iotdata_field_ops_t _iotdata_field_def_rain = {
     _IOTDATA_OP_UNPACK(unpack_rain)
     _IOTDATA_OP_DUMP(dump_rain)
     _IOTDATA_OP_PRINT(print_rain)
-    _IOTDATA_OP_JSON_SET(json_set_rain)
+    _IOTDATA_OP_JSON_WRITE(json_write_rain)
     _IOTDATA_OP_JSON_GET(json_get_rain)
 };
 #define _IOTDATA_ENT_RAIN [IOTDATA_FIELD_RAIN] = &_iotdata_field_def_rain,
@@ -1745,8 +2307,7 @@ iotdata_status_t iotdata_encode_solar(iotdata_encoder_t *enc, uint16_t irradianc
 #endif
     enc->solar_irradiance = irradiance_wm2;
     enc->solar_ultraviolet = ultraviolet_index;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_SOLAR);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_SOLAR);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -1775,7 +2336,7 @@ static bool pack_solar(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encode
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_solar(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_solar(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_SOLAR_IRRADIATION_BITS + IOTDATA_SOLAR_ULTRAVIOLET_BITS > bb)
         return false;
     dec->solar_irradiance = dequantise_solar_irradiance(bits_read(buf, bb, bp, IOTDATA_SOLAR_IRRADIATION_BITS));
@@ -1784,23 +2345,21 @@ static bool unpack_solar(const uint8_t *buf, size_t bb, size_t *bp, iotdata_deco
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_solar(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_solar(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    cJSON *j_irradiance = cJSON_GetObjectItem(j, "irradiance"), *j_ultraviolet = cJSON_GetObjectItem(j, "ultraviolet");
+    const char *j_irradiance = jr_member(j, "irradiance"), *j_ultraviolet = jr_member(j, "ultraviolet");
     if (!j_irradiance || !j_ultraviolet)
         return IOTDATA_OK;
-    return iotdata_encode_solar(enc, (uint16_t)j_irradiance->valueint, (uint8_t)j_ultraviolet->valueint);
+    return iotdata_encode_solar(enc, (uint16_t)jr_int(j_irradiance), (uint8_t)jr_int(j_ultraviolet));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_solar(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_solar(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *obj = cJSON_AddObjectToObject(root, label);
-    cJSON_AddNumberToObject(obj, "irradiance", dec->solar_irradiance);
-    cJSON_AddNumberToObject(obj, "ultraviolet", dec->solar_ultraviolet);
+    jw_object_begin(jw, label);
+    jw_number(jw, "irradiance", dec->solar_irradiance);
+    jw_number(jw, "ultraviolet", dec->solar_ultraviolet);
+    jw_object_end(jw);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -1830,7 +2389,7 @@ static const iotdata_field_ops_t _iotdata_field_def_solar = {
     _IOTDATA_OP_UNPACK(unpack_solar)
     _IOTDATA_OP_DUMP(dump_solar)
     _IOTDATA_OP_PRINT(print_solar)
-    _IOTDATA_OP_JSON_SET(json_set_solar)
+    _IOTDATA_OP_JSON_WRITE(json_write_solar)
     _IOTDATA_OP_JSON_GET(json_get_solar)
 };
 #define _IOTDATA_ENT_SOLAR [IOTDATA_FIELD_SOLAR] = &_iotdata_field_def_solar,
@@ -1859,8 +2418,7 @@ iotdata_status_t iotdata_encode_clouds(iotdata_encoder_t *enc, uint8_t okta) {
         return IOTDATA_ERR_CLOUDS_HIGH;
 #endif
     enc->clouds = okta;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_CLOUDS);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_CLOUDS);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -1879,7 +2437,7 @@ static bool pack_clouds(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encod
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_clouds(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_clouds(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_CLOUDS_BITS > bb)
         return false;
     dec->clouds = dequantise_clouds(bits_read(buf, bb, bp, IOTDATA_CLOUDS_BITS));
@@ -1887,18 +2445,15 @@ static bool unpack_clouds(const uint8_t *buf, size_t bb, size_t *bp, iotdata_dec
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_clouds(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_clouds(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_clouds(enc, (uint8_t)j->valueint);
+    return iotdata_encode_clouds(enc, (uint8_t)jr_int(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_clouds(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_clouds(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->clouds);
+    jw_number(jw, label, dec->clouds);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -1924,7 +2479,7 @@ static const iotdata_field_ops_t _iotdata_field_def_clouds = {
     _IOTDATA_OP_UNPACK(unpack_clouds)
     _IOTDATA_OP_DUMP(dump_clouds)
     _IOTDATA_OP_PRINT(print_clouds)
-    _IOTDATA_OP_JSON_SET(json_set_clouds)
+    _IOTDATA_OP_JSON_WRITE(json_write_clouds)
 _IOTDATA_OP_JSON_GET(json_get_clouds)
 };
 #define _IOTDATA_ENT_CLOUDS [IOTDATA_FIELD_CLOUDS] = &_iotdata_field_def_clouds,
@@ -1997,8 +2552,7 @@ iotdata_status_t iotdata_encode_air_quality_index(iotdata_encoder_t *enc, uint16
         return IOTDATA_ERR_AIR_QUALITY_INDEX_HIGH;
 #endif
     enc->aq_index = aq_index;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_AIR_QUALITY_INDEX);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_AIR_QUALITY_INDEX);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -2017,7 +2571,7 @@ static bool pack_aq_index(uint8_t *buf, size_t bb, size_t *bp, const iotdata_enc
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_aq_index(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_aq_index(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_AIR_QUALITY_INDEX_BITS > bb)
         return false;
     dec->aq_index = dequantise_aq_index(bits_read(buf, bb, bp, IOTDATA_AIR_QUALITY_INDEX_BITS));
@@ -2025,18 +2579,15 @@ static bool unpack_aq_index(const uint8_t *buf, size_t bb, size_t *bp, iotdata_d
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_aq_index(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_aq_index(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->aq_index);
+    jw_number(jw, label, dec->aq_index);
 }
 #endif
 #if defined(IOTDATA_ENABLE_AIR_QUALITY_INDEX) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_aq_index(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_aq_index(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_air_quality_index(enc, (uint16_t)j->valueint);
+    return iotdata_encode_air_quality_index(enc, (uint16_t)jr_int(j));
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -2063,7 +2614,7 @@ static const iotdata_field_ops_t _iotdata_field_def_aq_index = {
     _IOTDATA_OP_UNPACK(unpack_aq_index)
     _IOTDATA_OP_DUMP(dump_aq_index)
     _IOTDATA_OP_PRINT(print_aq_index)
-    _IOTDATA_OP_JSON_SET(json_set_aq_index)
+    _IOTDATA_OP_JSON_WRITE(json_write_aq_index)
     _IOTDATA_OP_JSON_GET(json_get_aq_index)
 };
 #define _IOTDATA_ENT_AIR_QUALITY_INDEX [IOTDATA_FIELD_AIR_QUALITY_INDEX] = &_iotdata_field_def_aq_index,
@@ -2092,8 +2643,7 @@ iotdata_status_t iotdata_encode_air_quality_pm(iotdata_encoder_t *enc, uint8_t p
     enc->aq_pm_present = pm_present & 0x0F;
     for (int i = 0; i < IOTDATA_AIR_QUALITY_PM_COUNT; i++)
         enc->aq_pm[i] = pm[i];
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_AIR_QUALITY_PM);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_AIR_QUALITY_PM);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -2108,7 +2658,7 @@ static bool pack_aq_pm(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encode
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_aq_pm(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_aq_pm(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_AIR_QUALITY_PM_PRESENT_BITS > bb)
         return false;
     dec->aq_pm_present = (uint8_t)bits_read(buf, bb, bp, IOTDATA_AIR_QUALITY_PM_PRESENT_BITS);
@@ -2121,29 +2671,27 @@ static bool unpack_aq_pm(const uint8_t *buf, size_t bb, size_t *bp, iotdata_deco
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_aq_pm(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_aq_pm(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *obj = cJSON_AddObjectToObject(root, label);
+    jw_object_begin(jw, label);
     for (int i = 0; i < IOTDATA_AIR_QUALITY_PM_COUNT; i++)
         if (dec->aq_pm_present & (1U << i))
-            cJSON_AddNumberToObject(obj, _aq_pm_names[i], dec->aq_pm[i]);
+            jw_number(jw, _aq_pm_names[i], dec->aq_pm[i]);
+    jw_object_end(jw);
 }
 #endif
 #if defined(IOTDATA_ENABLE_AIR_QUALITY_PM) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_aq_pm(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_aq_pm(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
     uint8_t present = 0;
     uint16_t pm[IOTDATA_AIR_QUALITY_PM_COUNT] = { 0 };
-    for (int i = 0; i < IOTDATA_AIR_QUALITY_PM_COUNT; i++) {
-        cJSON *v = cJSON_GetObjectItem(j, _aq_pm_names[i]);
-        if (v) {
+    const char *v[IOTDATA_AIR_QUALITY_PM_COUNT];
+    jr_object(j, _aq_pm_names, IOTDATA_AIR_QUALITY_PM_COUNT, v);
+    for (int i = 0; i < IOTDATA_AIR_QUALITY_PM_COUNT; i++)
+        if (v[i]) {
             present |= (1U << i);
-            pm[i] = (uint16_t)v->valueint;
+            pm[i] = (uint16_t)jr_int(v[i]);
         }
-    }
     return iotdata_encode_air_quality_pm(enc, present, pm);
 }
 #endif
@@ -2182,7 +2730,7 @@ static const iotdata_field_ops_t _iotdata_field_def_aq_pm = {
     _IOTDATA_OP_UNPACK(unpack_aq_pm)
     _IOTDATA_OP_DUMP(dump_aq_pm)
     _IOTDATA_OP_PRINT(print_aq_pm)
-    _IOTDATA_OP_JSON_SET(json_set_aq_pm)
+    _IOTDATA_OP_JSON_WRITE(json_write_aq_pm)
     _IOTDATA_OP_JSON_GET(json_get_aq_pm)
 };
 #define _IOTDATA_ENT_AIR_QUALITY_PM [IOTDATA_FIELD_AIR_QUALITY_PM] = &_iotdata_field_def_aq_pm,
@@ -2211,8 +2759,7 @@ iotdata_status_t iotdata_encode_air_quality_gas(iotdata_encoder_t *enc, uint8_t
     enc->aq_gas_present = gas_present;
     for (int i = 0; i < IOTDATA_AIR_QUALITY_GAS_COUNT; i++)
         enc->aq_gas[i] = gas[i];
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_AIR_QUALITY_GAS);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_AIR_QUALITY_GAS);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -2227,7 +2774,7 @@ static bool pack_aq_gas(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encod
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_aq_gas(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_aq_gas(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_AIR_QUALITY_GAS_PRESENT_BITS > bb)
         return false;
     dec->aq_gas_present = (uint8_t)bits_read(buf, bb, bp, IOTDATA_AIR_QUALITY_GAS_PRESENT_BITS);
@@ -2240,29 +2787,27 @@ static bool unpack_aq_gas(const uint8_t *buf, size_t bb, size_t *bp, iotdata_dec
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_aq_gas(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_aq_gas(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *obj = cJSON_AddObjectToObject(root, label);
+    jw_object_begin(jw, label);
     for (int i = 0; i < IOTDATA_AIR_QUALITY_GAS_COUNT; i++)
         if (dec->aq_gas_present & (1U << i))
-            cJSON_AddNumberToObject(obj, _aq_gas_names[i], dec->aq_gas[i]);
+            jw_number(jw, _aq_gas_names[i], dec->aq_gas[i]);
+    jw_object_end(jw);
 }
 #endif
 #if defined(IOTDATA_ENABLE_AIR_QUALITY_GAS) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_aq_gas(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_aq_gas(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
     uint8_t present = 0;
     uint16_t gas[IOTDATA_AIR_QUALITY_GAS_COUNT] = { 0 };
-    for (int i = 0; i < IOTDATA_AIR_QUALITY_GAS_COUNT; i++) {
-        cJSON *v = cJSON_GetObjectItem(j, _aq_gas_names[i]);
-        if (v) {
+    const char *v[IOTDATA_AIR_QUALITY_GAS_COUNT];
+    jr_object(j, _aq_gas_names, IOTDATA_AIR_QUALITY_GAS_COUNT, v);
+    for (int i = 0; i < IOTDATA_AIR_QUALITY_GAS_COUNT; i++)
+        if (v[i]) {
             present |= (1U << i);
-            gas[i] = (uint16_t)v->valueint;
+            gas[i] = (uint16_t)jr_int(v[i]);
         }
-    }
     return iotdata_encode_air_quality_gas(enc, present, gas);
 }
 #endif
@@ -2302,7 +2847,7 @@ static const iotdata_field_ops_t _iotdata_field_def_aq_gas = {
     _IOTDATA_OP_UNPACK(unpack_aq_gas)
     _IOTDATA_OP_DUMP(dump_aq_gas)
     _IOTDATA_OP_PRINT(print_aq_gas)
-    _IOTDATA_OP_JSON_SET(json_set_aq_gas)
+    _IOTDATA_OP_JSON_WRITE(json_write_aq_gas)
     _IOTDATA_OP_JSON_GET(json_get_aq_gas)
 };
 #define _IOTDATA_ENT_AIR_QUALITY_GAS [IOTDATA_FIELD_AIR_QUALITY_GAS] = &_iotdata_field_def_aq_gas,
@@ -2340,8 +2885,7 @@ iotdata_status_t iotdata_encode_air_quality(iotdata_encoder_t *enc, uint16_t aq_
     enc->aq_gas_present = gas_present;
     for (int i = 0; i < IOTDATA_AIR_QUALITY_GAS_COUNT; i++)
         enc->aq_gas[i] = gas[i];
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_AIR_QUALITY);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_AIR_QUALITY);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -2350,54 +2894,50 @@ static bool pack_air_quality(uint8_t *buf, size_t bb, size_t *bp, const iotdata_
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_air_quality(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_air_quality(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     return unpack_aq_index(buf, bb, bp, dec) && unpack_aq_pm(buf, bb, bp, dec) && unpack_aq_gas(buf, bb, bp, dec);
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_air_quality(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_air_quality(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
+    static const char *const names[] = { "index", "pm", "gas" };
+    const char *ji[3];
+    jr_object(j, names, 3, ji);
     /* Extract index */
     uint16_t idx = 0;
-    cJSON *ji = cJSON_GetObjectItem(j, "index");
-    if (ji)
-        idx = (uint16_t)ji->valueint;
+    if (ji[0])
+        idx = (uint16_t)jr_int(ji[0]);
     /* Extract PM */
     uint8_t pm_present = 0;
     uint16_t pm[IOTDATA_AIR_QUALITY_PM_COUNT] = { 0 };
-    cJSON *jp = cJSON_GetObjectItem(j, "pm");
-    if (jp)
-        for (int i = 0; i < IOTDATA_AIR_QUALITY_PM_COUNT; i++) {
-            cJSON *v = cJSON_GetObjectItem(jp, _aq_pm_names[i]);
-            if (v) {
-                pm_present |= (1U << i);
-                pm[i] = (uint16_t)v->valueint;
-            }
+    const char *vp[IOTDATA_AIR_QUALITY_PM_COUNT];
+    jr_object(ji[1], _aq_pm_names, IOTDATA_AIR_QUALITY_PM_COUNT, vp);
+    for (int i = 0; i < IOTDATA_AIR_QUALITY_PM_COUNT; i++)
+        if (vp[i]) {
+            pm_present |= (1U << i);
+            pm[i] = (uint16_t)jr_int(vp[i]);
         }
     /* Extract gas */
     uint8_t gas_present = 0;
     uint16_t gas[IOTDATA_AIR_QUALITY_GAS_COUNT] = { 0 };
-    cJSON *jg = cJSON_GetObjectItem(j, "gas");
-    if (jg)
-        for (int i = 0; i < IOTDATA_AIR_QUALITY_GAS_COUNT; i++) {
-            cJSON *v = cJSON_GetObjectItem(jg, _aq_gas_names[i]);
-            if (v) {
-                gas_present |= (1U << i);
-                gas[i] = (uint16_t)v->valueint;
-            }
+    const char *vg[IOTDATA_AIR_QUALITY_GAS_COUNT];
+    jr_object(ji[2], _aq_gas_names, IOTDATA_AIR_QUALITY_GAS_COUNT, vg);
+    for (int i = 0; i < IOTDATA_AIR_QUALITY_GAS_COUNT; i++)
+        if (vg[i]) {
+            gas_present |= (1U << i);
+            gas[i] = (uint16_t)jr_int(vg[i]);
         }
     return iotdata_encode_air_quality(enc, idx, pm_present, pm, gas_present, gas);
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_air_quality(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
-    cJSON *obj = cJSON_AddObjectToObject(root, label);
-    json_set_aq_index(obj, dec, "index", scratch);
-    json_set_aq_pm(obj, dec, "pm", scratch);
-    json_set_aq_gas(obj, dec, "gas", scratch);
+static void json_write_air_quality(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+    jw_object_begin(jw, label);
+    json_write_aq_index(jw, dec, "index", scratch);
+    json_write_aq_pm(jw, dec, "pm", scratch);
+    json_write_aq_gas(jw, dec, "gas", scratch);
+    jw_object_end(jw);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -2423,7 +2963,7 @@ static const iotdata_field_ops_t _iotdata_field_def_air_quality = {
     _IOTDATA_OP_UNPACK(unpack_air_quality)
     _IOTDATA_OP_DUMP(dump_air_quality)
     _IOTDATA_OP_PRINT(print_air_quality)
-    _IOTDATA_OP_JSON_SET(json_set_air_quality)
+    _IOTDATA_OP_JSON_WRITE(json_write_air_quality)
     _IOTDATA_OP_JSON_GET(json_get_air_quality)
 };
 #define _IOTDATA_ENT_AIR_QUALITY [IOTDATA_FIELD_AIR_QUALITY] = &_iotdata_field_def_air_quality,
@@ -2448,8 +2988,7 @@ iotdata_status_t iotdata_encode_radiation_cpm(iotdata_encoder_t *enc, uint16_t c
         return IOTDATA_ERR_RADIATION_CPM_HIGH;
 #endif
     enc->radiation_cpm = cpm;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_RADIATION_CPM);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_RADIATION_CPM);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -2468,7 +3007,7 @@ static bool pack_radiation_cpm(uint8_t *buf, size_t bb, size_t *bp, const iotdat
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_radiation_cpm(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_radiation_cpm(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_RADIATION_CPM_BITS > bb)
         return false;
     dec->radiation_cpm = dequantise_radiation_cpm(bits_read(buf, bb, bp, IOTDATA_RADIATION_CPM_BITS));
@@ -2476,18 +3015,15 @@ static bool unpack_radiation_cpm(const uint8_t *buf, size_t bb, size_t *bp, iotd
 }
 #endif
 #if defined(IOTDATA_ENABLE_RADIATION_CPM) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_radiation_cpm(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_radiation_cpm(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_radiation_cpm(enc, (uint16_t)j->valueint);
+    return iotdata_encode_radiation_cpm(enc, (uint16_t)jr_int(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_radiation_cpm(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_radiation_cpm(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->radiation_cpm);
+    jw_number(jw, label, dec->radiation_cpm);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -2514,7 +3050,7 @@ static const iotdata_field_ops_t _iotdata_field_def_radiation_cpm = {
     _IOTDATA_OP_UNPACK(unpack_radiation_cpm)
     _IOTDATA_OP_DUMP(dump_radiation_cpm)
     _IOTDATA_OP_PRINT(print_radiation_cpm)
-    _IOTDATA_OP_JSON_SET(json_set_radiation_cpm)
+    _IOTDATA_OP_JSON_WRITE(json_write_radiation_cpm)
     _IOTDATA_OP_JSON_GET(json_get_radiation_cpm)
 };
 #define _IOTDATA_ENT_RADIATION_CPM [IOTDATA_FIELD_RADIATION_CPM] = &_iotdata_field_def_radiation_cpm,
@@ -2540,8 +3076,7 @@ iotdata_status_t iotdata_encode_radiation_dose(iotdata_encoder_t *enc, iotdata_f
         return IOTDATA_ERR_RADIATION_DOSE_HIGH;
 #endif
     enc->radiation_dose = usvh;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_RADIATION_DOSE);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_RADIATION_DOSE);
 }
 #endif
 #if !defined(IOTDATA_NO_FLOATING)
@@ -2573,7 +3108,7 @@ static bool pack_radiation_dose(uint8_t *buf, size_t bb, size_t *bp, const iotda
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_radiation_dose(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_radiation_dose(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_RADIATION_DOSE_BITS > bb)
         return false;
     dec->radiation_dose = dequantise_radiation_dose(bits_read(buf, bb, bp, IOTDATA_RADIATION_DOSE_BITS));
@@ -2581,18 +3116,15 @@ static bool unpack_radiation_dose(const uint8_t *buf, size_t bb, size_t *bp, iot
 }
 #endif
 #if defined(IOTDATA_ENABLE_RADIATION_DOSE) && !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_radiation_dose(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_radiation_dose(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_radiation_dose(enc, (iotdata_float_t)j->valuedouble);
+    return iotdata_encode_radiation_dose(enc, (iotdata_float_t)jr_number(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_radiation_dose(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_radiation_dose(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->radiation_dose);
+    jw_fixed(jw, label, dec->radiation_dose, IOTDATA_RADIATION_DOSE_DECIMALS);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -2600,22 +3132,16 @@ static int dump_radiation_dose(const uint8_t *buf, size_t bb, size_t *bp, iotdat
     (void)label;
     size_t s = *bp;
     uint32_t r = bits_read(buf, bb, bp, IOTDATA_RADIATION_DOSE_BITS);
-#if !defined(IOTDATA_NO_FLOATING)
-    snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%.2f uSv/h", dequantise_radiation_dose(r));
-#else
-    fmt_scaled(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_radiation_dose(r), 100, "uSv/h");
-#endif
+    fmt_fixed_unit(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_radiation_dose(r), IOTDATA_RADIATION_DOSE_DECIMALS, 2, "uSv/h");
     n = dump_add(dump, n, s, IOTDATA_RADIATION_DOSE_BITS, r, dump->_dec_buf, "0..163.83, 0.01", "radiation_dose");
     return n;
 }
 #endif
 #if defined(IOTDATA_ENABLE_RADIATION_DOSE) && !defined(IOTDATA_NO_PRINT) && !defined(IOTDATA_NO_DECODE)
 static void print_radiation_dose(const iotdata_decoded_t *dec, iotdata_buf_t *bp, const char *label) {
-#if !defined(IOTDATA_NO_FLOATING)
-    bprintf(bp, "  %s:%s %.1f uSv/h\n", label, _padd(label), dec->radiation_dose);
-#else
-    bprintf(bp, "  %s:%s %d.%02d uSv/h\n", label, _padd(label), dec->radiation_dose / 100, dec->radiation_dose % 100);
-#endif
+    char d[_IOTDATA_FIXED_MAX];
+    fmt_fixed(d, dec->radiation_dose, IOTDATA_RADIATION_DOSE_DECIMALS, 1);
+    bprintf(bp, "  %s:%s %s uSv/h\n", label, _padd(label), d);
 }
 #endif
 // clang-format off
@@ -2627,7 +3153,7 @@ static const iotdata_field_ops_t _iotdata_field_def_radiation_dose = {
     _IOTDATA_OP_UNPACK(unpack_radiation_dose)
     _IOTDATA_OP_DUMP(dump_radiation_dose)
     _IOTDATA_OP_PRINT(print_radiation_dose)
-    _IOTDATA_OP_JSON_SET(json_set_radiation_dose)
+    _IOTDATA_OP_JSON_WRITE(json_write_radiation_dose)
     _IOTDATA_OP_JSON_GET(json_get_radiation_dose)
 };
 #define _IOTDATA_ENT_RADIATION_DOSE [IOTDATA_FIELD_RADIATION_DOSE] = &_iotdata_field_def_radiation_dose,
@@ -2654,8 +3180,7 @@ iotdata_status_t iotdata_encode_radiation(iotdata_encoder_t *enc, uint16_t cpm,
 #endif
     enc->radiation_cpm = cpm;
     enc->radiation_dose = usvh;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_RADIATION);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_RADIATION);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -2664,27 +3189,25 @@ static bool pack_radiation(uint8_t *buf, size_t bb, size_t *bp, const iotdata_en
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_radiation(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_radiation(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     return unpack_radiation_cpm(buf, bb, bp, dec) && unpack_radiation_dose(buf, bb, bp, dec);
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_radiation(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_radiation(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    cJSON *j_cpm = cJSON_GetObjectItem(j, "cpm"), *j_dose = cJSON_GetObjectItem(j, "dose");
+    const char *j_cpm = jr_member(j, "cpm"), *j_dose = jr_member(j, "dose");
     if (!j_cpm || !j_dose)
         return IOTDATA_OK;
-    return iotdata_encode_radiation(enc, (uint16_t)j_cpm->valueint, (iotdata_float_t)j_dose->valuedouble);
+    return iotdata_encode_radiation(enc, (uint16_t)jr_int(j_cpm), (iotdata_float_t)jr_number(j_dose));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_radiation(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
-    cJSON *obj = cJSON_AddObjectToObject(root, label);
-    json_set_radiation_cpm(obj, dec, "cpm", scratch);
-    json_set_radiation_dose(obj, dec, "dose", scratch);
+static void json_write_radiation(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+    jw_object_begin(jw, label);
+    json_write_radiation_cpm(jw, dec, "cpm", scratch);
+    json_write_radiation_dose(jw, dec, "dose", scratch);
+    jw_object_end(jw);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -2696,11 +3219,9 @@ static int dump_radiation(const uint8_t *buf, size_t bb, size_t *bp, iotdata_dum
 #endif
 #if !defined(IOTDATA_NO_PRINT) && !defined(IOTDATA_NO_DECODE)
 static void print_radiation(const iotdata_decoded_t *dec, iotdata_buf_t *bp, const char *label) {
-#if !defined(IOTDATA_NO_FLOATING)
-    bprintf(bp, "  %s:%s %" PRIu16 " CPM, %.2f uSv/h\n", label, _padd(label), dec->radiation_cpm, dec->radiation_dose);
-#else
-    bprintf(bp, "  %s:%s %" PRIu16 " CPM, %d.%02d uSv/h\n", label, _padd(label), dec->radiation_cpm, dec->radiation_dose / 100, dec->radiation_dose % 100);
-#endif
+    char d[_IOTDATA_FIXED_MAX];
+    fmt_fixed(d, dec->radiation_dose, IOTDATA_RADIATION_DOSE_DECIMALS, 2);
+    bprintf(bp, "  %s:%s %" PRIu16 " CPM, %s uSv/h\n", label, _padd(label), dec->radiation_cpm, d);
 }
 #endif
 // clang-format off
@@ -2711,7 +3232,7 @@ static const iotdata_field_ops_t _iotdata_field_def_radiation = {
     _IOTDATA_OP_UNPACK(unpack_radiation)
     _IOTDATA_OP_DUMP(dump_radiation)
     _IOTDATA_OP_PRINT(print_radiation)
-    _IOTDATA_OP_JSON_SET(json_set_radiation)
+    _IOTDATA_OP_JSON_WRITE(json_write_radiation)
     _IOTDATA_OP_JSON_GET(json_get_radiation)
 };
 #define _IOTDATA_ENT_RADIATION [IOTDATA_FIELD_RADIATION] = &_iotdata_field_def_radiation,
@@ -2736,8 +3257,7 @@ iotdata_status_t iotdata_encode_depth(iotdata_encoder_t *enc, uint16_t depth_cm)
         return IOTDATA_ERR_DEPTH_HIGH;
 #endif
     enc->depth = depth_cm;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_DEPTH);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_DEPTH);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -2756,7 +3276,7 @@ static bool pack_depth(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encode
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_depth(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_depth(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_DEPTH_BITS > bb)
         return false;
     dec->depth = dequantise_depth(bits_read(buf, bb, bp, IOTDATA_DEPTH_BITS));
@@ -2764,18 +3284,15 @@ static bool unpack_depth(const uint8_t *buf, size_t bb, size_t *bp, iotdata_deco
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_depth(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_depth(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_depth(enc, (uint16_t)j->valueint);
+    return iotdata_encode_depth(enc, (uint16_t)jr_int(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_depth(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_depth(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->depth);
+    jw_number(jw, label, dec->depth);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -2800,7 +3317,7 @@ static const iotdata_field_ops_t _iotdata_field_def_depth = {
     _IOTDATA_OP_UNPACK(unpack_depth)
     _IOTDATA_OP_DUMP(dump_depth)
     _IOTDATA_OP_PRINT(print_depth)
-    _IOTDATA_OP_JSON_SET(json_set_depth)
+    _IOTDATA_OP_JSON_WRITE(json_write_depth)
     _IOTDATA_OP_JSON_GET(json_get_depth)
 };
 #define _IOTDATA_ENT_DEPTH [IOTDATA_FIELD_DEPTH] = &_iotdata_field_def_depth,
@@ -2834,8 +3351,7 @@ iotdata_status_t iotdata_encode_position(iotdata_encoder_t *enc, iotdata_double_
 #endif
     enc->position_lat = latitude;
     enc->position_lon = longitude;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_POSITION);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_POSITION);
 }
 #endif
 #if !defined(IOTDATA_NO_FLOATING)
@@ -2895,7 +3411,7 @@ static bool pack_position(uint8_t *buf, size_t bb, size_t *bp, const iotdata_enc
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_position(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_position(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_POS_LAT_BITS + IOTDATA_POS_LON_BITS > bb)
         return false;
     dec->position_lat = dequantise_position_lat(bits_read(buf, bb, bp, IOTDATA_POS_LAT_BITS));
@@ -2904,23 +3420,21 @@ static bool unpack_position(const uint8_t *buf, size_t bb, size_t *bp, iotdata_d
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_position(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_position(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    cJSON *j_latitude = cJSON_GetObjectItem(j, "latitude"), *j_longitude = cJSON_GetObjectItem(j, "longitude");
+    const char *j_latitude = jr_member(j, "latitude"), *j_longitude = jr_member(j, "longitude");
     if (!j_latitude || !j_longitude)
         return IOTDATA_OK;
-    return iotdata_encode_position(enc, (iotdata_double_t)j_latitude->valuedouble, (iotdata_double_t)j_longitude->valuedouble);
+    return iotdata_encode_position(enc, (iotdata_double_t)jr_number(j_latitude), (iotdata_double_t)jr_number(j_longitude));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_position(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_position(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *obj = cJSON_AddObjectToObject(root, label);
-    cJSON_AddNumberToObject(obj, "latitude", dec->position_lat);
-    cJSON_AddNumberToObject(obj, "longitude", dec->position_lon);
+    jw_object_begin(jw, label);
+    jw_fixed(jw, "latitude", dec->position_lat, IOTDATA_POS_DECIMALS);
+    jw_fixed(jw, "longitude", dec->position_lon, IOTDATA_POS_DECIMALS);
+    jw_object_end(jw);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -2928,31 +3442,21 @@ static int dump_position(const uint8_t *buf, size_t bb, size_t *bp, iotdata_dump
     (void)label;
     size_t s = *bp;
     uint32_t r = bits_read(buf, bb, bp, IOTDATA_POS_LAT_BITS);
-#if !defined(IOTDATA_NO_FLOATING)
-    snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%.6f", dequantise_position_lat(r));
-#else
-    fmt_scaled(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_position_lat(r), 10000000, "");
-#endif
+    fmt_fixed_unit(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_position_lat(r), IOTDATA_POS_DECIMALS, 6, "");
     n = dump_add(dump, n, s, IOTDATA_POS_LAT_BITS, r, dump->_dec_buf, "-90..+90", "latitude");
     s = *bp;
     r = bits_read(buf, bb, bp, IOTDATA_POS_LON_BITS);
-#if !defined(IOTDATA_NO_FLOATING)
-    snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%.6f", dequantise_position_lon(r));
-#else
-    fmt_scaled(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_position_lon(r), 10000000, "");
-#endif
+    fmt_fixed_unit(dump->_dec_buf, sizeof(dump->_dec_buf), dequantise_position_lon(r), IOTDATA_POS_DECIMALS, 6, "");
     n = dump_add(dump, n, s, IOTDATA_POS_LON_BITS, r, dump->_dec_buf, "-180..+180", "longitude");
     return n;
 }
 #endif
 #if !defined(IOTDATA_NO_PRINT) && !defined(IOTDATA_NO_DECODE)
 static void print_position(const iotdata_decoded_t *dec, iotdata_buf_t *bp, const char *label) {
-#if !defined(IOTDATA_NO_FLOATING)
-    bprintf(bp, "  %s:%s %.6f, %.6f\n", label, _padd(label), dec->position_lat, dec->position_lon);
-#else
-    const int32_t lat = dec->position_lat, la = lat < 0 ? -lat : lat, lon = dec->position_lon, lo = lon < 0 ? -lon : lon;
-    bprintf(bp, "  %s:%s %s%d.%06d, %s%d.%06d\n", label, _padd(label), lat < 0 ? "-" : "", (int)(la / 10000000), (int)(la % 10000000), lon < 0 ? "-" : "", (int)(lo / 10000000), (int)(lo % 10000000));
-#endif
+    char lat[_IOTDATA_FIXED_MAX], lon[_IOTDATA_FIXED_MAX];
+    fmt_fixed(lat, dec->position_lat, IOTDATA_POS_DECIMALS, 6);
+    fmt_fixed(lon, dec->position_lon, IOTDATA_POS_DECIMALS, 6);
+    bprintf(bp, "  %s:%s %s, %s\n", label, _padd(label), lat, lon);
 }
 #endif
 // clang-format off
@@ -2963,7 +3467,7 @@ static const iotdata_field_ops_t _iotdata_field_def_position = {
     _IOTDATA_OP_UNPACK(unpack_position)
     _IOTDATA_OP_DUMP(dump_position)
     _IOTDATA_OP_PRINT(print_position)
-    _IOTDATA_OP_JSON_SET(json_set_position)
+    _IOTDATA_OP_JSON_WRITE(json_write_position)
     _IOTDATA_OP_JSON_GET(json_get_position)
 };
 #define _IOTDATA_ENT_POSITION [IOTDATA_FIELD_POSITION] = &_iotdata_field_def_position,
@@ -2996,8 +3500,7 @@ iotdata_status_t iotdata_encode_datetime(iotdata_encoder_t *enc, uint32_t second
         return IOTDATA_ERR_DATETIME_HIGH;
 #endif
     enc->datetime_secs = seconds_from_year_start;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_DATETIME);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_DATETIME);
 }
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
@@ -3016,7 +3519,7 @@ static bool pack_datetime(uint8_t *buf, size_t bb, size_t *bp, const iotdata_enc
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_datetime(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_datetime(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_DATETIME_BITS > bb)
         return false;
     dec->datetime_secs = dequantise_datetime(bits_read(buf, bb, bp, IOTDATA_DATETIME_BITS));
@@ -3024,18 +3527,15 @@ static bool unpack_datetime(const uint8_t *buf, size_t bb, size_t *bp, iotdata_d
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_datetime(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_datetime(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_datetime(enc, (uint32_t)j->valueint);
+    return iotdata_encode_datetime(enc, (uint32_t)jr_int(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_datetime(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_datetime(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->datetime_secs);
+    jw_number(jw, label, dec->datetime_secs);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -3063,7 +3563,7 @@ static const iotdata_field_ops_t _iotdata_field_def_datetime = {
     _IOTDATA_OP_UNPACK(unpack_datetime)
     _IOTDATA_OP_DUMP(dump_datetime)
     _IOTDATA_OP_PRINT(print_datetime)
-    _IOTDATA_OP_JSON_SET(json_set_datetime)
+    _IOTDATA_OP_JSON_WRITE(json_write_datetime)
     _IOTDATA_OP_JSON_GET(json_get_datetime)
 };
 #define _IOTDATA_ENT_DATETIME [IOTDATA_FIELD_DATETIME] = &_iotdata_field_def_datetime,
@@ -3132,70 +3632,93 @@ static void _pixel_set(uint8_t *buf, size_t idx, uint8_t val, uint8_t bpp) {
  *
  * Greyscale (2bpp, 4bpp):
  *   2-byte runs: [value:8] [count-1:8] (1..256 pixels)
+ *
+ * Runs are measured a 64-bit window at a time: the window XOR the run value
+ * replicated across every pixel slot is zero up to the first differing pixel,
+ * found with a count of leading zeros. Decompression fills the whole bytes
+ * of a run with memset, setting only the partial bytes at each end per pixel.
  * ------------------------------------------------------------------------- */
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SIZEOF_LONG_LONG__) && __SIZEOF_LONG_LONG__ == 8
+#define _image_clz64(x) __builtin_clzll(x)
+#else
+static int _image_clz64(uint64_t x) {
+    int n = 0;
+    for (; !(x & 0x8000000000000000ULL); x <<= 1)
+        n++;
+    return n;
+}
+#endif
+static bool _image_rle_bpp(uint8_t bpp) {
+    return bpp == 1 || bpp == 2 || bpp == 4;
+}
+/* A byte with every bpp-wide slot holding val */
+static uint8_t _pixel_byte(uint8_t val, uint8_t bpp) {
+    return bpp == 1 ? (uint8_t)(val & 1 ? 0xFF : 0x00) : bpp == 2 ? (uint8_t)((val & 3) * 0x55) : (uint8_t)((val & 0x0F) * 0x11);
+}
+/* Number of pixels from idx (up to limit) equal to val */
+static size_t _pixel_run(const uint8_t *buf, size_t buf_bytes, size_t idx, uint8_t val, uint8_t bpp, size_t limit) {
+    const uint64_t pattern = _pixel_byte(val, bpp) * 0x0101010101010101ULL;
+    size_t run = 0;
+    while (run < limit) {
+        const size_t bit = (idx + run) * bpp, byte = bit >> 3;
+        const unsigned shift = (unsigned)(bit & 7);
+        const uint64_t x = (bits_window_load(buf + byte, buf_bytes - byte) << shift) ^ pattern;
+        const size_t avail = (64U - shift) / bpp, same = x ? (size_t)_image_clz64(x) / bpp : avail;
+        if (same < avail) {
+            run += same;
+            break;
+        }
+        run += avail;
+    }
+    return run < limit ? run : limit;
+}
+static void _pixel_fill(uint8_t *buf, size_t idx, size_t count, uint8_t val, uint8_t bpp) {
+    for (; count > 0 && ((idx * bpp) & 7) != 0; idx++, count--)
+        _pixel_set(buf, idx, val, bpp);
+    const size_t whole = count * bpp / 8;
+    if (whole > 0) {
+        memset(buf + idx * bpp / 8, _pixel_byte(val, bpp), whole);
+        idx += whole * 8 / bpp;
+        count -= whole * 8 / bpp;
+    }
+    for (; count > 0; idx++, count--)
+        _pixel_set(buf, idx, val, bpp);
+}
 size_t iotdata_image_rle_compress(const uint8_t *pixels, size_t pixel_count, uint8_t bpp, uint8_t *out, size_t out_max) {
-    if (!pixels || !out || pixel_count == 0 || bpp == 0)
+    if (!pixels || pixel_count == 0 || !_image_rle_bpp(bpp))
         return 0;
+    const size_t pixel_bytes = (pixel_count * bpp + 7) / 8, run_max = bpp == 1 ? (1 << 7) : (1 << 8);
     size_t op = 0;
-    if (bpp == 1) {
-        uint8_t cur = _pixel_get(pixels, 0, 1);
-        size_t count = 1;
-        for (size_t i = 1; i < pixel_count; i++) {
-            const uint8_t px = _pixel_get(pixels, i, 1);
-            if (px == cur && count < (1 << 7))
-                count++;
-            else {
-                if (op >= out_max)
-                    return 0;
-                out[op++] = (uint8_t)((cur << 7) | (count - 1));
-                cur = px;
-                count = 1;
-            }
-        }
-        if (op >= out_max)
+    for (size_t i = 0; i < pixel_count;) {
+        const uint8_t cur = _pixel_get(pixels, i, bpp);
+        const size_t count = _pixel_run(pixels, pixel_bytes, i, cur, bpp, pixel_count - i < run_max ? pixel_count - i : run_max);
+        if (op + (bpp == 1 ? 1 : 2) > out_max)
             return 0;
-        out[op++] = (uint8_t)((cur << 7) | (count - 1));
-    } else {
-        uint8_t cur = _pixel_get(pixels, 0, bpp);
-        size_t count = 1;
-        for (size_t i = 1; i < pixel_count; i++) {
-            const uint8_t px = _pixel_get(pixels, i, bpp);
-            if (px == cur && count < (1 << 8))
-                count++;
-            else {
-                if (op + 2 > out_max)
-                    return 0;
-                out[op++] = cur;
-                out[op++] = (uint8_t)(count - 1);
-                cur = px;
-                count = 1;
-            }
+        if (!out) /* size only */
+            op += bpp == 1 ? 1 : 2;
+        else if (bpp == 1)
+            out[op++] = (uint8_t)((cur << 7) | (count - 1));
+        else {
+            out[op++] = cur;
+            out[op++] = (uint8_t)(count - 1);
         }
-        if (op + 2 > out_max)
-            return 0;
-        out[op++] = cur;
-        out[op++] = (uint8_t)(count - 1);
+        i += count;
     }
     return op;
 }
 size_t iotdata_image_rle_decompress(const uint8_t *compressed, size_t comp_len, uint8_t bpp, uint8_t *pixels, size_t pixel_buf_bytes) {
-    if (!compressed || !pixels || comp_len == 0 || bpp == 0)
+    if (!compressed || !pixels || comp_len == 0 || !_image_rle_bpp(bpp))
         return 0;
+    const size_t px_max = (pixel_buf_bytes * 8) / bpp;
     size_t px_idx = 0;
-    if (bpp == 1)
-        for (size_t ip = 0; ip < comp_len; ip++) {
-            const uint8_t val = (compressed[ip] >> 7) & 1;
-            const size_t count = (compressed[ip] & 0x7F) + 1;
-            for (size_t j = 0; j < count && px_idx < (pixel_buf_bytes * 8) / bpp; j++)
-                _pixel_set(pixels, px_idx++, val, 1);
-        }
-    else
-        for (size_t ip = 0; ip + 1 < comp_len; ip += 2) {
-            const uint8_t val = compressed[ip];
-            const size_t count = (size_t)compressed[ip + 1] + 1;
-            for (size_t j = 0; j < count && px_idx < (pixel_buf_bytes * 8) / bpp; j++)
-                _pixel_set(pixels, px_idx++, val, bpp);
-        }
+    for (size_t ip = 0; ip + (bpp == 1 ? 0 : 1) < comp_len; ip += bpp == 1 ? 1 : 2) {
+        const uint8_t val = bpp == 1 ? (compressed[ip] >> 7) & 1 : compressed[ip];
+        size_t count = bpp == 1 ? (size_t)(compressed[ip] & 0x7F) + 1 : (size_t)compressed[ip + 1] + 1;
+        if (count > px_max - px_idx)
+            count = px_max - px_idx;
+        _pixel_fill(pixels, px_idx, count, val, bpp);
+        px_idx += count;
+    }
     const size_t used_bits = px_idx * bpp;
     if ((used_bits % 8) > 0)
         pixels[used_bits / 8] &= (uint8_t)(0xFF << (8 - (used_bits % 8)));
@@ -3217,12 +3740,21 @@ size_t iotdata_image_rle_decompress(const uint8_t *compressed, size_t comp_len,
  *   Flag 0 → literal: [byte:8]
  *
  * Decoder RAM: ~256 bytes (output serves as window).
- * Encoder: brute-force search, O(N * W * L) — fine for <=384-byte inputs.
+ * Encoder RAM: ~1 KB. Window positions are chained by a hash of their first
+ *   two bytes (the minimum match), so a search visits only positions that
+ *   can match, newest first, at most IOTDATA_IMAGE_HS_CHAIN_MAX of them.
+ *   Greedy parsing takes the longest match; lazy parsing first emits a
+ *   literal when the next position has one at least two bytes longer (a
+ *   literal costs 9 bits against 13 for a backref, so one byte is not enough).
+ *   Optimal parsing finds the longest match at every position of a block of
+ *   _HS_OPT_BLOCK positions (~1.3 KB more) and picks the fewest-bit path.
  * ------------------------------------------------------------------------- */
-#define _HS_W      (1 << IOTDATA_IMAGE_HS_WINDOW_SZ2)    /* 256 */
-#define _HS_L      (1 << IOTDATA_IMAGE_HS_LOOKAHEAD_SZ2) /* 16 */
-#define _HS_W_BITS IOTDATA_IMAGE_HS_WINDOW_SZ2           /* 8 */
-#define _HS_L_BITS IOTDATA_IMAGE_HS_LOOKAHEAD_SZ2        /* 4 */
+#define _HS_W         (1 << IOTDATA_IMAGE_HS_WINDOW_SZ2)    /* 256 */
+#define _HS_L         (1 << IOTDATA_IMAGE_HS_LOOKAHEAD_SZ2) /* 16 */
+#define _HS_W_BITS    IOTDATA_IMAGE_HS_WINDOW_SZ2           /* 8 */
+#define _HS_L_BITS    IOTDATA_IMAGE_HS_LOOKAHEAD_SZ2        /* 4 */
+#define _HS_H_BITS    8
+#define _HS_OPT_BLOCK 256
 typedef struct {
     uint8_t *buf;
     size_t max;
@@ -3236,25 +3768,35 @@ static void _hs_bw_init(_hs_bw_t *bw, uint8_t *buf, size_t max) {
     bw->byte_idx = 0;
     bw->bit_idx = 7;
     bw->overflow = false;
-    if (max > 0)
+    if (buf && max > 0)
         buf[0] = 0;
 }
 static void _hs_bw_put(_hs_bw_t *bw, uint32_t value, uint8_t nbits) {
-    for (int i = nbits - 1; i >= 0; i--) {
+    if (!bw->buf) { /* size only */
+        const size_t pos = bw->byte_idx * 8 + (size_t)(7 - bw->bit_idx) + nbits;
+        if (pos > bw->max * 8)
+            bw->overflow = true;
+        else {
+            bw->byte_idx = pos >> 3;
+            bw->bit_idx = (uint8_t)(7 - (pos & 7));
+        }
+        return;
+    }
+    while (nbits > 0) {
         if (bw->byte_idx >= bw->max) {
             bw->overflow = true;
             break;
         }
-        if (value & (1U << i))
-            bw->buf[bw->byte_idx] |= (1U << bw->bit_idx);
-        if (bw->bit_idx == 0) {
+        const uint8_t room = (uint8_t)(bw->bit_idx + 1), take = nbits < room ? nbits : room;
+        nbits = (uint8_t)(nbits - take);
+        bw->buf[bw->byte_idx] |= (uint8_t)(((value >> nbits) & ((1U << take) - 1)) << (room - take));
+        if (take == room) {
             bw->bit_idx = 7;
             bw->byte_idx++;
             if (bw->byte_idx < bw->max)
                 bw->buf[bw->byte_idx] = 0;
-        } else {
-            bw->bit_idx--;
-        }
+        } else
+            bw->bit_idx = (uint8_t)(bw->bit_idx - take);
     }
 }
 static size_t _hs_bw_bytes(const _hs_bw_t *bw) {
@@ -3291,44 +3833,145 @@ static int _hs_br_get(_hs_br_t *br, uint8_t nbits) {
 static bool _hs_br_done(const _hs_br_t *br) {
     return br->byte_idx >= br->len;
 }
-size_t iotdata_image_hs_compress(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_max) {
-    if (!in || !out || in_len == 0 || out_max == 0)
-        return 0;
-    _hs_bw_t bw;
-    _hs_bw_init(&bw, out, out_max);
-    size_t ip = 0;
-    while (ip < in_len && !bw.overflow) {
-        /* Search for longest match in window */
-        size_t best_len = 0, best_off = 0;
-        const size_t max_match = (in_len - ip) < _HS_L ? (in_len - ip) : _HS_L;
-        for (size_t off = ip > _HS_W ? ip - _HS_W : 0; off < ip; off++) {
-            size_t ml = 0;
-            while (ml < max_match && in[off + ml] == in[ip + ml])
+/* Chains hold positions modulo 2^16; a link is followed only while its distance grows and stays within the window */
+typedef struct {
+    uint16_t head[1 << _HS_H_BITS];
+    uint16_t prev[_HS_W];
+} _hs_chain_t;
+static void _hs_chain_init(_hs_chain_t *hc) {
+    for (size_t i = 0; i < sizeof(hc->head) / sizeof(hc->head[0]); i++)
+        hc->head[i] = (uint16_t)(0U - (_HS_W + 1)); /* out of reach of the first 64 KB */
+}
+static size_t _hs_hash(const uint8_t *p) {
+    return (((uint32_t)p[0] << 8 | p[1]) * 2654435761U) >> (32 - _HS_H_BITS);
+}
+static void _hs_chain_insert(_hs_chain_t *hc, const uint8_t *in, size_t pos) {
+    const size_t h = _hs_hash(in + pos);
+    hc->prev[pos & (_HS_W - 1)] = hc->head[h];
+    hc->head[h] = (uint16_t)pos;
+}
+/* Longest match for in[ip..] (ip + 1 < in_len, positions before ip inserted); returns its length, distance into *dist */
+static size_t _hs_chain_match(const _hs_chain_t *hc, const uint8_t *in, size_t in_len, size_t ip, size_t *dist) {
+    const size_t max_match = (in_len - ip) < _HS_L ? (in_len - ip) : _HS_L;
+    size_t best_len = 0, last = 0;
+    uint16_t cand = hc->head[_hs_hash(in + ip)];
+    for (int depth = 0; depth < IOTDATA_IMAGE_HS_CHAIN_MAX; depth++) {
+        const size_t d = (uint16_t)(ip - cand);
+        if (d <= last || d > _HS_W || d > ip)
+            break;
+        const uint8_t *m = in + ip - d;
+        if (m[best_len] == in[ip + best_len] && m[0] == in[ip]) {
+            size_t ml = 1;
+            while (ml < max_match && m[ml] == in[ip + ml])
                 ml++;
             if (ml > best_len) {
                 best_len = ml;
-                best_off = ip - off;
+                *dist = d;
                 if (ml == max_match)
                     break;
             }
         }
-        if (best_len >= 2) {
-            /* Backref: flag(1) + index(W_BITS) + count(L_BITS) */
-            _hs_bw_put(&bw, 1, 1);
-            _hs_bw_put(&bw, (uint32_t)(best_off - 1), _HS_W_BITS);
-            _hs_bw_put(&bw, (uint32_t)(best_len - 1), _HS_L_BITS);
-            ip += best_len;
-        } else {
-            /* Literal: flag(0) + byte(8) */
-            _hs_bw_put(&bw, 0, 1);
-            _hs_bw_put(&bw, in[ip], 8);
-            ip++;
+        last = d;
+        cand = hc->prev[cand & (_HS_W - 1)];
+    }
+    return best_len;
+}
+static void _hs_emit(_hs_bw_t *bw, const uint8_t *in, size_t ip, size_t len, size_t dist) {
+    if (len >= 2) {
+        /* Backref: flag(1) + index(W_BITS) + count(L_BITS) */
+        _hs_bw_put(bw, 1, 1);
+        _hs_bw_put(bw, (uint32_t)(dist - 1), _HS_W_BITS);
+        _hs_bw_put(bw, (uint32_t)(len - 1), _HS_L_BITS);
+    } else {
+        /* Literal: flag(0) + byte(8) */
+        _hs_bw_put(bw, 0, 1);
+        _hs_bw_put(bw, in[ip], 8);
+    }
+}
+static void _hs_parse_greedy(const uint8_t *in, size_t in_len, _hs_bw_t *bw, bool lazy) {
+    _hs_chain_t hc;
+    _hs_chain_init(&hc);
+    size_t ip = 0, inserted = 0;
+    while (ip < in_len && !bw->overflow) {
+        size_t best_len = 0, best_off = 0;
+        if (ip + 1 < in_len) {
+            for (; inserted < ip; inserted++)
+                _hs_chain_insert(&hc, in, inserted);
+            best_len = _hs_chain_match(&hc, in, in_len, ip, &best_off);
+            if (lazy && best_len >= 2 && best_len < _HS_L && ip + 2 < in_len) {
+                size_t next_off;
+                _hs_chain_insert(&hc, in, inserted++);
+                if (_hs_chain_match(&hc, in, in_len, ip + 1, &next_off) > best_len + 1)
+                    best_len = 0; /* literal now, the longer match next */
+            }
+        }
+        _hs_emit(bw, in, ip, best_len, best_off);
+        ip += best_len >= 2 ? best_len : 1;
+    }
+}
+/*
+ * A backref costs 13 bits whatever its length and distance, so the longest
+ * match at a position also offers every shorter length at the same distance.
+ * Costs to the end of the block are taken backwards from there, ties going
+ * to the longer step. As matches are cut at the block end, the path is
+ * emitted only through the first three quarters of the block; the rest is
+ * carried, with its matches, into the next one.
+ */
+static void _hs_parse_optimal(const uint8_t *in, size_t in_len, _hs_bw_t *bw) {
+    _hs_chain_t hc;
+    _hs_chain_init(&hc);
+    uint8_t len[_HS_OPT_BLOCK], dist[_HS_OPT_BLOCK], step[_HS_OPT_BLOCK];
+    uint16_t cost[_HS_OPT_BLOCK + 1];
+    size_t ip = 0, inserted = 0, found = 0; /* matches known for [ip, ip + found) */
+    while (ip < in_len && !bw->overflow) {
+        const size_t n = (in_len - ip) < _HS_OPT_BLOCK ? (in_len - ip) : _HS_OPT_BLOCK;
+        for (; found < n; found++) {
+            const size_t p = ip + found;
+            size_t ml = 0, d = 1;
+            if (p + 1 < in_len) {
+                for (; inserted < p; inserted++)
+                    _hs_chain_insert(&hc, in, inserted);
+                ml = _hs_chain_match(&hc, in, in_len, p, &d);
+            }
+            len[found] = (uint8_t)(ml >= 2 ? ml : 0);
+            dist[found] = (uint8_t)(d - 1);
+        }
+        cost[n] = 0;
+        for (size_t i = n; i-- > 0;) {
+            cost[i] = (uint16_t)(cost[i + 1] + 1 + 8);
+            step[i] = 1;
+            for (size_t k = 2, k_max = len[i] < n - i ? len[i] : n - i; k <= k_max; k++)
+                if (cost[i + k] + 1 + _HS_W_BITS + _HS_L_BITS <= cost[i]) {
+                    cost[i] = (uint16_t)(cost[i + k] + 1 + _HS_W_BITS + _HS_L_BITS);
+                    step[i] = (uint8_t)k;
+                }
         }
+        const size_t stop = ip + n == in_len ? n : n - _HS_OPT_BLOCK / 4;
+        size_t i = 0;
+        for (; i < stop && !bw->overflow; i += step[i])
+            _hs_emit(bw, in, ip + i, step[i], (size_t)dist[i] + 1);
+        found = n - i;
+        memmove(len, len + i, found);
+        memmove(dist, dist + i, found);
+        ip += i;
     }
+}
+size_t iotdata_image_hs_compress_parse(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_max, uint8_t parse) {
+    if (!in || in_len == 0 || out_max == 0)
+        return 0;
+    _hs_bw_t bw;
+    _hs_bw_init(&bw, out, out_max);
+    if (parse == IOTDATA_IMAGE_HS_PARSE_OPTIMAL)
+        _hs_parse_optimal(in, in_len, &bw);
+    else
+        _hs_parse_greedy(in, in_len, &bw, parse == IOTDATA_IMAGE_HS_PARSE_LAZY);
     if (bw.overflow)
         return 0;
     return _hs_bw_bytes(&bw);
 }
+size_t iotdata_image_hs_compress(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_max) {
+    return iotdata_image_hs_compress_parse(in, in_len, out, out_max, IOTDATA_IMAGE_HS_PARSE_GREEDY);
+}
 size_t iotdata_image_hs_decompress(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_max) {
     if (!in || !out || in_len == 0 || out_max == 0)
         return 0;
@@ -3382,9 +4025,89 @@ iotdata_status_t iotdata_encode_image(iotdata_encoder_t *enc, uint8_t pixel_form
     enc->image_flags = flags & 0x03;
     enc->image_data = data;
     enc->image_data_len = data_len;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_IMAGE);
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_IMAGE);
+}
+/* Nearest pixel to the centre of each destination pixel */
+static void _image_downscale(const uint8_t *src, uint8_t src_tier, uint8_t *dst, uint8_t dst_tier, uint8_t bpp) {
+    const size_t sw = _image_widths[src_tier], sh = _image_heights[src_tier], dw = _image_widths[dst_tier], dh = _image_heights[dst_tier];
+    for (size_t y = 0; y < dh; y++) {
+        const size_t sy = (2 * y + 1) * sh / (2 * dh);
+        for (size_t x = 0; x < dw; x++)
+            _pixel_set(dst, y * dw + x, _pixel_get(src, sy * sw + (2 * x + 1) * sw / (2 * dw), bpp), bpp);
+    }
+}
+/* Bytes left for image pixel data once the fields already added, and the image field's own length and control bytes, are packed */
+static iotdata_status_t _image_data_room(const iotdata_encoder_t *enc, uint8_t pixel_format, uint8_t size_tier, uint8_t flags, size_t *room) {
+#if defined(IOTDATA_ENCODE_STREAMING)
+    (void)pixel_format;
+    (void)size_tier;
+    (void)flags;
+    const size_t used = enc->packed_bits + 16;
+    if (used > enc->buf_size * 8)
+        return IOTDATA_ERR_BUF_TOO_SMALL;
+    *room = (enc->buf_size * 8 - used) / 8;
+#else
+    iotdata_encoder_t trial = *enc; /* packs into enc->buf, which iotdata_encode_end() rewrites from the start */
+    iotdata_status_t rc;
+    size_t bytes;
+    if ((rc = iotdata_encode_image(&trial, pixel_format, size_tier, IOTDATA_IMAGE_COMP_RAW, flags, NULL, 0)) != IOTDATA_OK || (rc = iotdata_encode_end(&trial, &bytes)) != IOTDATA_OK)
+        return rc;
+    *room = enc->buf_size - bytes;
+#endif
+    if (*room > IOTDATA_IMAGE_DATA_MAX)
+        *room = IOTDATA_IMAGE_DATA_MAX;
     return IOTDATA_OK;
 }
+iotdata_status_t iotdata_image_encode_best(iotdata_encoder_t *enc, uint8_t pixel_format, uint8_t size_tier, uint8_t flags, const uint8_t *pixels, uint8_t hs_parse, iotdata_image_encode_best_scratch_t *scratch) {
+    CHECK_CTX_ACTIVE(enc);
+    CHECK_NOT_DUPLICATE(enc, IOTDATA_FIELD_IMAGE);
+#if !defined(IOTDATA_NO_CHECKS_TYPES)
+    if (pixel_format > 2)
+        return IOTDATA_ERR_IMAGE_FORMAT_HIGH;
+    if (size_tier > 3)
+        return IOTDATA_ERR_IMAGE_SIZE_HIGH;
+    if (!pixels)
+        return IOTDATA_ERR_IMAGE_DATA_NULL;
+#endif
+#if !defined(IOTDATA_NO_CHECKS_STATE)
+    if (!scratch)
+        return IOTDATA_ERR_BUF_NULL;
+#endif
+    iotdata_status_t rc;
+    size_t room;
+    if ((rc = _image_data_room(enc, pixel_format, size_tier, flags, &room)) != IOTDATA_OK)
+        return rc;
+    const uint8_t bpp = iotdata_image_bpp(pixel_format);
+    for (int tier = size_tier; tier >= 0; tier--) {
+        const uint8_t *px = pixels;
+        if (tier != size_tier) {
+            _image_downscale(pixels, size_tier, scratch->pixels, (uint8_t)tier, bpp);
+            px = scratch->pixels;
+        }
+        const size_t count = iotdata_image_pixel_count((uint8_t)tier), raw = iotdata_image_bytes(pixel_format, (uint8_t)tier);
+        /* Sizes only, each run stopping once it no longer beats the best so far; ties go to the cheaper decode */
+        size_t best = raw <= room ? raw : room + 1, n;
+        uint8_t comp = IOTDATA_IMAGE_COMP_RAW;
+        if ((n = iotdata_image_rle_compress(px, count, bpp, NULL, best - 1)) > 0) {
+            best = n;
+            comp = IOTDATA_IMAGE_COMP_RLE;
+        }
+        if ((n = iotdata_image_hs_compress_parse(px, raw, NULL, best - 1, hs_parse)) > 0) {
+            best = n;
+            comp = IOTDATA_IMAGE_COMP_HEATSHRINK;
+        }
+        if (best > room)
+            continue;
+        if (comp == IOTDATA_IMAGE_COMP_RAW)
+            memcpy(scratch->data, px, best);
+        else if (comp == IOTDATA_IMAGE_COMP_RLE)
+            iotdata_image_rle_compress(px, count, bpp, scratch->data, best);
+        else
+            iotdata_image_hs_compress_parse(px, raw, scratch->data, best, hs_parse);
+        return iotdata_encode_image(enc, pixel_format, (uint8_t)tier, comp, flags, scratch->data, (uint8_t)best);
+    }
+    return IOTDATA_ERR_BUF_TOO_SMALL;
+}
 #endif
 #if !defined(IOTDATA_NO_ENCODE)
 static bool pack_image(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encoder_t *enc) {
@@ -3402,7 +4125,7 @@ static bool pack_image(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encode
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_image(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_image(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + 16 > bb)
         return false; /* need at least length + control */
     const uint8_t length = (uint8_t)bits_read(buf, bb, bp, 8);
@@ -3415,12 +4138,10 @@ static bool unpack_image(const uint8_t *buf, size_t bb, size_t *bp, iotdata_deco
     dec->image_size_tier = (control >> 4) & 0x03;
     dec->image_compression = (control >> 2) & 0x03;
     dec->image_flags = control & 0x03;
-    dec->image_data_len = 0;
-    for (int i = 0; i < (length - 1); i++) {
-        const uint8_t pixel = (uint8_t)bits_read(buf, bb, bp, 8);
-        if (i < IOTDATA_IMAGE_DATA_MAX)
-            dec->image_data[dec->image_data_len++] = pixel;
-    }
+    /* Pixel data left in place: length - 1 never exceeds IOTDATA_IMAGE_DATA_MAX */
+    dec->image_data_len = (uint8_t)(length - 1);
+    dec->image_data_offset = (uint16_t)*bp;
+    *bp += (size_t)dec->image_data_len * 8;
     return true;
 }
 #endif
@@ -3430,58 +4151,43 @@ static const char *_image_size_names[] = { "24x18", "32x24", "48x36", "64x48" };
 static const char *_image_comp_names[] = { "raw", "rle", "heatshrink", "reserved" };
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_image(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
-    cJSON *obj = cJSON_AddObjectToObject(root, label);
-    cJSON_AddStringToObject(obj, "format", _image_fmt_names[dec->image_pixel_format & 0x03]);
-    cJSON_AddStringToObject(obj, "size", _image_size_names[dec->image_size_tier & 0x03]);
-    cJSON_AddStringToObject(obj, "compression", _image_comp_names[dec->image_compression & 0x03]);
-    cJSON_AddBoolToObject(obj, "fragment", (dec->image_flags & IOTDATA_IMAGE_FLAG_FRAGMENT) != 0);
-    cJSON_AddBoolToObject(obj, "invert", (dec->image_flags & IOTDATA_IMAGE_FLAG_INVERT) != 0);
+static void json_write_image(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+    jw_object_begin(jw, label);
+    jw_string(jw, "format", _image_fmt_names[dec->image_pixel_format & 0x03]);
+    jw_string(jw, "size", _image_size_names[dec->image_size_tier & 0x03]);
+    jw_string(jw, "compression", _image_comp_names[dec->image_compression & 0x03]);
+    jw_bool(jw, "fragment", (dec->image_flags & IOTDATA_IMAGE_FLAG_FRAGMENT) != 0);
+    jw_bool(jw, "invert", (dec->image_flags & IOTDATA_IMAGE_FLAG_INVERT) != 0);
     if (dec->image_data_len > 0)
-        cJSON_AddStringToObject(obj, "pixels", _b64_encode(dec->image_data, dec->image_data_len, scratch->image.b64));
+        jw_string(jw, "pixels", _b64_encode(dec->image_data, dec->image_data_len, scratch->image.b64));
+    jw_object_end(jw);
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_image(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    /* Parse pixel_format */
-    uint8_t fmt = 0;
-    cJSON *jf = cJSON_GetObjectItem(j, "format");
-    if (jf && jf->valuestring)
-        for (int i = 0; i < (int)(sizeof(_image_fmt_names) / sizeof(_image_fmt_names[0])); i++)
-            if (strcmp(jf->valuestring, _image_fmt_names[i]) == 0) {
-                fmt = (uint8_t)i;
-                break;
-            }
-    /* Parse size */
-    uint8_t sz = 0;
-    cJSON *js = cJSON_GetObjectItem(j, "size");
-    if (js && js->valuestring)
-        for (int i = 0; i < (int)(sizeof(_image_size_names) / sizeof(_image_size_names[0])); i++)
-            if (strcmp(js->valuestring, _image_size_names[i]) == 0) {
-                sz = (uint8_t)i;
-                break;
-            }
-    /* Parse compression */
-    uint8_t comp = 0;
-    cJSON *jc = cJSON_GetObjectItem(j, "compression");
-    if (jc && jc->valuestring)
-        for (int i = 0; i < (int)(sizeof(_image_comp_names) / sizeof(_image_comp_names[0])); i++)
-            if (strcmp(jc->valuestring, _image_comp_names[i]) == 0) {
-                comp = (uint8_t)i;
-                break;
-            }
+static uint8_t _json_get_image_name(const char *v, const char *const *names, int count) {
+    char str[16];
+    if (jr_string(v, str, sizeof(str)) >= 0)
+        for (int i = 0; i < count; i++)
+            if (strcmp(str, names[i]) == 0)
+                return (uint8_t)i;
+    return 0;
+}
+static iotdata_status_t json_get_image(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
+    static const char *const names[] = { "format", "size", "compression", "fragment", "invert", "pixels" };
+    const char *jv[6];
+    jr_object(j, names, 6, jv);
+    /* Parse pixel_format, size, compression */
+    const uint8_t fmt = _json_get_image_name(jv[0], _image_fmt_names, (int)(sizeof(_image_fmt_names) / sizeof(_image_fmt_names[0])));
+    const uint8_t sz = _json_get_image_name(jv[1], _image_size_names, (int)(sizeof(_image_size_names) / sizeof(_image_size_names[0])));
+    const uint8_t comp = _json_get_image_name(jv[2], _image_comp_names, (int)(sizeof(_image_comp_names) / sizeof(_image_comp_names[0])));
     /* Parse flags */
     uint8_t flags = 0;
-    if (cJSON_IsTrue(cJSON_GetObjectItem(j, "fragment")))
+    if (jr_true(jv[3]))
         flags |= IOTDATA_IMAGE_FLAG_FRAGMENT;
-    if (cJSON_IsTrue(cJSON_GetObjectItem(j, "invert")))
+    if (jr_true(jv[4]))
         flags |= IOTDATA_IMAGE_FLAG_INVERT;
     /* Parse pixels (base64 → raw bytes) */
-    cJSON *jp = cJSON_GetObjectItem(j, "pixels");
-    return iotdata_encode_image(enc, fmt, sz, comp, flags, scratch->image.data, jp && jp->valuestring ? (uint8_t)_b64_decode(jp->valuestring, scratch->image.data, sizeof(scratch->image.data)) : 0);
+    return iotdata_encode_image(enc, fmt, sz, comp, flags, scratch->image.data, jr_string(jv[5], scratch->image.b64, sizeof(scratch->image.b64)) >= 0 ? (uint8_t)_b64_decode(scratch->image.b64, scratch->image.data, sizeof(scratch->image.data)) : 0);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -3529,7 +4235,7 @@ static const iotdata_field_ops_t _iotdata_field_def_image = {
     _IOTDATA_OP_UNPACK(unpack_image)
     _IOTDATA_OP_DUMP(dump_image)
     _IOTDATA_OP_PRINT(print_image)
-    _IOTDATA_OP_JSON_SET(json_set_image)
+    _IOTDATA_OP_JSON_WRITE(json_write_image)
     _IOTDATA_OP_JSON_GET(json_get_image)
 };
 #define _IOTDATA_ENT_IMAGE [IOTDATA_FIELD_IMAGE] = &_iotdata_field_def_image,
@@ -3560,8 +4266,7 @@ iotdata_status_t iotdata_encode_flags(iotdata_encoder_t *enc, uint8_t flags) {
     CHECK_CTX_ACTIVE(enc);
     CHECK_NOT_DUPLICATE(enc, IOTDATA_FIELD_FLAGS);
     enc->flags = flags;
-    IOTDATA_FIELD_SET(enc->fields, IOTDATA_FIELD_FLAGS);
-    return IOTDATA_OK;
+    return ENCODE_FIELD_DONE(enc, IOTDATA_FIELD_FLAGS);
 }
 #endif
 // quantise
@@ -3571,7 +4276,7 @@ static bool pack_flags(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encode
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_flags(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_flags(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     if (*bp + IOTDATA_FLAGS_BITS > bb)
         return false;
     dec->flags = (uint8_t)bits_read(buf, bb, bp, IOTDATA_FLAGS_BITS);
@@ -3579,18 +4284,15 @@ static bool unpack_flags(const uint8_t *buf, size_t bb, size_t *bp, iotdata_deco
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t json_get_flags(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
+static iotdata_status_t json_get_flags(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j)
-        return IOTDATA_OK;
-    return iotdata_encode_flags(enc, (uint8_t)j->valueint);
+    return iotdata_encode_flags(enc, (uint8_t)jr_int(j));
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void json_set_flags(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void json_write_flags(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     (void)scratch;
-    cJSON_AddNumberToObject(root, label, dec->flags);
+    jw_number(jw, label, dec->flags);
 }
 #endif
 #if !defined(IOTDATA_NO_DUMP)
@@ -3616,7 +4318,7 @@ static const iotdata_field_ops_t _iotdata_field_def_flags = {
     _IOTDATA_OP_UNPACK(unpack_flags)
     _IOTDATA_OP_DUMP(dump_flags)
     _IOTDATA_OP_PRINT(print_flags)
-    _IOTDATA_OP_JSON_SET(json_set_flags)
+    _IOTDATA_OP_JSON_WRITE(json_write_flags)
     _IOTDATA_OP_JSON_GET(json_get_flags)
 };
 #define _IOTDATA_ENT_FLAGS [IOTDATA_FIELD_FLAGS] = &_iotdata_field_def_flags,
@@ -3659,12 +4361,14 @@ iotdata_status_t iotdata_encode_tlv_string(iotdata_encoder_t *enc, uint8_t type,
         return IOTDATA_ERR_TLV_TYPE_HIGH;
     if (!str)
         return IOTDATA_ERR_TLV_STR_NULL;
-    const size_t slen = strlen(str);
+    size_t slen = 0;
+    uint8_t codes = 0;
+    for (; str[slen] && slen <= IOTDATA_TLV_STR_LEN_MAX; slen++)
+        codes |= char_to_sixbit(str[slen]);
     if (slen > IOTDATA_TLV_STR_LEN_MAX)
         return IOTDATA_ERR_TLV_STR_LEN_HIGH;
-    for (size_t i = 0; i < slen; i++)
-        if (char_to_sixbit(str[i]) < 0)
-            return IOTDATA_ERR_TLV_STR_CHAR_INVALID;
+    if (codes & _IOTDATA_SIXBIT_INVALID)
+        return IOTDATA_ERR_TLV_STR_CHAR_INVALID;
 #else
     size_t slen = strlen(str);
     if (slen > IOTDATA_TLV_STR_LEN_MAX)
@@ -3775,15 +4479,19 @@ static bool pack_tlv(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encoder_
             return false;
         if (!bits_write(buf, bb, bp, enc->tlv[i].length, IOTDATA_TLV_LENGTH_BITS))
             return false;
-        for (int j = 0, l = enc->tlv[i].format == IOTDATA_TLV_FMT_STRING ? IOTDATA_TLV_CHAR_BITS : 8; j < enc->tlv[i].length; j++)
-            if (!bits_write(buf, bb, bp, enc->tlv[i].format == IOTDATA_TLV_FMT_STRING ? (uint32_t)char_to_sixbit(enc->tlv[i].str[j]) : enc->tlv[i].data[j], (uint8_t)l))
+        if (enc->tlv[i].format == IOTDATA_TLV_FMT_STRING) {
+            if (!sixbit_write(buf, bb, bp, enc->tlv[i].str, enc->tlv[i].length))
                 return false;
+        } else
+            for (int j = 0; j < enc->tlv[i].length; j++)
+                if (!bits_write(buf, bb, bp, enc->tlv[i].data[j], 8))
+                    return false;
     }
     return true;
 }
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-static bool unpack_tlv(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *dec) {
+static bool unpack_tlv(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_view_t *dec) {
     bool more = true;
     while (more) {
         if (*bp + IOTDATA_TLV_HEADER_BITS > bb)
@@ -3795,25 +4503,28 @@ static bool unpack_tlv(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decode
         const uint8_t bpv = format == IOTDATA_TLV_FMT_STRING ? IOTDATA_TLV_CHAR_BITS : 8;
         if (*bp + (size_t)bpv * length > bb)
             return false;
-        if (dec->tlv_count >= IOTDATA_TLV_MAX) {
-            *bp += (size_t)bpv * length;
-        } else {
-            const int idx = dec->tlv_count++;
-            dec->tlv[idx].format = format;
-            dec->tlv[idx].type = type;
-            dec->tlv[idx].length = length;
-            if (format == IOTDATA_TLV_FMT_STRING) {
-                for (int j = 0; j < length; j++)
-                    dec->tlv[idx].str[j] = sixbit_to_char((uint8_t)bits_read(buf, bb, bp, IOTDATA_TLV_CHAR_BITS));
-                dec->tlv[idx].str[length] = '\0';
-            } else {
-                for (int j = 0; j < length; j++)
-                    dec->tlv[idx].raw[j] = (uint8_t)bits_read(buf, bb, bp, 8);
-            }
+        if (dec->tlv_count < IOTDATA_TLV_MAX) {
+            /* Data left in place: offsets stay below 16 bits as the fields and IOTDATA_TLV_MAX entries before it are bounded */
+            iotdata_decoded_tlv_view_t *t = &dec->tlv_view[dec->tlv_count++];
+            t->format = format;
+            t->type = type;
+            t->length = length;
+            t->offset = (uint16_t)*bp;
         }
+        *bp += (size_t)bpv * length;
     }
     return true;
 }
+static void _iotdata_tlv_copy_out(const uint8_t *buf, const iotdata_decoded_tlv_view_t *view, iotdata_decoded_tlv_t *tlv) {
+    tlv->format = view->format;
+    tlv->type = view->type;
+    tlv->length = view->length;
+    if (view->format == IOTDATA_TLV_FMT_STRING) {
+        sixbit_read(buf, view->offset, tlv->str, view->length);
+        tlv->str[view->length] = '\0';
+    } else
+        bits_read_bytes(buf, view->offset, tlv->raw, view->length);
+}
 #endif
 #if !defined(IOTDATA_NO_TLV_SPECIFIC)
 #if (!defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)) || (!defined(IOTDATA_NO_PRINT) && !defined(IOTDATA_NO_DECODE)) || (!defined(IOTDATA_NO_DUMP))
@@ -3822,17 +4533,17 @@ static const char *const _tlv_reason_names[] = { "unknown", "power_on", "softwar
 #endif
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_DECODE)
-static void _json_set_tlv_data(cJSON *obj, const iotdata_decoded_tlv_t *t, iotdata_decode_to_json_scratch_t *scratch) {
-    cJSON_AddStringToObject(obj, "format", t->format == IOTDATA_TLV_FMT_STRING ? "string" : "raw");
+static void _json_write_tlv_data(iotdata_json_t *jw, const iotdata_decoded_tlv_t *t, iotdata_decode_to_json_scratch_t *scratch) {
+    jw_string(jw, "format", t->format == IOTDATA_TLV_FMT_STRING ? "string" : "raw");
     if (t->format == IOTDATA_TLV_FMT_STRING)
-        cJSON_AddStringToObject(obj, "data", t->str);
+        jw_string(jw, "data", t->str);
     else
-        cJSON_AddStringToObject(obj, "data", _b64_encode(t->raw, t->length, scratch->tlv.b64));
+        jw_string(jw, "data", _b64_encode(t->raw, t->length, scratch->tlv.b64));
 }
 #if !defined(IOTDATA_NO_TLV_SPECIFIC)
-static void _json_set_tlv_kv(cJSON *obj, const char *str, iotdata_decode_to_json_scratch_t *scratch) {
+static void _json_write_tlv_kv(iotdata_json_t *jw, const char *str, iotdata_decode_to_json_scratch_t *scratch) {
     /* Parse space-delimited "KEY1 VALUE1 KEY2 VALUE2" into JSON object */
-    cJSON *data = cJSON_AddObjectToObject(obj, "data");
+    jw_object_begin(jw, "data");
     const char *p = str;
     while (*p) {
         /* extract key */
@@ -3858,154 +4569,162 @@ static void _json_set_tlv_kv(cJSON *obj, const char *str, iotdata_decode_to_json
             scratch->tlv.str[klen] = '\0';
             memcpy(&scratch->tlv.str[klen + 1], vs, vlen);
             scratch->tlv.str[klen + 1 + vlen] = '\0';
-            cJSON_AddStringToObject(data, &scratch->tlv.str[0], &scratch->tlv.str[klen + 1]);
+            jw_string(jw, &scratch->tlv.str[0], &scratch->tlv.str[klen + 1]);
         }
     }
+    jw_object_end(jw);
 }
-static void _json_set_tlv_global(cJSON *arr, const iotdata_decoded_tlv_t *t, iotdata_decode_to_json_scratch_t *scratch) {
-    cJSON *obj = cJSON_CreateObject();
-    cJSON_AddNumberToObject(obj, "type", t->type);
+static void _json_write_tlv_global(iotdata_json_t *jw, const iotdata_decoded_tlv_t *t, iotdata_decode_to_json_scratch_t *scratch) {
+    jw_object_begin(jw, NULL);
+    jw_number(jw, "type", t->type);
     switch (t->type) {
     case IOTDATA_TLV_VERSION:
-        cJSON_AddStringToObject(obj, "format", "version");
+        jw_string(jw, "format", "version");
         if (t->format == IOTDATA_TLV_FMT_STRING)
-            _json_set_tlv_kv(obj, t->str, scratch);
+            _json_write_tlv_kv(jw, t->str, scratch);
         else
-            cJSON_AddStringToObject(obj, "data", t->str);
+            jw_string(jw, "data", t->str);
         break;
     case IOTDATA_TLV_STATUS:
-        cJSON_AddStringToObject(obj, "format", "status");
+        jw_string(jw, "format", "status");
         if (t->format == IOTDATA_TLV_FMT_RAW && t->length == IOTDATA_TLV_STATUS_LENGTH) {
             const uint8_t *b = t->raw;
             const uint32_t sess = ((uint32_t)b[0] << 16) | ((uint32_t)b[1] << 8) | b[2];
             const uint32_t life = ((uint32_t)b[3] << 16) | ((uint32_t)b[4] << 8) | b[5];
             const uint16_t restarts = (uint16_t)((b[6] << 8) | b[7]);
             const uint8_t reason = b[8];
-            cJSON *data = cJSON_AddObjectToObject(obj, "data");
-            cJSON_AddNumberToObject(data, "session_uptime", (double)(sess * IOTDATA_TLV_STATUS_TICKS_RES));
+            jw_object_begin(jw, "data");
+            jw_number(jw, "session_uptime", sess * IOTDATA_TLV_STATUS_TICKS_RES);
             if (life > 0)
-                cJSON_AddNumberToObject(data, "lifetime_uptime", (double)(life * IOTDATA_TLV_STATUS_TICKS_RES));
-            cJSON_AddNumberToObject(data, "restarts", restarts);
+                jw_number(jw, "lifetime_uptime", life * IOTDATA_TLV_STATUS_TICKS_RES);
+            jw_number(jw, "restarts", restarts);
             if (reason < _TLV_REASON_COUNT)
-                cJSON_AddStringToObject(data, "reason", _tlv_reason_names[reason]);
+                jw_string(jw, "reason", _tlv_reason_names[reason]);
             else if (reason != IOTDATA_TLV_REASON_NA)
-                cJSON_AddNumberToObject(data, "reason", reason);
+                jw_number(jw, "reason", reason);
+            jw_object_end(jw);
         }
         break;
     case IOTDATA_TLV_HEALTH:
-        cJSON_AddStringToObject(obj, "format", "health");
+        jw_string(jw, "format", "health");
         if (t->format == IOTDATA_TLV_FMT_RAW && t->length == IOTDATA_TLV_HEALTH_LENGTH) {
             const uint8_t *b = t->raw;
             const int8_t cpu_temp = (int8_t)b[0];
             const uint16_t supply_mv = (uint16_t)((b[1] << 8) | b[2]);
             const uint16_t free_heap = (uint16_t)((b[3] << 8) | b[4]);
             const uint16_t active = (uint16_t)((b[5] << 8) | b[6]);
-            cJSON *data = cJSON_AddObjectToObject(obj, "data");
+            jw_object_begin(jw, "data");
             if (cpu_temp != IOTDATA_TLV_HEALTH_TEMP_NA)
-                cJSON_AddNumberToObject(data, "cpu_temp", cpu_temp);
-            cJSON_AddNumberToObject(data, "supply_mv", supply_mv);
-            cJSON_AddNumberToObject(data, "free_heap", free_heap);
-            cJSON_AddNumberToObject(data, "session_active", (double)(active * IOTDATA_TLV_HEALTH_TICKS_RES));
+                jw_number(jw, "cpu_temp", cpu_temp);
+            jw_number(jw, "supply_mv", supply_mv);
+            jw_number(jw, "free_heap", free_heap);
+            jw_number(jw, "session_active", active * IOTDATA_TLV_HEALTH_TICKS_RES);
+            jw_object_end(jw);
         }
         break;
     case IOTDATA_TLV_CONFIG:
-        cJSON_AddStringToObject(obj, "format", "config");
+        jw_string(jw, "format", "config");
         if (t->format == IOTDATA_TLV_FMT_STRING)
-            _json_set_tlv_kv(obj, t->str, scratch);
+            _json_write_tlv_kv(jw, t->str, scratch);
         else
-            cJSON_AddStringToObject(obj, "data", t->str);
+            jw_string(jw, "data", t->str);
         break;
     case IOTDATA_TLV_DIAGNOSTIC:
     case IOTDATA_TLV_USERDATA:
-        cJSON_AddStringToObject(obj, "format", "string");
+        jw_string(jw, "format", "string");
         if (t->length > 0) {
             const size_t len = t->length < IOTDATA_TLV_STR_LEN_MAX ? t->length : IOTDATA_TLV_STR_LEN_MAX;
             memcpy(scratch->tlv.str, t->format == IOTDATA_TLV_FMT_STRING ? t->str : (const char *)t->raw, len);
             scratch->tlv.str[len] = '\0';
-            cJSON_AddStringToObject(obj, "data", scratch->tlv.str);
+            jw_string(jw, "data", scratch->tlv.str);
         }
         break;
     default:
         /* Unknown global type — fall through to generic encoding */
-        _json_set_tlv_data(obj, t, scratch);
+        _json_write_tlv_data(jw, t, scratch);
         break;
     }
-    cJSON_AddItemToArray(arr, obj);
+    jw_object_end(jw);
 }
-static void _json_set_tlv_quality(cJSON *arr, const iotdata_decoded_tlv_t *t, iotdata_decode_to_json_scratch_t *scratch) {
+static void _json_write_tlv_quality(iotdata_json_t *jw, const iotdata_decoded_tlv_t *t, iotdata_decode_to_json_scratch_t *scratch) {
     /* Reserved for future quality/metadata TLVs (0x10-0x1F) — generic encoding */
-    cJSON *obj = cJSON_CreateObject();
-    cJSON_AddNumberToObject(obj, "type", t->type);
-    _json_set_tlv_data(obj, t, scratch);
-    cJSON_AddItemToArray(arr, obj);
+    jw_object_begin(jw, NULL);
+    jw_number(jw, "type", t->type);
+    _json_write_tlv_data(jw, t, scratch);
+    jw_object_end(jw);
 }
-static void _json_set_tlv_user(cJSON *arr, const iotdata_decoded_tlv_t *t, iotdata_decode_to_json_scratch_t *scratch) {
+static void _json_write_tlv_user(iotdata_json_t *jw, const iotdata_decoded_tlv_t *t, iotdata_decode_to_json_scratch_t *scratch) {
     /* Application-defined TLVs (0x20+) — generic encoding */
-    cJSON *obj = cJSON_CreateObject();
-    cJSON_AddNumberToObject(obj, "type", t->type);
-    _json_set_tlv_data(obj, t, scratch);
-    cJSON_AddItemToArray(arr, obj);
+    jw_object_begin(jw, NULL);
+    jw_number(jw, "type", t->type);
+    _json_write_tlv_data(jw, t, scratch);
+    jw_object_end(jw);
 }
 #endif
-static void json_set_tlv(cJSON *root, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
-    cJSON *arr = cJSON_AddArrayToObject(root, label);
+static void json_write_tlv(iotdata_json_t *jw, const iotdata_decoded_t *dec, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+    jw_array_begin(jw, label);
     for (int i = 0; i < dec->tlv_count; i++) {
 #if !defined(IOTDATA_NO_TLV_SPECIFIC)
         if (dec->tlv[i].type <= IOTDATA_TLV_TYPE_GLOBAL_MAX)
-            _json_set_tlv_global(arr, &dec->tlv[i], scratch);
+            _json_write_tlv_global(jw, &dec->tlv[i], scratch);
         else if (dec->tlv[i].type <= IOTDATA_TLV_TYPE_QUALITY_MAX)
-            _json_set_tlv_quality(arr, &dec->tlv[i], scratch);
+            _json_write_tlv_quality(jw, &dec->tlv[i], scratch);
         else
-            _json_set_tlv_user(arr, &dec->tlv[i], scratch);
+            _json_write_tlv_user(jw, &dec->tlv[i], scratch);
 #else
-        cJSON *obj = cJSON_CreateObject();
-        cJSON_AddNumberToObject(obj, "type", dec->tlv[i].type);
-        _json_set_tlv_data(obj, &dec->tlv[i], scratch);
-        cJSON_AddItemToArray(arr, obj);
+        jw_object_begin(jw, NULL);
+        jw_number(jw, "type", dec->tlv[i].type);
+        _json_write_tlv_data(jw, &dec->tlv[i], scratch);
+        jw_object_end(jw);
 #endif
     }
+    jw_array_end(jw);
 }
 #endif
 #if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
-static iotdata_status_t _json_get_tlv_generic(cJSON *item, iotdata_encoder_t *enc, int tidx, uint8_t type, iotdata_encode_from_json_scratch_tlv_t *scratch) {
-    cJSON *format = cJSON_GetObjectItem(item, "format");
-    cJSON *data = cJSON_GetObjectItem(item, "data");
-    if (!data || !cJSON_IsString(data))
+static iotdata_status_t _json_get_tlv_generic(const char *item, iotdata_encoder_t *enc, int tidx, uint8_t type, iotdata_encode_from_json_scratch_tlv_t *scratch) {
+    static const char *const names[] = { "format", "data" };
+    const char *jv[2];
+    char format[8];
+    jr_object(item, names, 2, jv);
+    if (!jv[1] || *jv[1] != '"')
         return IOTDATA_OK; /* skip malformed */
-    if (strcmp(format ? format->valuestring : "raw", "string") == 0) {
-        snprintf(scratch->str[tidx], IOTDATA_TLV_STR_LEN_MAX + 1, "%s", data->valuestring);
+    if (jr_string(jv[0], format, sizeof(format)) >= 0 && strcmp(format, "string") == 0) {
+        jr_string(jv[1], scratch->str[tidx], IOTDATA_TLV_STR_LEN_MAX + 1);
         return iotdata_encode_tlv_string(enc, type, scratch->str[tidx]);
-    } else
-        return iotdata_encode_tlv(enc, type, scratch->raw[tidx], (uint8_t)_b64_decode(data->valuestring, scratch->raw[tidx], IOTDATA_TLV_DATA_MAX));
+    } else {
+        jr_string(jv[1], scratch->b64, sizeof(scratch->b64));
+        return iotdata_encode_tlv(enc, type, scratch->raw[tidx], (uint8_t)_b64_decode(scratch->b64, scratch->raw[tidx], IOTDATA_TLV_DATA_MAX));
+    }
 }
 #if !defined(IOTDATA_NO_TLV_SPECIFIC)
-static iotdata_status_t _json_get_tlv_kv(cJSON *data_obj, iotdata_encoder_t *enc, uint8_t type, char *scratch, size_t scratch_size) {
+static iotdata_status_t _json_get_tlv_kv(const char *data_obj, iotdata_encoder_t *enc, uint8_t type, char *scratch, size_t scratch_size) {
     /* Reconstruct "KEY1 VALUE1 KEY2 VALUE2" from JSON object */
     size_t pos = 0;
-    cJSON *pair;
-    cJSON_ArrayForEach(pair, data_obj) {
-        if (!pair->string || !cJSON_IsString(pair))
+    jr_iter_t it;
+    const char *key, *value;
+    jr_iter(&it, data_obj, '{');
+    while ((value = jr_next(&it, &key)) != NULL) {
+        if (*value != '"')
             continue;
-        const size_t klen = strlen(pair->string), vlen = strlen(pair->valuestring);
+        const size_t klen = (size_t)jr_string(key, NULL, 0), vlen = (size_t)jr_string(value, NULL, 0);
         if (pos + ((pos > 0 ? 1 : 0) + klen + 1 + vlen) >= scratch_size)
             return IOTDATA_ERR_TLV_LEN_HIGH;
         if (pos > 0)
             scratch[pos++] = ' ';
-        memcpy(&scratch[pos], pair->string, klen);
-        pos += klen;
+        pos += (size_t)jr_string(key, &scratch[pos], scratch_size - pos);
         scratch[pos++] = ' ';
-        memcpy(&scratch[pos], pair->valuestring, vlen);
-        pos += vlen;
+        pos += (size_t)jr_string(value, &scratch[pos], scratch_size - pos);
     }
     scratch[pos] = '\0';
     return iotdata_encode_tlv_string(enc, type, scratch);
 }
-static iotdata_status_t _json_get_tlv_global(cJSON *item, iotdata_encoder_t *enc, int tidx, uint8_t type, iotdata_encode_from_json_scratch_tlv_t *scratch) {
-    cJSON *data = cJSON_GetObjectItem(item, "data");
+static iotdata_status_t _json_get_tlv_global(const char *item, iotdata_encoder_t *enc, int tidx, uint8_t type, iotdata_encode_from_json_scratch_tlv_t *scratch) {
+    const char *data = jr_member(item, "data");
     switch (type) {
     case IOTDATA_TLV_VERSION:
         /* Sensor-originated: JSON→encode for config/management round-trip */
-        if (data && cJSON_IsObject(data))
+        if (data && *data == '{')
             return _json_get_tlv_kv(data, enc, type, scratch->str[tidx], IOTDATA_TLV_STR_LEN_MAX + 1);
         break;
     case IOTDATA_TLV_STATUS:
@@ -4017,7 +4736,7 @@ static iotdata_status_t _json_get_tlv_global(cJSON *item, iotdata_encoder_t *enc
          * XXX: implement if gateway-to-device config responses require it */
         break;
     case IOTDATA_TLV_CONFIG:
-        if (data && cJSON_IsObject(data))
+        if (data && *data == '{')
             return _json_get_tlv_kv(data, enc, type, scratch->str[tidx], IOTDATA_TLV_STR_LEN_MAX + 1);
         break;
     case IOTDATA_TLV_DIAGNOSTIC:
@@ -4025,8 +4744,8 @@ static iotdata_status_t _json_get_tlv_global(cJSON *item, iotdata_encoder_t *enc
          * XXX: implement if gateway-to-device config responses require it */
         break;
     case IOTDATA_TLV_USERDATA:
-        if (data && cJSON_IsString(data)) {
-            snprintf(scratch->str[tidx], IOTDATA_TLV_STR_LEN_MAX + 1, "%s", data->valuestring);
+        if (data && *data == '"') {
+            jr_string(data, scratch->str[tidx], IOTDATA_TLV_STR_LEN_MAX + 1);
             return iotdata_encode_tlv_string(enc, type, scratch->str[tidx]);
         }
         break;
@@ -4036,7 +4755,7 @@ static iotdata_status_t _json_get_tlv_global(cJSON *item, iotdata_encoder_t *enc
     }
     return IOTDATA_OK;
 }
-static iotdata_status_t _json_get_tlv_quality(cJSON *item, iotdata_encoder_t *enc, int tidx, uint8_t type, iotdata_encode_from_json_scratch_tlv_t *scratch) {
+static iotdata_status_t _json_get_tlv_quality(const char *item, iotdata_encoder_t *enc, int tidx, uint8_t type, iotdata_encode_from_json_scratch_tlv_t *scratch) {
     /* Reserved for future quality/metadata TLVs (0x10-0x1F) — generic */
     (void)item;
     (void)enc;
@@ -4045,7 +4764,7 @@ static iotdata_status_t _json_get_tlv_quality(cJSON *item, iotdata_encoder_t *en
     (void)scratch;
     return IOTDATA_ERR_TLV_UNMATCHED; /* fall through to generic */
 }
-static iotdata_status_t _json_get_tlv_user(cJSON *item, iotdata_encoder_t *enc, int tidx, uint8_t type, iotdata_encode_from_json_scratch_tlv_t *scratch) {
+static iotdata_status_t _json_get_tlv_user(const char *item, iotdata_encoder_t *enc, int tidx, uint8_t type, iotdata_encode_from_json_scratch_tlv_t *scratch) {
     /* Application-defined TLVs (0x20+) — generic */
     (void)item;
     (void)enc;
@@ -4055,19 +4774,19 @@ static iotdata_status_t _json_get_tlv_user(cJSON *item, iotdata_encoder_t *enc,
     return IOTDATA_ERR_TLV_UNMATCHED; /* fall through to generic */
 }
 #endif
-static iotdata_status_t json_get_tlv(cJSON *root, iotdata_encoder_t *enc, const char *label, iotdata_encode_from_json_scratch_tlv_t *scratch) {
-    cJSON *j = cJSON_GetObjectItem(root, label);
-    if (!j || !cJSON_IsArray(j))
+static iotdata_status_t json_get_tlv(const char *j, iotdata_encoder_t *enc, iotdata_encode_from_json_scratch_tlv_t *scratch) {
+    jr_iter_t it;
+    if (!jr_iter(&it, j, '['))
         return IOTDATA_OK;
-    cJSON *item;
+    const char *item;
     int tidx = 0;
-    cJSON_ArrayForEach(item, j) {
+    while ((item = jr_next(&it, NULL)) != NULL) {
         if (tidx >= IOTDATA_TLV_MAX)
             break;
-        cJSON *j_type = cJSON_GetObjectItem(item, "type");
+        const char *j_type = jr_member(item, "type");
         if (!j_type)
             continue;
-        const uint8_t type = (uint8_t)j_type->valueint;
+        const uint8_t type = (uint8_t)jr_int(j_type);
         iotdata_status_t rc;
 #if !defined(IOTDATA_NO_TLV_SPECIFIC)
         if (type <= IOTDATA_TLV_TYPE_GLOBAL_MAX)
@@ -4108,11 +4827,11 @@ static int _dump_tlv_global(const uint8_t *buf, size_t bb, size_t *bp, iotdata_d
             const uint16_t restarts = (uint16_t)bits_read(buf, bb, &p, 16);
             const uint8_t reason = (uint8_t)bits_read(buf, bb, &p, 8);
             snprintf(dump->_name_buf, sizeof(dump->_name_buf), "tlv[%d].session_uptime", tlv_idx);
-            snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%" PRIu32 "s", (uint32_t)(sess * IOTDATA_TLV_STATUS_TICKS_RES));
+            snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%" PRIu32 "s", (uint32_t)sess * IOTDATA_TLV_STATUS_TICKS_RES);
             n = dump_add(dump, n, *bp, 24, sess, dump->_dec_buf, "ticks×5", dump->_name_buf);
             *bp += 24;
             snprintf(dump->_name_buf, sizeof(dump->_name_buf), "tlv[%d].lifetime_uptime", tlv_idx);
-            snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%" PRIu32 "s", (uint32_t)(life * IOTDATA_TLV_STATUS_TICKS_RES));
+            snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%" PRIu32 "s", (uint32_t)life * IOTDATA_TLV_STATUS_TICKS_RES);
             n = dump_add(dump, n, *bp, 24, life, dump->_dec_buf, "ticks×5", dump->_name_buf);
             *bp += 24;
             snprintf(dump->_name_buf, sizeof(dump->_name_buf), "tlv[%d].restarts", tlv_idx);
@@ -4146,7 +4865,7 @@ static int _dump_tlv_global(const uint8_t *buf, size_t bb, size_t *bp, iotdata_d
             n = dump_add(dump, n, *bp, 16, free_heap, dump->_dec_buf, "0..65535", dump->_name_buf);
             *bp += 16;
             snprintf(dump->_name_buf, sizeof(dump->_name_buf), "tlv[%d].session_active", tlv_idx);
-            snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%" PRIu32 "s", (uint32_t)(active * IOTDATA_TLV_HEALTH_TICKS_RES));
+            snprintf(dump->_dec_buf, sizeof(dump->_dec_buf), "%" PRIu32 "s", (uint32_t)active * IOTDATA_TLV_HEALTH_TICKS_RES);
             n = dump_add(dump, n, *bp, 16, active, dump->_dec_buf, "ticks×5", dump->_name_buf);
             *bp += 16;
             return n;
@@ -4242,7 +4961,7 @@ static void _print_tlv_global(const iotdata_decoded_tlv_t *t, iotdata_buf_t *bp,
             const uint32_t life = ((uint32_t)b[3] << 16) | ((uint32_t)b[4] << 8) | b[5];
             const uint16_t restarts = (uint16_t)((b[6] << 8) | b[7]);
             const uint8_t reason = b[8];
-            bprintf(bp, "    [%d] status: session=%" PRIu32 "s lifetime=%" PRIu32 "s restarts=%" PRIu16 " reason=%s", i, (uint32_t)(sess * IOTDATA_TLV_STATUS_TICKS_RES), (uint32_t)(life * IOTDATA_TLV_STATUS_TICKS_RES), restarts,
+            bprintf(bp, "    [%d] status: session=%" PRIu32 "s lifetime=%" PRIu32 "s restarts=%" PRIu16 " reason=%s", i, (uint32_t)sess * IOTDATA_TLV_STATUS_TICKS_RES, (uint32_t)life * IOTDATA_TLV_STATUS_TICKS_RES, restarts,
                     reason < _TLV_REASON_COUNT ? _tlv_reason_names[reason] : "?");
             if (reason >= 0x80)
                 bprintf(bp, "(0x%02" PRIX8 ")", reason);
@@ -4261,7 +4980,7 @@ static void _print_tlv_global(const iotdata_decoded_tlv_t *t, iotdata_buf_t *bp,
             bprintf(bp, "    [%d] health:", i);
             if (cpu_temp != IOTDATA_TLV_HEALTH_TEMP_NA)
                 bprintf(bp, " cpu=%" PRId8 "°C", cpu_temp);
-            bprintf(bp, " supply=%" PRIu16 "mV heap=%" PRIu16 " active=%" PRIu32 "s\n", supply_mv, free_heap, (uint32_t)(active * IOTDATA_TLV_HEALTH_TICKS_RES));
+            bprintf(bp, " supply=%" PRIu16 "mV heap=%" PRIu16 " active=%" PRIu32 "s\n", supply_mv, free_heap, (uint32_t)active * IOTDATA_TLV_HEALTH_TICKS_RES);
         } else {
             bprintf(bp, "    [%d] health: malformed(%" PRIu8 " bytes)\n", i, t->length);
         }
@@ -4359,7 +5078,7 @@ static void print_tlv(const iotdata_decoded_t *dec, iotdata_buf_t *bp, const cha
 
 // clang-format off
 
-static const iotdata_field_ops_t *_iotdata_field_ops[IOTDATA_FIELD_COUNT] = {
+static const iotdata_field_ops_t *const _iotdata_field_ops[IOTDATA_FIELD_COUNT] = {
     _IOTDATA_ENT_BATTERY
     _IOTDATA_ENT_LINK
     _IOTDATA_ENT_ENVIRONMENT
@@ -4424,17 +5143,272 @@ static int _iotdata_field_pres_bit(int field_idx) {
         return "Station ID above maximum (4095)";
 
 /* =========================================================================
- * External ENCODER
+ * Internal variant plans
  * ========================================================================= */
 
+/* Used by the decoder, the store-then-pack encoder and JSON encoding (label lookup); the streaming encoder walks the variant map */
+#if !defined(IOTDATA_NO_DECODE) || (!defined(IOTDATA_NO_ENCODE) && (!defined(IOTDATA_ENCODE_STREAMING) || !defined(IOTDATA_NO_JSON)))
+#define _IOTDATA_PLANS
+#endif
+
+#if defined(_IOTDATA_PLANS)
+
+/*
+ * A plan is the variant's slot table compiled once into a flat list of
+ * steps in wire order: presence byte, presence bit mask and the resolved
+ * per-field functions, with NONE/TLV slots stripped.  Plans are built on
+ * first use of a variant and cached in a table indexed by variant, one
+ * entry per variant when the map size is known at compile time.  With a
+ * user-supplied iotdata_get_variant() the table defaults to one entry, and
+ * an encoder-only build (IOTDATA_NO_DECODE) has none, as a constrained
+ * encoder packs too rarely to repay the RAM; IOTDATA_VARIANT_PLANS
+ * overrides the number of entries, and 0 removes the table.
+ *
+ * An entry is claimed once, compiled and then published as ready, and is
+ * never written again, so concurrent encoders and decoders can share the
+ * table.  A variant without a plan (its entry holds another variant or is
+ * still being compiled by another thread, or there is no table) is encoded
+ * and decoded by walking its slot table directly, as before plans.
+ */
+
+#if defined(IOTDATA_VARIANT_PLANS)
+#define _IOTDATA_PLAN_COUNT IOTDATA_VARIANT_PLANS
+#elif defined(IOTDATA_NO_DECODE)
+#define _IOTDATA_PLAN_COUNT 0
+#elif defined(IOTDATA_VARIANT_MAPS_COUNT)
+#define _IOTDATA_PLAN_COUNT IOTDATA_VARIANT_MAPS_COUNT
+#elif defined(IOTDATA_VARIANT_MAPS_DEFAULT_COUNT)
+#define _IOTDATA_PLAN_COUNT IOTDATA_VARIANT_MAPS_DEFAULT_COUNT
+#else
+#define _IOTDATA_PLAN_COUNT 1
+#endif
+
+typedef struct {
+    uint8_t pres;
+    uint8_t mask;
+    int8_t type;
 #if !defined(IOTDATA_NO_ENCODE)
+    iotdata_pack_fn pack;
+#endif
+#if !defined(IOTDATA_NO_DECODE)
+    iotdata_unpack_fn unpack;
+#endif
+} _iotdata_plan_step_t;
 
-static bool _iotdata_encode_pack_field(uint8_t *buf, size_t bb, size_t *bp, const iotdata_encoder_t *enc, iotdata_field_type_t type) {
-    const iotdata_field_ops_t *ops = (type >= 0 && type < IOTDATA_FIELD_COUNT) ? _iotdata_field_ops[type] : NULL;
-    if (ops && ops->pack)
-        return ops->pack(buf, bb, bp, enc);
+/*
+ * Slot masks hold one bit per slot in wire order, slot 0 in the most
+ * significant bit, so that the presence bytes collapse into a mask with
+ * shifts alone and present slots are visited in order by count-leading-zeros.
+ */
+_Static_assert(IOTDATA_MAX_DATA_FIELDS <= 32, "slot mask overflow");
+#define _IOTDATA_SLOT_BIT(si) (0x80000000U >> (si))
+
+/* Open-addressed index of the variant's labels for JSON key dispatch: a power of two, at most half full */
+#define _IOTDATA_PLAN_JSON_LABELS 64
+_Static_assert(_IOTDATA_PLAN_JSON_LABELS >= 2 * IOTDATA_MAX_DATA_FIELDS, "label index too small");
+
+typedef struct {
+    const iotdata_variant_def_t *vdef;
+    uint8_t state;
+    uint8_t variant;
+    uint8_t steps_variant; /* steps within vdef->num_pres_bytes (encoder) */
+    uint8_t steps_count;   /* steps across all IOTDATA_PRES_MAXIMUM bytes */
+    _iotdata_plan_step_t steps[IOTDATA_MAX_DATA_FIELDS];
+#if !defined(IOTDATA_NO_DECODE)
+    uint32_t slots;                           /* slot mask of steps */
+    uint8_t slot_step[IOTDATA_MAX_DATA_FIELDS]; /* slot to step index */
+#endif
+#if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
+    uint8_t json_labels[_IOTDATA_PLAN_JSON_LABELS]; /* label hash to slot + 1, 0 if empty */
+#endif
+} _iotdata_plan_t;
+
+#if _IOTDATA_PLAN_COUNT > 0
+static _iotdata_plan_t _iotdata_plans[_IOTDATA_PLAN_COUNT];
+#endif
+
+#if !defined(IOTDATA_NO_DECODE)
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SIZEOF_INT__) && __SIZEOF_INT__ >= 4
+#define _iotdata_slot_first(m) __builtin_clz(m)
+#else
+static int _iotdata_slot_first(uint32_t m) {
+    int n = 0;
+    if (!(m & 0xFFFF0000U)) {
+        n += 16;
+        m <<= 16;
+    }
+    if (!(m & 0xFF000000U)) {
+        n += 8;
+        m <<= 8;
+    }
+    if (!(m & 0xF0000000U)) {
+        n += 4;
+        m <<= 4;
+    }
+    if (!(m & 0xC0000000U)) {
+        n += 2;
+        m <<= 2;
+    }
+    if (!(m & 0x80000000U))
+        n += 1;
+    return n;
+}
+#endif
+
+static uint32_t _iotdata_pres_slots(const uint8_t *pres, int num_pres) {
+    uint32_t slots = (uint32_t)(pres[0] & 0x3F) << (32 - IOTDATA_PRES0_DATA_FIELDS);
+    for (int i = 1; i < num_pres; i++)
+        slots |= (uint32_t)(pres[i] & 0x7F) << (32 - IOTDATA_PRES0_DATA_FIELDS - IOTDATA_PRESN_DATA_FIELDS * i);
+    return slots;
+}
+#endif
+
+#if _IOTDATA_PLAN_COUNT > 0
+
+#define _IOTDATA_PLAN_EMPTY    0
+#define _IOTDATA_PLAN_BUILDING 1
+#define _IOTDATA_PLAN_READY    2
+
+#if defined(__GNUC__) || defined(__clang__)
+#define _IOTDATA_PLAN_STATE_GET(p)    __atomic_load_n(&(p)->state, __ATOMIC_ACQUIRE)
+#define _IOTDATA_PLAN_STATE_SET(p, v) __atomic_store_n(&(p)->state, (uint8_t)(v), __ATOMIC_RELEASE)
+static inline bool _iotdata_plan_claim(_iotdata_plan_t *plan) {
+    uint8_t expected = _IOTDATA_PLAN_EMPTY;
+    return __atomic_compare_exchange_n(&plan->state, &expected, (uint8_t)_IOTDATA_PLAN_BUILDING, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+#else
+#define _IOTDATA_PLAN_STATE_GET(p)    ((p)->state)
+#define _IOTDATA_PLAN_STATE_SET(p, v) ((p)->state = (uint8_t)(v))
+static inline bool _iotdata_plan_claim(_iotdata_plan_t *plan) {
+    if (plan->state != _IOTDATA_PLAN_EMPTY)
+        return false;
+    plan->state = _IOTDATA_PLAN_BUILDING;
     return true;
 }
+#endif
+
+#if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
+static uint32_t jr_key_hash(const char *s) {
+    uint32_t h = 2166136261U;
+    for (; *s; s++)
+        h = (h ^ (uint8_t)jr_lower(*s)) * 16777619U;
+    return h;
+}
+#endif
+
+static void _iotdata_plan_compile(_iotdata_plan_t *plan, uint8_t variant, const iotdata_variant_def_t *vdef) {
+    const int variant_fields = _iotdata_field_count(vdef->num_pres_bytes);
+    uint8_t n = 0, n_variant = 0;
+#if !defined(IOTDATA_NO_DECODE)
+    plan->slots = 0;
+#endif
+    for (int si = 0; si < IOTDATA_MAX_DATA_FIELDS; si++) {
+        const iotdata_field_type_t type = vdef->fields[si].type;
+        if (!IOTDATA_FIELD_VALID(type))
+            continue;
+        const iotdata_field_ops_t *ops = (type >= 0 && type < IOTDATA_FIELD_COUNT) ? _iotdata_field_ops[type] : NULL;
+#if !defined(IOTDATA_NO_DECODE)
+        plan->slots |= _IOTDATA_SLOT_BIT(si);
+        plan->slot_step[si] = n;
+#endif
+        _iotdata_plan_step_t *step = &plan->steps[n++];
+        step->pres = (uint8_t)_iotdata_field_pres_byte(si);
+        step->mask = (uint8_t)(1U << _iotdata_field_pres_bit(si));
+        step->type = (int8_t)type;
+#if !defined(IOTDATA_NO_ENCODE)
+        step->pack = ops ? ops->pack : NULL;
+#endif
+#if !defined(IOTDATA_NO_DECODE)
+        step->unpack = ops ? ops->unpack : NULL;
+#endif
+        if (si < variant_fields)
+            n_variant = n;
+    }
+#if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
+    memset(plan->json_labels, 0, sizeof(plan->json_labels));
+    for (int si = 0; si < variant_fields; si++)
+        if (IOTDATA_FIELD_VALID(vdef->fields[si].type) && vdef->fields[si].label != NULL) {
+            uint32_t h = jr_key_hash(vdef->fields[si].label);
+            while (plan->json_labels[h & (_IOTDATA_PLAN_JSON_LABELS - 1)])
+                h++;
+            plan->json_labels[h & (_IOTDATA_PLAN_JSON_LABELS - 1)] = (uint8_t)(si + 1);
+        }
+#endif
+    plan->vdef = vdef;
+    plan->variant = variant;
+    plan->steps_variant = n_variant;
+    plan->steps_count = n;
+}
+
+#if !defined(IOTDATA_NO_JSON) && !defined(IOTDATA_NO_ENCODE)
+static int _iotdata_plan_json_slot(const _iotdata_plan_t *plan, const char *key) {
+    for (uint32_t h = jr_key_hash(key);; h++) {
+        const uint8_t e = plan->json_labels[h & (_IOTDATA_PLAN_JSON_LABELS - 1)];
+        if (!e)
+            return -1;
+        if (jr_key_eq(key, plan->vdef->fields[e - 1].label))
+            return e - 1;
+    }
+}
+#endif
+
+#endif /* _IOTDATA_PLAN_COUNT > 0 */
+
+/* Returns the variant's cached plan, compiling it on first use, or NULL if the variant has none: callers then use iotdata_get_variant() */
+static const _iotdata_plan_t *_iotdata_plan_get(uint8_t variant) {
+#if _IOTDATA_PLAN_COUNT > 0
+    _iotdata_plan_t *plan = &_iotdata_plans[variant % _IOTDATA_PLAN_COUNT];
+    const uint8_t state = _IOTDATA_PLAN_STATE_GET(plan);
+    if (state == _IOTDATA_PLAN_READY)
+        return plan->variant == variant ? plan : NULL;
+    if (state != _IOTDATA_PLAN_EMPTY)
+        return NULL;
+    const iotdata_variant_def_t *vdef = iotdata_get_variant(variant);
+    if (vdef == NULL || !_iotdata_plan_claim(plan))
+        return NULL;
+    _iotdata_plan_compile(plan, variant, vdef);
+    _IOTDATA_PLAN_STATE_SET(plan, _IOTDATA_PLAN_READY);
+    return plan;
+#else
+    (void)variant;
+    return NULL;
+#endif
+}
+
+#endif
+
+/* =========================================================================
+ * External ENCODER
+ * ========================================================================= */
+
+#if !defined(IOTDATA_NO_ENCODE)
+
+#if defined(IOTDATA_ENCODE_STREAMING)
+/*
+ * Pack-as-you-go (README E.4, approach A): begin writes the header and
+ * reserves the variant's presence bytes, each encode_* packs its field at
+ * the cursor and sets its presence bit, and end trims unused trailing
+ * presence bytes and appends any TLVs. Fields must be added in slot order.
+ */
+static iotdata_status_t _iotdata_encode_stream(iotdata_encoder_t *enc, iotdata_field_type_t type) {
+    const int variant_fields = _iotdata_field_count(enc->vdef->num_pres_bytes);
+    for (int si = enc->slot_next; si < variant_fields; si++)
+        if (enc->vdef->fields[si].type == type) {
+            const iotdata_field_ops_t *ops = (type >= 0 && type < IOTDATA_FIELD_COUNT) ? _iotdata_field_ops[type] : NULL;
+            if (ops && ops->pack && !ops->pack(enc->buf, enc->buf_size * 8, &enc->packed_bits, enc))
+                return IOTDATA_ERR_BUF_TOO_SMALL;
+            enc->buf[IOTDATA_HEADER_BITS / 8 + _iotdata_field_pres_byte(si)] |= (uint8_t)(1U << _iotdata_field_pres_bit(si));
+            enc->slot_next = (uint8_t)(si + 1);
+            IOTDATA_FIELD_SET(enc->fields, type);
+            return IOTDATA_OK;
+        }
+    for (int si = 0; si < enc->slot_next; si++)
+        if (enc->vdef->fields[si].type == type)
+            return IOTDATA_ERR_CTX_FIELD_ORDER;
+    IOTDATA_FIELD_SET(enc->fields, type); /* a field not in the variant is accepted and ignored, as in store-then-pack */
+    return IOTDATA_OK;
+}
+#endif
 
 iotdata_status_t iotdata_encode_begin(iotdata_encoder_t *enc, uint8_t *buf, size_t buf_size, uint8_t variant, uint16_t station, uint16_t sequence) {
 #if !defined(IOTDATA_NO_CHECKS_STATE)
@@ -4455,6 +5429,19 @@ iotdata_status_t iotdata_encode_begin(iotdata_encoder_t *enc, uint8_t *buf, size
         return IOTDATA_ERR_HDR_STATION_HIGH;
 #endif
 
+#if defined(IOTDATA_ENCODE_STREAMING)
+    const iotdata_variant_def_t *vdef = iotdata_get_variant(variant);
+    if (vdef == NULL)
+        return IOTDATA_ERR_HDR_VARIANT_UNKNOWN;
+    const int num_pres = vdef->num_pres_bytes > 0 ? vdef->num_pres_bytes : 1;
+    size_t bb = buf_size * 8, bp = 0;
+    if (!bits_write(buf, bb, &bp, variant, IOTDATA_VARIANT_BITS) || !bits_write(buf, bb, &bp, station, IOTDATA_STATION_BITS) || !bits_write(buf, bb, &bp, sequence, IOTDATA_SEQUENCE_BITS))
+        return IOTDATA_ERR_BUF_TOO_SMALL;
+    if (buf_size < IOTDATA_HEADER_BITS / 8 + (size_t)num_pres)
+        return IOTDATA_ERR_BUF_TOO_SMALL;
+    memset(buf + IOTDATA_HEADER_BITS / 8, 0, (size_t)num_pres);
+#endif
+
     enc->buf = buf;
     enc->buf_size = buf_size;
     enc->variant = variant;
@@ -4464,6 +5451,11 @@ iotdata_status_t iotdata_encode_begin(iotdata_encoder_t *enc, uint8_t *buf, size
     enc->fields = IOTDATA_FIELD_EMPTY;
 #if defined(IOTDATA_ENABLE_TLV)
     enc->tlv_count = 0;
+#endif
+#if defined(IOTDATA_ENCODE_STREAMING)
+    enc->packed_bits = bp + (size_t)num_pres * 8;
+    enc->vdef = vdef;
+    enc->slot_next = 0;
 #endif
     return IOTDATA_OK;
 }
@@ -4471,10 +5463,32 @@ iotdata_status_t iotdata_encode_begin(iotdata_encoder_t *enc, uint8_t *buf, size
 iotdata_status_t iotdata_encode_end(iotdata_encoder_t *enc, size_t *out_bytes) {
     CHECK_CTX_ACTIVE(enc);
 
-    const iotdata_variant_def_t *vdef = iotdata_get_variant(enc->variant);
+    size_t bb = enc->buf_size * 8, bp = 0;
+
+#if defined(IOTDATA_ENCODE_STREAMING)
+    /* Presence: chain the bytes in use, then close the gap left by any reserved but unused */
+    uint8_t *pres = enc->buf + IOTDATA_HEADER_BITS / 8;
+    const int num_pres = enc->vdef->num_pres_bytes > 0 ? enc->vdef->num_pres_bytes : 1;
+    int max_pres_needed = num_pres;
+#if defined(IOTDATA_ENABLE_TLV)
+    if (IOTDATA_FIELD_PRESENT(enc->fields, IOTDATA_FIELD_TLV))
+        pres[0] |= IOTDATA_PRES_TLV;
+#endif
+    while (max_pres_needed > 1 && pres[max_pres_needed - 1] == 0)
+        max_pres_needed--;
+    for (int i = 0; i < max_pres_needed - 1; i++)
+        pres[i] |= IOTDATA_PRES_EXT;
+    (void)bb;
+    bp = enc->packed_bits;
+    if (max_pres_needed < num_pres) {
+        memmove(pres + max_pres_needed, pres + num_pres, bits_to_bytes(bp) - (IOTDATA_HEADER_BITS / 8 + (size_t)num_pres));
+        bp -= (size_t)(num_pres - max_pres_needed) * 8;
+    }
+#else
+    const _iotdata_plan_t *plan = _iotdata_plan_get(enc->variant);
+    const iotdata_variant_def_t *vdef = plan != NULL ? plan->vdef : iotdata_get_variant(enc->variant);
     if (vdef == NULL)
         return IOTDATA_ERR_HDR_VARIANT_UNKNOWN;
-    size_t bb = enc->buf_size * 8, bp = 0;
 
     /* Header */
     if (!bits_write(enc->buf, bb, &bp, enc->variant, IOTDATA_VARIANT_BITS) || !bits_write(enc->buf, bb, &bp, enc->station, IOTDATA_STATION_BITS) || !bits_write(enc->buf, bb, &bp, enc->sequence, IOTDATA_SEQUENCE_BITS))
@@ -4483,13 +5497,21 @@ iotdata_status_t iotdata_encode_end(iotdata_encoder_t *enc, size_t *out_bytes) {
     /* Presence */
     uint8_t pres[IOTDATA_PRES_MAXIMUM] = { 0 };
     int max_pres_needed = 1; /* always have pres0 */
-    for (int si = 0; si < _iotdata_field_count(vdef->num_pres_bytes); si++)
-        if (IOTDATA_FIELD_VALID(vdef->fields[si].type) && IOTDATA_FIELD_PRESENT(enc->fields, vdef->fields[si].type)) {
-            const int pb = _iotdata_field_pres_byte(si);
-            pres[pb] |= (1U << _iotdata_field_pres_bit(si));
-            if (pb + 1 > max_pres_needed)
-                max_pres_needed = pb + 1;
-        }
+    if (plan != NULL) {
+        for (int i = 0; i < plan->steps_variant; i++)
+            if (IOTDATA_FIELD_PRESENT(enc->fields, plan->steps[i].type)) {
+                pres[plan->steps[i].pres] |= plan->steps[i].mask;
+                if (plan->steps[i].pres + 1 > max_pres_needed)
+                    max_pres_needed = plan->steps[i].pres + 1;
+            }
+    } else
+        for (int si = 0; si < _iotdata_field_count(vdef->num_pres_bytes); si++)
+            if (IOTDATA_FIELD_VALID(vdef->fields[si].type) && IOTDATA_FIELD_PRESENT(enc->fields, vdef->fields[si].type)) {
+                const int pb = _iotdata_field_pres_byte(si);
+                pres[pb] |= (uint8_t)(1U << _iotdata_field_pres_bit(si));
+                if (pb + 1 > max_pres_needed)
+                    max_pres_needed = pb + 1;
+            }
 #if defined(IOTDATA_ENABLE_TLV)
     if (IOTDATA_FIELD_PRESENT(enc->fields, IOTDATA_FIELD_TLV))
         pres[0] |= IOTDATA_PRES_TLV;
@@ -4499,13 +5521,20 @@ iotdata_status_t iotdata_encode_end(iotdata_encoder_t *enc, size_t *out_bytes) {
             return IOTDATA_ERR_BUF_TOO_SMALL;
 
     /* Fields */
-    for (int si = 0; si < _iotdata_field_count(vdef->num_pres_bytes); si++)
-        if (IOTDATA_FIELD_VALID(vdef->fields[si].type)) {
-            const int pb = _iotdata_field_pres_byte(si);
-            if (pb < max_pres_needed && pres[pb] & (1U << _iotdata_field_pres_bit(si)))
-                if (!_iotdata_encode_pack_field(enc->buf, bb, &bp, enc, vdef->fields[si].type))
+    if (plan != NULL) {
+        for (int i = 0; i < plan->steps_variant; i++)
+            if ((pres[plan->steps[i].pres] & plan->steps[i].mask) && plan->steps[i].pack)
+                if (!plan->steps[i].pack(enc->buf, bb, &bp, enc))
+                    return IOTDATA_ERR_BUF_TOO_SMALL;
+    } else
+        for (int si = 0; si < _iotdata_field_count(vdef->num_pres_bytes); si++) {
+            const iotdata_field_type_t type = vdef->fields[si].type;
+            const iotdata_field_ops_t *ops = (type >= 0 && type < IOTDATA_FIELD_COUNT) ? _iotdata_field_ops[type] : NULL;
+            if (IOTDATA_FIELD_VALID(type) && (pres[_iotdata_field_pres_byte(si)] & (1U << _iotdata_field_pres_bit(si))) && ops && ops->pack)
+                if (!ops->pack(enc->buf, bb, &bp, enc))
                     return IOTDATA_ERR_BUF_TOO_SMALL;
         }
+#endif
 
     /* TLV */
 #if defined(IOTDATA_ENABLE_TLV)
@@ -4514,6 +5543,8 @@ iotdata_status_t iotdata_encode_end(iotdata_encoder_t *enc, size_t *out_bytes) {
             return IOTDATA_ERR_BUF_TOO_SMALL;
 #endif
 
+    if (bp & 7) /* a reused buffer, or the moved tail when streaming, may leave stale bits after the end */
+        enc->buf[bp >> 3] &= (uint8_t)(0xFF00U >> (bp & 7));
     enc->packed_bits = bp;
     enc->packed_bytes = bits_to_bytes(bp);
     enc->state = IOTDATA_STATE_ENDED;
@@ -4525,6 +5556,13 @@ iotdata_status_t iotdata_encode_end(iotdata_encoder_t *enc, size_t *out_bytes) {
 #endif /* !IOTDATA_NO_ENCODE */
 
 #if !defined(IOTDATA_NO_ENCODE)
+#if defined(IOTDATA_ENCODE_STREAMING)
+#define _IOTDATA_ERR_ENCODE_STREAMING \
+    case IOTDATA_ERR_CTX_FIELD_ORDER: \
+        return "Encoding field added out of slot order (streaming)";
+#else
+#define _IOTDATA_ERR_ENCODE_STREAMING
+#endif
 #define _IOTDATA_ERR_ENCODE \
     case IOTDATA_ERR_CTX_NULL: \
         return "Encoding context pointer is NULL"; \
@@ -4536,6 +5574,7 @@ iotdata_status_t iotdata_encode_end(iotdata_encoder_t *enc, size_t *out_bytes) {
         return "Encoding already ended"; \
     case IOTDATA_ERR_CTX_DUPLICATE_FIELD: \
         return "Encoding field already added"; \
+    _IOTDATA_ERR_ENCODE_STREAMING \
     case IOTDATA_ERR_BUF_NULL: \
         return "Buffer pointer is NULL"; \
     case IOTDATA_ERR_BUF_OVERFLOW: \
@@ -4558,13 +5597,6 @@ iotdata_status_t iotdata_encode_end(iotdata_encoder_t *enc, size_t *out_bytes) {
 
 #if !defined(IOTDATA_NO_DECODE)
 
-static bool _iotdata_decode_unpack_field(const uint8_t *buf, size_t bb, size_t *bp, iotdata_decoded_t *out, iotdata_field_type_t type) {
-    const iotdata_field_ops_t *ops = (type >= 0 && type < IOTDATA_FIELD_COUNT) ? _iotdata_field_ops[type] : NULL;
-    if (ops && ops->unpack)
-        return ops->unpack(buf, bb, bp, out);
-    return true;
-}
-
 iotdata_status_t iotdata_peek(const uint8_t *buf, size_t len, uint8_t *variant, uint16_t *station, uint16_t *sequence) {
 #if !defined(IOTDATA_NO_CHECKS_STATE)
     if (!buf)
@@ -4592,51 +5624,52 @@ iotdata_status_t iotdata_peek(const uint8_t *buf, size_t len, uint8_t *variant,
     return IOTDATA_OK;
 }
 
-iotdata_status_t iotdata_decode(const uint8_t *buf, size_t len, iotdata_decoded_t *dec) {
+/* Header and presence bytes, leaving bp at the first field: returns the slots present in wire order */
+static inline iotdata_status_t _iotdata_decode_begin(const uint8_t *buf, size_t len, iotdata_decoded_view_t *dec, size_t *bp, uint8_t *pres0, uint32_t *present) {
 #if !defined(IOTDATA_NO_CHECKS_STATE)
-    if (!buf || !dec)
+    if (!buf)
         return IOTDATA_ERR_CTX_NULL;
 #endif
 
     if (len < IOTDATA_HEADER_BITS / 8 + 1)
         return IOTDATA_ERR_DECODE_SHORT;
 
-    size_t bb = len * 8, bp = 0;
+    const size_t bb = len * 8;
+    *bp = 0;
 
     /* Header */
-    dec->variant = (uint8_t)bits_read(buf, bb, &bp, IOTDATA_VARIANT_BITS);
-    dec->station = (uint16_t)bits_read(buf, bb, &bp, IOTDATA_STATION_BITS);
-    dec->sequence = (uint16_t)bits_read(buf, bb, &bp, IOTDATA_SEQUENCE_BITS);
+    dec->variant = (uint8_t)bits_read(buf, bb, bp, IOTDATA_VARIANT_BITS);
+    dec->station = (uint16_t)bits_read(buf, bb, bp, IOTDATA_STATION_BITS);
+    dec->sequence = (uint16_t)bits_read(buf, bb, bp, IOTDATA_SEQUENCE_BITS);
     if (dec->variant == IOTDATA_VARIANT_RESERVED)
         return IOTDATA_ERR_DECODE_VARIANT;
 
     /* Presence */
     uint8_t pres[IOTDATA_PRES_MAXIMUM] = { 0 };
-    pres[0] = (uint8_t)bits_read(buf, bb, &bp, 8);
+    pres[0] = (uint8_t)bits_read(buf, bb, bp, 8);
     int num_pres = 1;
-    while (num_pres < IOTDATA_PRES_MAXIMUM && bp + 8 <= bb && (pres[num_pres - 1] & IOTDATA_PRES_EXT) != 0)
-        pres[num_pres++] = (uint8_t)bits_read(buf, bb, &bp, 8);
+    while (num_pres < IOTDATA_PRES_MAXIMUM && *bp + 8 <= bb && (pres[num_pres - 1] & IOTDATA_PRES_EXT) != 0)
+        pres[num_pres++] = (uint8_t)bits_read(buf, bb, bp, 8);
 
-    /* Fields */
     dec->fields = IOTDATA_FIELD_EMPTY;
-    const iotdata_variant_def_t *vdef = iotdata_get_variant(dec->variant);
-    if (vdef == NULL)
-        return IOTDATA_ERR_HDR_VARIANT_UNKNOWN;
-    for (int si = 0; si < _iotdata_field_count(num_pres) && si < IOTDATA_MAX_DATA_FIELDS; si++)
-        if (IOTDATA_FIELD_VALID(vdef->fields[si].type) && _iotdata_field_pres_byte(si) < num_pres && pres[_iotdata_field_pres_byte(si)] & (1U << _iotdata_field_pres_bit(si))) {
-            IOTDATA_FIELD_SET(dec->fields, vdef->fields[si].type);
-            if (!_iotdata_decode_unpack_field(buf, bb, &bp, dec, vdef->fields[si].type))
-                return IOTDATA_ERR_DECODE_TRUNCATED;
-        }
+    *pres0 = pres[0];
+    *present = _iotdata_pres_slots(pres, num_pres);
+    return IOTDATA_OK;
+}
 
-    /* TLV */
+/* TLV after the fields, then the packed size */
+static inline iotdata_status_t _iotdata_decode_end(const uint8_t *buf, size_t bb, size_t bp, iotdata_decoded_view_t *dec, uint8_t pres0) {
 #if defined(IOTDATA_ENABLE_TLV)
     dec->tlv_count = 0;
-    if ((pres[0] & IOTDATA_PRES_TLV) != 0) {
+    if ((pres0 & IOTDATA_PRES_TLV) != 0) {
         IOTDATA_FIELD_SET(dec->fields, IOTDATA_FIELD_TLV);
         if (!unpack_tlv(buf, bb, &bp, dec))
             return IOTDATA_ERR_DECODE_TRUNCATED;
     }
+#else
+    (void)buf;
+    (void)bb;
+    (void)pres0;
 #endif
 
     dec->packed_bits = bp;
@@ -4644,6 +5677,554 @@ iotdata_status_t iotdata_decode(const uint8_t *buf, size_t len, iotdata_decoded_
     return IOTDATA_OK;
 }
 
+#if defined(IOTDATA_DECODE_SPECIALISED)
+/*
+ * Specialised decoders: one _iotdata_decode_variant_N() per variant,
+ * generated from the X-list below, each the slot walk with the variant's
+ * map as a constant and the loop fully unrolled.  Where the map is visible
+ * in this translation unit (the default maps, or custom maps defined
+ * before iotdata.c is included) the compiler folds the slot types, so
+ * empty slots vanish and each used one becomes a presence bit test and a
+ * direct, inlinable unpack call in place of the plan's function pointer.
+ * Elsewhere the result is the same, only not folded.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define _IOTDATA_INLINE_ALWAYS static inline __attribute__((always_inline))
+#else
+#define _IOTDATA_INLINE_ALWAYS static inline
+#endif
+#if defined(__clang__)
+#define _IOTDATA_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define _IOTDATA_UNROLL _Pragma("GCC unroll 32")
+#else
+#define _IOTDATA_UNROLL
+#endif
+
+_IOTDATA_INLINE_ALWAYS iotdata_status_t _iotdata_decode_specialised(const uint8_t *buf, size_t len, iotdata_decoded_view_t *dec, uint8_t variant) {
+    const iotdata_variant_def_t *vdef = iotdata_get_variant(variant);
+    size_t bp;
+    uint8_t pres0;
+    uint32_t present;
+    iotdata_status_t rc;
+    if ((rc = _iotdata_decode_begin(buf, len, dec, &bp, &pres0, &present)) != IOTDATA_OK)
+        return rc;
+    if (vdef == NULL)
+        return IOTDATA_ERR_HDR_VARIANT_UNKNOWN;
+    const size_t bb = len * 8;
+    _IOTDATA_UNROLL
+    for (int si = 0; si < IOTDATA_MAX_DATA_FIELDS; si++) {
+        const iotdata_field_type_t type = vdef->fields[si].type;
+        if (present == 0)
+            break;
+        if (!IOTDATA_FIELD_VALID(type) || (present & _IOTDATA_SLOT_BIT(si)) == 0)
+            continue;
+        present &= ~_IOTDATA_SLOT_BIT(si);
+        IOTDATA_FIELD_SET(dec->fields, type);
+        const iotdata_field_ops_t *ops = (type >= 0 && type < IOTDATA_FIELD_COUNT) ? _iotdata_field_ops[type] : NULL;
+        if (ops != NULL && ops->unpack && !ops->unpack(buf, bb, &bp, dec))
+            return IOTDATA_ERR_DECODE_TRUNCATED;
+    }
+    return _iotdata_decode_end(buf, bb, bp, dec, pres0);
+}
+
+/* X-list of the variants a header can carry, 0 .. IOTDATA_VARIANT_MAX */
+#define _IOTDATA_DECODE_VARIANTS(X) X(0) X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9) X(10) X(11) X(12) X(13) X(14)
+_Static_assert(IOTDATA_VARIANT_MAX == 14, "decode variant X-list out of step");
+
+#define _IOTDATA_DECODE_VARIANT_DEFINE(n) \
+    static iotdata_status_t _iotdata_decode_variant_##n(const uint8_t *buf, size_t len, iotdata_decoded_view_t *dec) { \
+        return _iotdata_decode_specialised(buf, len, dec, (uint8_t)(n)); \
+    }
+#define _IOTDATA_DECODE_VARIANT_CASE(n) \
+    case n: \
+        return _iotdata_decode_variant_##n(buf, len, dec);
+
+_IOTDATA_DECODE_VARIANTS(_IOTDATA_DECODE_VARIANT_DEFINE)
+#endif
+
+static iotdata_status_t _iotdata_decode_view(const uint8_t *buf, size_t len, iotdata_decoded_view_t *dec, const _iotdata_plan_t **last) {
+#if defined(IOTDATA_DECODE_SPECIALISED)
+    if (buf != NULL && len > 0)
+        switch (buf[0] >> (8 - IOTDATA_VARIANT_BITS)) {
+            _IOTDATA_DECODE_VARIANTS(_IOTDATA_DECODE_VARIANT_CASE)
+        default: /* reserved */
+            break;
+        }
+#endif
+
+    size_t bp;
+    uint8_t pres0;
+    uint32_t present;
+    iotdata_status_t rc;
+    if ((rc = _iotdata_decode_begin(buf, len, dec, &bp, &pres0, &present)) != IOTDATA_OK)
+        return rc;
+    const size_t bb = len * 8;
+
+    /* Fields */
+    const _iotdata_plan_t *plan = (last != NULL && *last != NULL && (*last)->variant == dec->variant) ? *last : _iotdata_plan_get(dec->variant);
+    if (plan != NULL) {
+        if (last != NULL)
+            *last = plan;
+        for (present &= plan->slots; present != 0;) {
+            const int si = _iotdata_slot_first(present);
+            const _iotdata_plan_step_t *step = &plan->steps[plan->slot_step[si]];
+            present &= ~_IOTDATA_SLOT_BIT(si);
+            IOTDATA_FIELD_SET(dec->fields, step->type);
+            if (step->unpack && !step->unpack(buf, bb, &bp, dec))
+                return IOTDATA_ERR_DECODE_TRUNCATED;
+        }
+    } else {
+        const iotdata_variant_def_t *vdef = iotdata_get_variant(dec->variant);
+        if (vdef == NULL)
+            return IOTDATA_ERR_HDR_VARIANT_UNKNOWN;
+        while (present != 0) {
+            const int si = _iotdata_slot_first(present);
+            const iotdata_field_type_t type = vdef->fields[si].type;
+            present &= ~_IOTDATA_SLOT_BIT(si);
+            if (!IOTDATA_FIELD_VALID(type))
+                continue;
+            IOTDATA_FIELD_SET(dec->fields, type);
+            const iotdata_field_ops_t *ops = (type >= 0 && type < IOTDATA_FIELD_COUNT) ? _iotdata_field_ops[type] : NULL;
+            if (ops != NULL && ops->unpack && !ops->unpack(buf, bb, &bp, dec))
+                return IOTDATA_ERR_DECODE_TRUNCATED;
+        }
+    }
+
+    return _iotdata_decode_end(buf, bb, bp, dec, pres0);
+}
+
+static iotdata_status_t _iotdata_decode(const uint8_t *buf, size_t len, iotdata_decoded_t *dec, const _iotdata_plan_t **last) {
+#if !defined(IOTDATA_NO_CHECKS_STATE)
+    if (!dec)
+        return IOTDATA_ERR_CTX_NULL;
+#endif
+
+    const iotdata_status_t rc = _iotdata_decode_view(buf, len, &dec->view, last);
+    if (rc != IOTDATA_OK)
+        return rc;
+
+    /* Payloads, copied out of the packet once it has been validated */
+#if defined(IOTDATA_ENABLE_IMAGE)
+    if (IOTDATA_FIELD_PRESENT(dec->fields, IOTDATA_FIELD_IMAGE))
+        bits_read_bytes(buf, dec->image_data_offset, dec->image_data, dec->image_data_len);
+#endif
+#if defined(IOTDATA_ENABLE_TLV)
+    for (int i = 0; i < dec->tlv_count; i++)
+        _iotdata_tlv_copy_out(buf, &dec->tlv_view[i], &dec->tlv[i]);
+#endif
+
+    return IOTDATA_OK;
+}
+
+iotdata_status_t iotdata_decode(const uint8_t *buf, size_t len, iotdata_decoded_t *dec) {
+    return _iotdata_decode(buf, len, dec, NULL);
+}
+
+iotdata_status_t iotdata_decode_view(const uint8_t *buf, size_t len, iotdata_decoded_view_t *view) {
+#if !defined(IOTDATA_NO_CHECKS_STATE)
+    if (!view)
+        return IOTDATA_ERR_CTX_NULL;
+#endif
+    return _iotdata_decode_view(buf, len, view, NULL);
+}
+
+#if defined(IOTDATA_ENABLE_IMAGE)
+iotdata_status_t iotdata_view_image(const iotdata_decoded_view_t *view, const uint8_t *buf, uint8_t data[IOTDATA_IMAGE_DATA_MAX]) {
+#if !defined(IOTDATA_NO_CHECKS_STATE)
+    if (!view || !buf || !data)
+        return IOTDATA_ERR_CTX_NULL;
+#endif
+    if (!IOTDATA_FIELD_PRESENT(view->fields, IOTDATA_FIELD_IMAGE))
+        return IOTDATA_ERR_DECODE_VIEW_ABSENT;
+    bits_read_bytes(buf, view->image_data_offset, data, view->image_data_len);
+    return IOTDATA_OK;
+}
+#endif
+
+#if defined(IOTDATA_ENABLE_TLV)
+iotdata_status_t iotdata_view_tlv(const iotdata_decoded_view_t *view, const uint8_t *buf, uint8_t index, iotdata_decoded_tlv_t *tlv) {
+#if !defined(IOTDATA_NO_CHECKS_STATE)
+    if (!view || !buf || !tlv)
+        return IOTDATA_ERR_CTX_NULL;
+#endif
+    if (index >= view->tlv_count)
+        return IOTDATA_ERR_DECODE_VIEW_ABSENT;
+    _iotdata_tlv_copy_out(buf, &view->tlv_view[index], tlv);
+    return IOTDATA_OK;
+}
+#endif
+
+size_t iotdata_decode_many(const uint8_t *const *bufs, const size_t *lens, size_t n, iotdata_decoded_t *out, iotdata_status_t *rc) {
+#if !defined(IOTDATA_NO_CHECKS_STATE)
+    if (!bufs || !lens || !out) {
+        if (rc)
+            for (size_t i = 0; i < n; i++)
+                rc[i] = IOTDATA_ERR_CTX_NULL;
+        return 0;
+    }
+#endif
+    const _iotdata_plan_t *last = NULL;
+    size_t decoded = 0;
+    for (size_t i = 0; i < n; i++) {
+        const iotdata_status_t r = _iotdata_decode(bufs[i], lens[i], &out[i], &last);
+        if (rc)
+            rc[i] = r;
+        if (r == IOTDATA_OK)
+            decoded++;
+    }
+    return decoded;
+}
+
+/*
+ * Columnar output is table-driven: each value column copies a member of the
+ * scratch iotdata_decoded_view_t into row count of its buffer, each validity
+ * column sets or clears the row's bit, both keyed by the field types that
+ * carry the member. Per call, only the registered (non-NULL) columns are
+ * gathered, so a row costs in proportion to the columns wanted.
+ */
+#if defined(IOTDATA_ENABLE_BATTERY)
+#define _IOTDATA_COLUMN_BIT_BATTERY (1U << IOTDATA_FIELD_BATTERY)
+#else
+#define _IOTDATA_COLUMN_BIT_BATTERY 0U
+#endif
+#if defined(IOTDATA_ENABLE_LINK)
+#define _IOTDATA_COLUMN_BIT_LINK (1U << IOTDATA_FIELD_LINK)
+#else
+#define _IOTDATA_COLUMN_BIT_LINK 0U
+#endif
+#if defined(IOTDATA_ENABLE_ENVIRONMENT)
+#define _IOTDATA_COLUMN_BIT_ENVIRONMENT (1U << IOTDATA_FIELD_ENVIRONMENT)
+#else
+#define _IOTDATA_COLUMN_BIT_ENVIRONMENT 0U
+#endif
+#if defined(IOTDATA_ENABLE_TEMPERATURE)
+#define _IOTDATA_COLUMN_BIT_TEMPERATURE (1U << IOTDATA_FIELD_TEMPERATURE)
+#else
+#define _IOTDATA_COLUMN_BIT_TEMPERATURE 0U
+#endif
+#if defined(IOTDATA_ENABLE_PRESSURE)
+#define _IOTDATA_COLUMN_BIT_PRESSURE (1U << IOTDATA_FIELD_PRESSURE)
+#else
+#define _IOTDATA_COLUMN_BIT_PRESSURE 0U
+#endif
+#if defined(IOTDATA_ENABLE_HUMIDITY)
+#define _IOTDATA_COLUMN_BIT_HUMIDITY (1U << IOTDATA_FIELD_HUMIDITY)
+#else
+#define _IOTDATA_COLUMN_BIT_HUMIDITY 0U
+#endif
+#if defined(IOTDATA_ENABLE_WIND)
+#define _IOTDATA_COLUMN_BIT_WIND (1U << IOTDATA_FIELD_WIND)
+#else
+#define _IOTDATA_COLUMN_BIT_WIND 0U
+#endif
+#if defined(IOTDATA_ENABLE_WIND_SPEED)
+#define _IOTDATA_COLUMN_BIT_WIND_SPEED (1U << IOTDATA_FIELD_WIND_SPEED)
+#else
+#define _IOTDATA_COLUMN_BIT_WIND_SPEED 0U
+#endif
+#if defined(IOTDATA_ENABLE_WIND_DIRECTION)
+#define _IOTDATA_COLUMN_BIT_WIND_DIRECTION (1U << IOTDATA_FIELD_WIND_DIRECTION)
+#else
+#define _IOTDATA_COLUMN_BIT_WIND_DIRECTION 0U
+#endif
+#if defined(IOTDATA_ENABLE_WIND_GUST)
+#define _IOTDATA_COLUMN_BIT_WIND_GUST (1U << IOTDATA_FIELD_WIND_GUST)
+#else
+#define _IOTDATA_COLUMN_BIT_WIND_GUST 0U
+#endif
+#if defined(IOTDATA_ENABLE_RAIN)
+#define _IOTDATA_COLUMN_BIT_RAIN (1U << IOTDATA_FIELD_RAIN)
+#else
+#define _IOTDATA_COLUMN_BIT_RAIN 0U
+#endif
+#if defined(IOTDATA_ENABLE_RAIN_RATE)
+#define _IOTDATA_COLUMN_BIT_RAIN_RATE (1U << IOTDATA_FIELD_RAIN_RATE)
+#else
+#define _IOTDATA_COLUMN_BIT_RAIN_RATE 0U
+#endif
+#if defined(IOTDATA_ENABLE_RAIN_SIZE)
+#define _IOTDATA_COLUMN_BIT_RAIN_SIZE (1U << IOTDATA_FIELD_RAIN_SIZE)
+#else
+#define _IOTDATA_COLUMN_BIT_RAIN_SIZE 0U
+#endif
+#if defined(IOTDATA_ENABLE_SOLAR)
+#define _IOTDATA_COLUMN_BIT_SOLAR (1U << IOTDATA_FIELD_SOLAR)
+#else
+#define _IOTDATA_COLUMN_BIT_SOLAR 0U
+#endif
+#if defined(IOTDATA_ENABLE_CLOUDS)
+#define _IOTDATA_COLUMN_BIT_CLOUDS (1U << IOTDATA_FIELD_CLOUDS)
+#else
+#define _IOTDATA_COLUMN_BIT_CLOUDS 0U
+#endif
+#if defined(IOTDATA_ENABLE_AIR_QUALITY)
+#define _IOTDATA_COLUMN_BIT_AIR_QUALITY (1U << IOTDATA_FIELD_AIR_QUALITY)
+#else
+#define _IOTDATA_COLUMN_BIT_AIR_QUALITY 0U
+#endif
+#if defined(IOTDATA_ENABLE_AIR_QUALITY_INDEX)
+#define _IOTDATA_COLUMN_BIT_AIR_QUALITY_INDEX (1U << IOTDATA_FIELD_AIR_QUALITY_INDEX)
+#else
+#define _IOTDATA_COLUMN_BIT_AIR_QUALITY_INDEX 0U
+#endif
+#if defined(IOTDATA_ENABLE_AIR_QUALITY_PM)
+#define _IOTDATA_COLUMN_BIT_AIR_QUALITY_PM (1U << IOTDATA_FIELD_AIR_QUALITY_PM)
+#else
+#define _IOTDATA_COLUMN_BIT_AIR_QUALITY_PM 0U
+#endif
+#if defined(IOTDATA_ENABLE_AIR_QUALITY_GAS)
+#define _IOTDATA_COLUMN_BIT_AIR_QUALITY_GAS (1U << IOTDATA_FIELD_AIR_QUALITY_GAS)
+#else
+#define _IOTDATA_COLUMN_BIT_AIR_QUALITY_GAS 0U
+#endif
+#if defined(IOTDATA_ENABLE_RADIATION)
+#define _IOTDATA_COLUMN_BIT_RADIATION (1U << IOTDATA_FIELD_RADIATION)
+#else
+#define _IOTDATA_COLUMN_BIT_RADIATION 0U
+#endif
+#if defined(IOTDATA_ENABLE_RADIATION_CPM)
+#define _IOTDATA_COLUMN_BIT_RADIATION_CPM (1U << IOTDATA_FIELD_RADIATION_CPM)
+#else
+#define _IOTDATA_COLUMN_BIT_RADIATION_CPM 0U
+#endif
+#if defined(IOTDATA_ENABLE_RADIATION_DOSE)
+#define _IOTDATA_COLUMN_BIT_RADIATION_DOSE (1U << IOTDATA_FIELD_RADIATION_DOSE)
+#else
+#define _IOTDATA_COLUMN_BIT_RADIATION_DOSE 0U
+#endif
+#if defined(IOTDATA_ENABLE_DEPTH)
+#define _IOTDATA_COLUMN_BIT_DEPTH (1U << IOTDATA_FIELD_DEPTH)
+#else
+#define _IOTDATA_COLUMN_BIT_DEPTH 0U
+#endif
+#if defined(IOTDATA_ENABLE_POSITION)
+#define _IOTDATA_COLUMN_BIT_POSITION (1U << IOTDATA_FIELD_POSITION)
+#else
+#define _IOTDATA_COLUMN_BIT_POSITION 0U
+#endif
+#if defined(IOTDATA_ENABLE_DATETIME)
+#define _IOTDATA_COLUMN_BIT_DATETIME (1U << IOTDATA_FIELD_DATETIME)
+#else
+#define _IOTDATA_COLUMN_BIT_DATETIME 0U
+#endif
+#if defined(IOTDATA_ENABLE_FLAGS)
+#define _IOTDATA_COLUMN_BIT_FLAGS (1U << IOTDATA_FIELD_FLAGS)
+#else
+#define _IOTDATA_COLUMN_BIT_FLAGS 0U
+#endif
+
+typedef struct {
+    uint16_t column; /* offset of the buffer pointer in iotdata_columns_t */
+    uint16_t member; /* offset of the value in iotdata_decoded_view_t */
+    uint16_t size;
+    iotdata_field_t fields; /* field types that carry the value, 0 for the header (always present) */
+} _iotdata_column_def_t;
+#define _IOTDATA_COLUMN_VALUE(name, mask) { offsetof(iotdata_columns_t, name), offsetof(iotdata_decoded_view_t, name), sizeof(((iotdata_decoded_view_t *)0)->name), (mask) }
+#define _IOTDATA_COLUMN_VALID(name, mask) { offsetof(iotdata_columns_t, name), 0, 0, (mask) }
+static const _iotdata_column_def_t _iotdata_column_values[] = {
+    _IOTDATA_COLUMN_VALUE(variant, 0),
+    _IOTDATA_COLUMN_VALUE(station, 0),
+    _IOTDATA_COLUMN_VALUE(sequence, 0),
+#if defined(IOTDATA_ENABLE_BATTERY)
+    _IOTDATA_COLUMN_VALUE(battery_level, _IOTDATA_COLUMN_BIT_BATTERY),
+    _IOTDATA_COLUMN_VALUE(battery_charging, _IOTDATA_COLUMN_BIT_BATTERY),
+#endif
+#if defined(IOTDATA_ENABLE_LINK)
+    _IOTDATA_COLUMN_VALUE(link_rssi, _IOTDATA_COLUMN_BIT_LINK),
+    _IOTDATA_COLUMN_VALUE(link_snr, _IOTDATA_COLUMN_BIT_LINK),
+#endif
+#if defined(IOTDATA_ENABLE_ENVIRONMENT) || defined(IOTDATA_ENABLE_TEMPERATURE)
+    _IOTDATA_COLUMN_VALUE(temperature, _IOTDATA_COLUMN_BIT_ENVIRONMENT | _IOTDATA_COLUMN_BIT_TEMPERATURE),
+#endif
+#if defined(IOTDATA_ENABLE_ENVIRONMENT) || defined(IOTDATA_ENABLE_PRESSURE)
+    _IOTDATA_COLUMN_VALUE(pressure, _IOTDATA_COLUMN_BIT_ENVIRONMENT | _IOTDATA_COLUMN_BIT_PRESSURE),
+#endif
+#if defined(IOTDATA_ENABLE_ENVIRONMENT) || defined(IOTDATA_ENABLE_HUMIDITY)
+    _IOTDATA_COLUMN_VALUE(humidity, _IOTDATA_COLUMN_BIT_ENVIRONMENT | _IOTDATA_COLUMN_BIT_HUMIDITY),
+#endif
+#if defined(IOTDATA_ENABLE_WIND) || defined(IOTDATA_ENABLE_WIND_SPEED)
+    _IOTDATA_COLUMN_VALUE(wind_speed, _IOTDATA_COLUMN_BIT_WIND | _IOTDATA_COLUMN_BIT_WIND_SPEED),
+#endif
+#if defined(IOTDATA_ENABLE_WIND) || defined(IOTDATA_ENABLE_WIND_DIRECTION)
+    _IOTDATA_COLUMN_VALUE(wind_direction, _IOTDATA_COLUMN_BIT_WIND | _IOTDATA_COLUMN_BIT_WIND_DIRECTION),
+#endif
+#if defined(IOTDATA_ENABLE_WIND) || defined(IOTDATA_ENABLE_WIND_GUST)
+    _IOTDATA_COLUMN_VALUE(wind_gust, _IOTDATA_COLUMN_BIT_WIND | _IOTDATA_COLUMN_BIT_WIND_GUST),
+#endif
+#if defined(IOTDATA_ENABLE_RAIN) || defined(IOTDATA_ENABLE_RAIN_RATE)
+    _IOTDATA_COLUMN_VALUE(rain_rate, _IOTDATA_COLUMN_BIT_RAIN | _IOTDATA_COLUMN_BIT_RAIN_RATE),
+#endif
+#if defined(IOTDATA_ENABLE_RAIN) || defined(IOTDATA_ENABLE_RAIN_SIZE)
+    _IOTDATA_COLUMN_VALUE(rain_size10, _IOTDATA_COLUMN_BIT_RAIN | _IOTDATA_COLUMN_BIT_RAIN_SIZE),
+#endif
+#if defined(IOTDATA_ENABLE_SOLAR)
+    _IOTDATA_COLUMN_VALUE(solar_irradiance, _IOTDATA_COLUMN_BIT_SOLAR),
+    _IOTDATA_COLUMN_VALUE(solar_ultraviolet, _IOTDATA_COLUMN_BIT_SOLAR),
+#endif
+#if defined(IOTDATA_ENABLE_CLOUDS)
+    _IOTDATA_COLUMN_VALUE(clouds, _IOTDATA_COLUMN_BIT_CLOUDS),
+#endif
+#if defined(IOTDATA_ENABLE_AIR_QUALITY) || defined(IOTDATA_ENABLE_AIR_QUALITY_INDEX)
+    _IOTDATA_COLUMN_VALUE(aq_index, _IOTDATA_COLUMN_BIT_AIR_QUALITY | _IOTDATA_COLUMN_BIT_AIR_QUALITY_INDEX),
+#endif
+#if defined(IOTDATA_ENABLE_AIR_QUALITY) || defined(IOTDATA_ENABLE_AIR_QUALITY_PM)
+    _IOTDATA_COLUMN_VALUE(aq_pm_present, _IOTDATA_COLUMN_BIT_AIR_QUALITY | _IOTDATA_COLUMN_BIT_AIR_QUALITY_PM),
+    _IOTDATA_COLUMN_VALUE(aq_pm, _IOTDATA_COLUMN_BIT_AIR_QUALITY | _IOTDATA_COLUMN_BIT_AIR_QUALITY_PM),
+#endif
+#if defined(IOTDATA_ENABLE_AIR_QUALITY) || defined(IOTDATA_ENABLE_AIR_QUALITY_GAS)
+    _IOTDATA_COLUMN_VALUE(aq_gas_present, _IOTDATA_COLUMN_BIT_AIR_QUALITY | _IOTDATA_COLUMN_BIT_AIR_QUALITY_GAS),
+    _IOTDATA_COLUMN_VALUE(aq_gas, _IOTDATA_COLUMN_BIT_AIR_QUALITY | _IOTDATA_COLUMN_BIT_AIR_QUALITY_GAS),
+#endif
+#if defined(IOTDATA_ENABLE_RADIATION) || defined(IOTDATA_ENABLE_RADIATION_CPM)
+    _IOTDATA_COLUMN_VALUE(radiation_cpm, _IOTDATA_COLUMN_BIT_RADIATION | _IOTDATA_COLUMN_BIT_RADIATION_CPM),
+#endif
+#if defined(IOTDATA_ENABLE_RADIATION) || defined(IOTDATA_ENABLE_RADIATION_DOSE)
+    _IOTDATA_COLUMN_VALUE(radiation_dose, _IOTDATA_COLUMN_BIT_RADIATION | _IOTDATA_COLUMN_BIT_RADIATION_DOSE),
+#endif
+#if defined(IOTDATA_ENABLE_DEPTH)
+    _IOTDATA_COLUMN_VALUE(depth, _IOTDATA_COLUMN_BIT_DEPTH),
+#endif
+#if defined(IOTDATA_ENABLE_POSITION)
+    _IOTDATA_COLUMN_VALUE(position_lat, _IOTDATA_COLUMN_BIT_POSITION),
+    _IOTDATA_COLUMN_VALUE(position_lon, _IOTDATA_COLUMN_BIT_POSITION),
+#endif
+#if defined(IOTDATA_ENABLE_DATETIME)
+    _IOTDATA_COLUMN_VALUE(datetime_secs, _IOTDATA_COLUMN_BIT_DATETIME),
+#endif
+#if defined(IOTDATA_ENABLE_FLAGS)
+    _IOTDATA_COLUMN_VALUE(flags, _IOTDATA_COLUMN_BIT_FLAGS),
+#endif
+};
+#define _IOTDATA_COLUMN_VALUES_COUNT (sizeof(_iotdata_column_values) / sizeof(_iotdata_column_values[0]))
+static const _iotdata_column_def_t _iotdata_column_valids[] = {
+#if defined(IOTDATA_ENABLE_BATTERY)
+    _IOTDATA_COLUMN_VALID(battery_valid, _IOTDATA_COLUMN_BIT_BATTERY),
+#endif
+#if defined(IOTDATA_ENABLE_LINK)
+    _IOTDATA_COLUMN_VALID(link_valid, _IOTDATA_COLUMN_BIT_LINK),
+#endif
+#if defined(IOTDATA_ENABLE_ENVIRONMENT) || defined(IOTDATA_ENABLE_TEMPERATURE)
+    _IOTDATA_COLUMN_VALID(temperature_valid, _IOTDATA_COLUMN_BIT_ENVIRONMENT | _IOTDATA_COLUMN_BIT_TEMPERATURE),
+#endif
+#if defined(IOTDATA_ENABLE_ENVIRONMENT) || defined(IOTDATA_ENABLE_PRESSURE)
+    _IOTDATA_COLUMN_VALID(pressure_valid, _IOTDATA_COLUMN_BIT_ENVIRONMENT | _IOTDATA_COLUMN_BIT_PRESSURE),
+#endif
+#if defined(IOTDATA_ENABLE_ENVIRONMENT) || defined(IOTDATA_ENABLE_HUMIDITY)
+    _IOTDATA_COLUMN_VALID(humidity_valid, _IOTDATA_COLUMN_BIT_ENVIRONMENT | _IOTDATA_COLUMN_BIT_HUMIDITY),
+#endif
+#if defined(IOTDATA_ENABLE_WIND) || defined(IOTDATA_ENABLE_WIND_SPEED)
+    _IOTDATA_COLUMN_VALID(wind_speed_valid, _IOTDATA_COLUMN_BIT_WIND | _IOTDATA_COLUMN_BIT_WIND_SPEED),
+#endif
+#if defined(IOTDATA_ENABLE_WIND) || defined(IOTDATA_ENABLE_WIND_DIRECTION)
+    _IOTDATA_COLUMN_VALID(wind_direction_valid, _IOTDATA_COLUMN_BIT_WIND | _IOTDATA_COLUMN_BIT_WIND_DIRECTION),
+#endif
+#if defined(IOTDATA_ENABLE_WIND) || defined(IOTDATA_ENABLE_WIND_GUST)
+    _IOTDATA_COLUMN_VALID(wind_gust_valid, _IOTDATA_COLUMN_BIT_WIND | _IOTDATA_COLUMN_BIT_WIND_GUST),
+#endif
+#if defined(IOTDATA_ENABLE_RAIN) || defined(IOTDATA_ENABLE_RAIN_RATE)
+    _IOTDATA_COLUMN_VALID(rain_rate_valid, _IOTDATA_COLUMN_BIT_RAIN | _IOTDATA_COLUMN_BIT_RAIN_RATE),
+#endif
+#if defined(IOTDATA_ENABLE_RAIN) || defined(IOTDATA_ENABLE_RAIN_SIZE)
+    _IOTDATA_COLUMN_VALID(rain_size_valid, _IOTDATA_COLUMN_BIT_RAIN | _IOTDATA_COLUMN_BIT_RAIN_SIZE),
+#endif
+#if defined(IOTDATA_ENABLE_SOLAR)
+    _IOTDATA_COLUMN_VALID(solar_valid, _IOTDATA_COLUMN_BIT_SOLAR),
+#endif
+#if defined(IOTDATA_ENABLE_CLOUDS)
+    _IOTDATA_COLUMN_VALID(clouds_valid, _IOTDATA_COLUMN_BIT_CLOUDS),
+#endif
+#if defined(IOTDATA_ENABLE_AIR_QUALITY) || defined(IOTDATA_ENABLE_AIR_QUALITY_INDEX)
+    _IOTDATA_COLUMN_VALID(aq_index_valid, _IOTDATA_COLUMN_BIT_AIR_QUALITY | _IOTDATA_COLUMN_BIT_AIR_QUALITY_INDEX),
+#endif
+#if defined(IOTDATA_ENABLE_AIR_QUALITY) || defined(IOTDATA_ENABLE_AIR_QUALITY_PM)
+    _IOTDATA_COLUMN_VALID(aq_pm_valid, _IOTDATA_COLUMN_BIT_AIR_QUALITY | _IOTDATA_COLUMN_BIT_AIR_QUALITY_PM),
+#endif
+#if defined(IOTDATA_ENABLE_AIR_QUALITY) || defined(IOTDATA_ENABLE_AIR_QUALITY_GAS)
+    _IOTDATA_COLUMN_VALID(aq_gas_valid, _IOTDATA_COLUMN_BIT_AIR_QUALITY | _IOTDATA_COLUMN_BIT_AIR_QUALITY_GAS),
+#endif
+#if defined(IOTDATA_ENABLE_RADIATION) || defined(IOTDATA_ENABLE_RADIATION_CPM)
+    _IOTDATA_COLUMN_VALID(radiation_cpm_valid, _IOTDATA_COLUMN_BIT_RADIATION | _IOTDATA_COLUMN_BIT_RADIATION_CPM),
+#endif
+#if defined(IOTDATA_ENABLE_RADIATION) || defined(IOTDATA_ENABLE_RADIATION_DOSE)
+    _IOTDATA_COLUMN_VALID(radiation_dose_valid, _IOTDATA_COLUMN_BIT_RADIATION | _IOTDATA_COLUMN_BIT_RADIATION_DOSE),
+#endif
+#if defined(IOTDATA_ENABLE_DEPTH)
+    _IOTDATA_COLUMN_VALID(depth_valid, _IOTDATA_COLUMN_BIT_DEPTH),
+#endif
+#if defined(IOTDATA_ENABLE_POSITION)
+    _IOTDATA_COLUMN_VALID(position_valid, _IOTDATA_COLUMN_BIT_POSITION),
+#endif
+#if defined(IOTDATA_ENABLE_DATETIME)
+    _IOTDATA_COLUMN_VALID(datetime_valid, _IOTDATA_COLUMN_BIT_DATETIME),
+#endif
+#if defined(IOTDATA_ENABLE_FLAGS)
+    _IOTDATA_COLUMN_VALID(flags_valid, _IOTDATA_COLUMN_BIT_FLAGS),
+#endif
+    { 0, 0, 0, 0 }, /* never empty */
+};
+#define _IOTDATA_COLUMN_VALIDS_COUNT (sizeof(_iotdata_column_valids) / sizeof(_iotdata_column_valids[0]) - 1)
+
+typedef struct {
+    uint8_t *buf;
+    const _iotdata_column_def_t *def;
+} _iotdata_column_t;
+
+static int _iotdata_columns_gather(const iotdata_columns_t *cols, const _iotdata_column_def_t *defs, size_t count, _iotdata_column_t *active) {
+    int n = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint8_t *buf;
+        memcpy(&buf, (const uint8_t *)cols + defs[i].column, sizeof(buf));
+        if (buf != NULL) {
+            active[n].buf = buf;
+            active[n++].def = &defs[i];
+        }
+    }
+    return n;
+}
+
+static void _iotdata_columns_append(const _iotdata_column_t *values, int num_values, const _iotdata_column_t *valids, int num_valids, size_t row, const iotdata_decoded_view_t *dec) {
+    for (int i = 0; i < num_values; i++) {
+        const _iotdata_column_def_t *def = values[i].def;
+        uint8_t *dst = values[i].buf + row * def->size;
+        if (def->fields == 0 || (dec->fields & def->fields) != 0)
+            memcpy(dst, (const uint8_t *)dec + def->member, def->size);
+        else
+            memset(dst, 0, def->size);
+    }
+    const uint8_t bit = (uint8_t)(1U << (row & 7));
+    for (int i = 0; i < num_valids; i++) {
+        uint8_t *byte = &valids[i].buf[row >> 3];
+        *byte = (dec->fields & valids[i].def->fields) != 0 ? (uint8_t)(*byte | bit) : (uint8_t)(*byte & ~bit);
+    }
+}
+
+size_t iotdata_decode_columns(const uint8_t *const *bufs, const size_t *lens, size_t n, iotdata_columns_t *cols, iotdata_status_t *rc, iotdata_decode_columns_scratch_t *scratch) {
+#if !defined(IOTDATA_NO_CHECKS_STATE)
+    if (!bufs || !lens || !cols || !scratch) {
+        if (rc)
+            for (size_t i = 0; i < n; i++)
+                rc[i] = IOTDATA_ERR_CTX_NULL;
+        return 0;
+    }
+#endif
+    _iotdata_column_t values[_IOTDATA_COLUMN_VALUES_COUNT], valids[_IOTDATA_COLUMN_VALIDS_COUNT + 1];
+    const int num_values = _iotdata_columns_gather(cols, _iotdata_column_values, _IOTDATA_COLUMN_VALUES_COUNT, values);
+    const int num_valids = _iotdata_columns_gather(cols, _iotdata_column_valids, _IOTDATA_COLUMN_VALIDS_COUNT, valids);
+    const _iotdata_plan_t *last = NULL;
+    size_t appended = 0;
+    for (size_t i = 0; i < n; i++) {
+        iotdata_status_t r = IOTDATA_ERR_DECODE_COLUMNS_FULL;
+        if (cols->count < cols->capacity && (r = _iotdata_decode_view(bufs[i], lens[i], &scratch->view, &last)) == IOTDATA_OK) {
+            _iotdata_columns_append(values, num_values, valids, num_valids, cols->count++, &scratch->view);
+            appended++;
+        }
+        if (rc)
+            rc[i] = r;
+    }
+    return appended;
+}
+
 #endif /* !IOTDATA_NO_DECODE */
 
 #if !defined(IOTDATA_NO_DECODE)
@@ -4653,7 +6234,11 @@ iotdata_status_t iotdata_decode(const uint8_t *buf, size_t len, iotdata_decoded_
     case IOTDATA_ERR_DECODE_TRUNCATED: \
         return "Decoding buffer too short for content"; \
     case IOTDATA_ERR_DECODE_VARIANT: \
-        return "Decoding variant unsupported";
+        return "Decoding variant unsupported"; \
+    case IOTDATA_ERR_DECODE_COLUMNS_FULL: \
+        return "Decoding columns full"; \
+    case IOTDATA_ERR_DECODE_VIEW_ABSENT: \
+        return "Decoding view entry absent";
 #elif !defined(IOTDATA_NO_DUMP)
 #define _IOTDATA_ERR_DECODE \
     case IOTDATA_ERR_DECODE_SHORT: \
@@ -4671,16 +6256,43 @@ iotdata_status_t iotdata_decode(const uint8_t *buf, size_t len, iotdata_decoded_
 #if !defined(IOTDATA_NO_JSON)
 #if !defined(IOTDATA_NO_DECODE)
 
-static void _iotdata_decode_to_json_set_field(cJSON *root, const iotdata_decoded_t *dec, iotdata_field_type_t type, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
+static void _iotdata_decode_to_json_write_field(iotdata_json_t *jw, const iotdata_decoded_t *dec, iotdata_field_type_t type, const char *label, iotdata_decode_to_json_scratch_t *scratch) {
     const iotdata_field_ops_t *ops = (type >= 0 && type < IOTDATA_FIELD_COUNT) ? _iotdata_field_ops[type] : NULL;
-    if (ops && ops->json_set)
-        ops->json_set(root, dec, label, scratch);
+    if (ops && ops->json_write)
+        ops->json_write(jw, dec, label, scratch);
 }
 
-iotdata_status_t iotdata_decode_to_json(const uint8_t *buf, size_t len, char **json_out, iotdata_decode_to_json_scratch_t *scratch) {
+static iotdata_status_t _iotdata_decode_to_json_write(iotdata_json_t *jw, const iotdata_decoded_t *dec, iotdata_decode_to_json_scratch_t *scratch) {
+    const iotdata_variant_def_t *vdef = iotdata_get_variant(dec->variant);
+    if (vdef == NULL)
+        return IOTDATA_ERR_HDR_VARIANT_UNKNOWN;
+
+    jw_object_begin(jw, NULL);
+    jw_number(jw, "variant", dec->variant);
+    jw_number(jw, "station", dec->station);
+    jw_number(jw, "sequence", dec->sequence);
+    jw_number(jw, "packed_bits", (uint32_t)dec->packed_bits);
+    jw_number(jw, "packed_bytes", (uint32_t)dec->packed_bytes);
+
+    /* Fields */
+    for (int si = 0; si < _iotdata_field_count(vdef->num_pres_bytes); si++)
+        if (IOTDATA_FIELD_VALID(vdef->fields[si].type) && IOTDATA_FIELD_PRESENT(dec->fields, vdef->fields[si].type))
+            _iotdata_decode_to_json_write_field(jw, dec, vdef->fields[si].type, vdef->fields[si].label, scratch);
+
+    /* TLV */
+#if defined(IOTDATA_ENABLE_TLV)
+    if (IOTDATA_FIELD_PRESENT(dec->fields, IOTDATA_FIELD_TLV))
+        json_write_tlv(jw, dec, "data", scratch);
+#endif
+
+    jw_object_end(jw);
+    return IOTDATA_OK;
+}
+
+iotdata_status_t iotdata_decode_to_json_buffer(const uint8_t *buf, size_t len, char *out, size_t out_size, size_t *out_len, iotdata_decode_to_json_scratch_t *scratch) {
 #if !defined(IOTDATA_NO_CHECKS_STATE)
-    if (!json_out)
-        return IOTDATA_ERR_CTX_NULL;
+    if (!out && out_size > 0)
+        return IOTDATA_ERR_BUF_NULL;
     if (!scratch)
         return IOTDATA_ERR_BUF_NULL;
 #endif
@@ -4690,36 +6302,41 @@ iotdata_status_t iotdata_decode_to_json(const uint8_t *buf, size_t len, char **j
     if ((rc = iotdata_decode(buf, len, dec)) != IOTDATA_OK)
         return rc;
 
-    cJSON *root = cJSON_CreateObject();
-    if (!root)
-        return IOTDATA_ERR_JSON_ALLOC;
-
-    cJSON_AddNumberToObject(root, "variant", dec->variant);
-    cJSON_AddNumberToObject(root, "station", dec->station);
-    cJSON_AddNumberToObject(root, "sequence", dec->sequence);
-    cJSON_AddNumberToObject(root, "packed_bits", (uint32_t)dec->packed_bits);
-    cJSON_AddNumberToObject(root, "packed_bytes", (uint32_t)dec->packed_bytes);
-
-    /* Fields */
-    const iotdata_variant_def_t *vdef = iotdata_get_variant(dec->variant);
-    if (vdef == NULL) {
-        cJSON_Delete(root);
-        return IOTDATA_ERR_HDR_VARIANT_UNKNOWN;
-    }
-    for (int si = 0; si < _iotdata_field_count(vdef->num_pres_bytes); si++)
-        if (IOTDATA_FIELD_VALID(vdef->fields[si].type) && IOTDATA_FIELD_PRESENT(dec->fields, vdef->fields[si].type))
-            _iotdata_decode_to_json_set_field(root, dec, vdef->fields[si].type, vdef->fields[si].label, scratch);
+    iotdata_json_t jw = { .buf = out, .size = out_size, .pos = 0, .first = true };
+    if ((rc = _iotdata_decode_to_json_write(&jw, dec, scratch)) != IOTDATA_OK)
+        return rc;
+    if (out_len)
+        *out_len = jw.pos;
+    if (jw.pos >= out_size)
+        return IOTDATA_ERR_JSON_OVERFLOW;
+    out[jw.pos] = '\0';
+    return IOTDATA_OK;
+}
 
-    /* TLV */
-#if defined(IOTDATA_ENABLE_TLV)
-    if (IOTDATA_FIELD_PRESENT(dec->fields, IOTDATA_FIELD_TLV))
-        json_set_tlv(root, dec, "data", scratch);
+iotdata_status_t iotdata_decode_to_json(const uint8_t *buf, size_t len, char **json_out, iotdata_decode_to_json_scratch_t *scratch) {
+#if !defined(IOTDATA_NO_CHECKS_STATE)
+    if (!json_out)
+        return IOTDATA_ERR_CTX_NULL;
+    if (!scratch)
+        return IOTDATA_ERR_BUF_NULL;
 #endif
 
-    *json_out = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
-    if (!*json_out)
+    iotdata_decoded_t *dec = &scratch->dec;
+    iotdata_status_t rc;
+    if ((rc = iotdata_decode(buf, len, dec)) != IOTDATA_OK)
+        return rc;
+
+    /* Measure, then write into an exactly sized allocation */
+    iotdata_json_t jw = { .buf = NULL, .size = 0, .pos = 0, .first = true };
+    if ((rc = _iotdata_decode_to_json_write(&jw, dec, scratch)) != IOTDATA_OK)
+        return rc;
+    char *out = malloc(jw.pos + 1);
+    if (!out)
         return IOTDATA_ERR_JSON_ALLOC;
+    jw = (iotdata_json_t){ .buf = out, .size = jw.pos + 1, .pos = 0, .first = true };
+    _iotdata_decode_to_json_write(&jw, dec, scratch);
+    out[jw.pos] = '\0';
+    *json_out = out;
     return IOTDATA_OK;
 }
 
@@ -4727,11 +6344,37 @@ iotdata_status_t iotdata_decode_to_json(const uint8_t *buf, size_t len, char **j
 
 #if !defined(IOTDATA_NO_ENCODE)
 
-static iotdata_status_t _iotdata_encode_from_json_get_field(cJSON *root, iotdata_encoder_t *enc, iotdata_field_type_t type, const char *label, iotdata_encode_from_json_scratch_t *scratch) {
-    const iotdata_field_ops_t *ops = (type >= 0 && type < IOTDATA_FIELD_COUNT) ? _iotdata_field_ops[type] : NULL;
-    if (ops && ops->json_get)
-        return ops->json_get(root, enc, label, scratch);
-    return IOTDATA_OK;
+static const char *const _iotdata_json_header[] = { "variant", "station", "sequence" };
+
+static int _iotdata_encode_from_json_header(const char *key) {
+    for (int i = 0; i < 3; i++)
+        if (jr_key_eq(key, _iotdata_json_header[i]))
+            return i;
+    return -1;
+}
+
+/* Slot of the variant's field labelled key, or -1: by the plan's label index, else by scanning the slot table */
+static int _iotdata_encode_from_json_slot(const _iotdata_plan_t *plan, const iotdata_variant_def_t *vdef, const char *key) {
+#if _IOTDATA_PLAN_COUNT > 0
+    if (plan != NULL)
+        return _iotdata_plan_json_slot(plan, key);
+#else
+    (void)plan;
+#endif
+    for (int si = 0; si < _iotdata_field_count(vdef->num_pres_bytes); si++)
+        if (IOTDATA_FIELD_VALID(vdef->fields[si].type) && vdef->fields[si].label != NULL && jr_key_eq(key, vdef->fields[si].label))
+            return si;
+    return -1;
+}
+
+/* Records one top-level member against its slot by label; the first occurrence of a label wins, as with cJSON_GetObjectItem */
+static void _iotdata_encode_from_json_member(const _iotdata_plan_t *plan, const iotdata_variant_def_t *vdef, const char *key, const char *value, const char **values, const char **tlv) {
+    const int si = _iotdata_encode_from_json_slot(plan, vdef, key);
+    if (si >= 0) {
+        if (values[si] == NULL)
+            values[si] = value;
+    } else if (jr_key_eq(key, "data") && *tlv == NULL)
+        *tlv = value;
 }
 
 iotdata_status_t iotdata_encode_from_json(const char *json, uint8_t *buf, size_t buf_size, size_t *out_bytes, iotdata_encode_from_json_scratch_t *scratch) {
@@ -4739,49 +6382,79 @@ iotdata_status_t iotdata_encode_from_json(const char *json, uint8_t *buf, size_t
     if (!scratch)
         return IOTDATA_ERR_BUF_NULL;
 #endif
-    cJSON *root = cJSON_Parse(json);
-    if (!root)
+    if (!json)
         return IOTDATA_ERR_JSON_PARSE;
-
-    cJSON *j_var = cJSON_GetObjectItem(root, "variant");
-    cJSON *j_sid = cJSON_GetObjectItem(root, "station");
-    cJSON *j_seq = cJSON_GetObjectItem(root, "sequence");
-    if (!j_var || !j_sid || !j_seq) {
-        cJSON_Delete(root);
-        return IOTDATA_ERR_JSON_MISSING_FIELD;
-    }
-
+    const char *root = jr_ws(json), *p;
+    if (*root != '{')
+        return (p = jr_skip(root, 0)) != NULL && !*jr_ws(p) ? IOTDATA_ERR_JSON_MISSING_FIELD : IOTDATA_ERR_JSON_PARSE;
+
+    /* Single pass over the top-level members, validating each value before it is used. Once
+     * the header is complete the encoder is started and each later member is recorded against
+     * its slot by label. If any member precedes the header, recording moves to a second pass
+     * at the end. Fields are then added in slot order, as the streaming encoder requires. */
     iotdata_encoder_t *enc = &scratch->enc;
+    const _iotdata_plan_t *plan = NULL;
+    const iotdata_variant_def_t *vdef = NULL;
+    const char *header[3] = { NULL, NULL, NULL }, *values[IOTDATA_MAX_DATA_FIELDS] = { NULL }, *tlv = NULL;
+    char key[_IOTDATA_JSON_KEY_MAX];
+    bool deferred = false;
     iotdata_status_t rc;
-    if ((rc = iotdata_encode_begin(enc, buf, buf_size, (uint8_t)j_var->valueint, (uint16_t)j_sid->valueint, (uint16_t)j_seq->valueint)) != IOTDATA_OK) {
-        cJSON_Delete(root);
-        return rc;
+    for (p = jr_ws(root + 1); *p != '}';) {
+        const char *k = p, *v;
+        if (*p != '"' || !(p = jr_skip_string(p)) || *(p = jr_ws(p)) != ':' || !(p = jr_skip(v = jr_ws(p + 1), 1)))
+            return IOTDATA_ERR_JSON_PARSE;
+        if (*(p = jr_ws(p)) == ',') {
+            if (*(p = jr_ws(p + 1)) == '}')
+                return IOTDATA_ERR_JSON_PARSE;
+        } else if (*p != '}')
+            return IOTDATA_ERR_JSON_PARSE;
+        if (jr_string(k, key, sizeof(key)) >= (int)sizeof(key))
+            continue; /* too long to match any label */
+        const int hi = _iotdata_encode_from_json_header(key);
+        if (hi >= 0) {
+            if (header[hi] == NULL)
+                header[hi] = v;
+            if (vdef == NULL && header[0] && header[1] && header[2]) {
+                if ((rc = iotdata_encode_begin(enc, buf, buf_size, (uint8_t)jr_int(header[0]), (uint16_t)jr_int(header[1]), (uint16_t)jr_int(header[2]))) != IOTDATA_OK)
+                    return rc;
+                plan = _iotdata_plan_get(enc->variant);
+                if ((vdef = plan != NULL ? plan->vdef : iotdata_get_variant(enc->variant)) == NULL)
+                    return IOTDATA_ERR_HDR_VARIANT_UNKNOWN;
+            }
+        } else if (vdef == NULL || deferred)
+            deferred = true; /* keep document order so that the first occurrence of a label wins */
+        else
+            _iotdata_encode_from_json_member(plan, vdef, key, v, values, &tlv);
     }
+    if (*jr_ws(p + 1))
+        return IOTDATA_ERR_JSON_PARSE;
+    if (vdef == NULL)
+        return IOTDATA_ERR_JSON_MISSING_FIELD;
 
-    /* Fields */
-    const iotdata_variant_def_t *vdef = iotdata_get_variant(enc->variant);
-    if (vdef == NULL) {
-        cJSON_Delete(root);
-        return IOTDATA_ERR_HDR_VARIANT_UNKNOWN;
+    if (deferred) {
+        jr_iter_t it;
+        const char *k, *v;
+        jr_iter(&it, root, '{');
+        while ((v = jr_next(&it, &k)) != NULL)
+            if (jr_string(k, key, sizeof(key)) < (int)sizeof(key) && _iotdata_encode_from_json_header(key) < 0)
+                _iotdata_encode_from_json_member(plan, vdef, key, v, values, &tlv);
     }
-    for (int si = 0; si < _iotdata_field_count(vdef->num_pres_bytes); si++)
-        if (IOTDATA_FIELD_VALID(vdef->fields[si].type))
-            if ((rc = _iotdata_encode_from_json_get_field(root, enc, vdef->fields[si].type, vdef->fields[si].label, scratch)) != IOTDATA_OK) {
-                cJSON_Delete(root);
-                return rc;
-            }
 
-    /* TLV */
+    for (int si = 0; si < IOTDATA_MAX_DATA_FIELDS; si++)
+        if (values[si] != NULL) {
+            const iotdata_field_type_t type = vdef->fields[si].type;
+            const iotdata_field_ops_t *ops = (type >= 0 && type < IOTDATA_FIELD_COUNT) ? _iotdata_field_ops[type] : NULL;
+            if (ops && ops->json_get && (rc = ops->json_get(values[si], enc, scratch)) != IOTDATA_OK)
+                return rc;
+        }
 #if defined(IOTDATA_ENABLE_TLV)
-    if ((rc = json_get_tlv(root, enc, "data", &scratch->tlv)) != IOTDATA_OK) {
-        cJSON_Delete(root);
+    if (tlv != NULL && (rc = json_get_tlv(tlv, enc, &scratch->tlv)) != IOTDATA_OK)
         return rc;
-    }
+#else
+    (void)tlv;
 #endif
 
-    rc = iotdata_encode_end(enc, out_bytes);
-    cJSON_Delete(root);
-    return rc;
+    return iotdata_encode_end(enc, out_bytes);
 }
 
 #endif /* !IOTDATA_NO_ENCODE */
@@ -4793,6 +6466,8 @@ iotdata_status_t iotdata_encode_from_json(const char *json, uint8_t *buf, size_t
         return "JSON parse error"; \
     case IOTDATA_ERR_JSON_ALLOC: \
         return "JSON allocation error"; \
+    case IOTDATA_ERR_JSON_OVERFLOW: \
+        return "JSON output buffer too small"; \
     case IOTDATA_ERR_JSON_MISSING_FIELD: \
         return "JSON mandatory field missing";
 #else
@@ -25,7 +25,9 @@
  *   IOTDATA_ENABLE_xxx             Enable individual field types
  *   IOTDATA_ENABLE_TLV             Enable TLV
  *   IOTDATA_NO_DECODE              Exclude decoder
+ *   IOTDATA_DECODE_SPECIALISED     Straight-line decoder per variant (maps known at build)
  *   IOTDATA_NO_ENCODE              Exclude encoder
+ *   IOTDATA_ENCODE_STREAMING       Pack each field as it is added (slot order)
  *   IOTDATA_NO_PRINT               Exclude Print output support
  *   IOTDATA_NO_DUMP                Exclude Dump output support
  *   IOTDATA_NO_JSON                Exclude JSON support
@@ -107,11 +109,16 @@ extern "C" {
 #define IOTDATA_BATTERY_FIELDS \
     uint8_t battery_level; \
     bool battery_charging;
+#define IOTDATA_BATTERY_COLUMNS \
+    uint8_t *battery_level; \
+    bool *battery_charging; \
+    uint8_t *battery_valid;
 #define IOTDATA_BATTERY_LEVEL_MAX   100
 #define IOTDATA_BATTERY_LEVEL_BITS  5
 #define IOTDATA_BATTERY_CHARGE_BITS 1
 #else
 #define IOTDATA_BATTERY_FIELDS
+#define IOTDATA_BATTERY_COLUMNS
 #endif
 
 /* ---------------------------------------------------------------------------
@@ -122,6 +129,10 @@ extern "C" {
 #define IOTDATA_LINK_FIELDS \
     int16_t link_rssi; \
     iotdata_float_t link_snr;
+#define IOTDATA_LINK_COLUMNS \
+    int16_t *link_rssi; \
+    iotdata_float_t *link_snr; \
+    uint8_t *link_valid;
 #define IOTDATA_LINK_RSSI_MIN  (-120)
 #define IOTDATA_LINK_RSSI_MAX  (-60)
 #define IOTDATA_LINK_RSSI_STEP (4)
@@ -136,8 +147,11 @@ extern "C" {
 #define IOTDATA_LINK_SNR_STEP (100)
 #endif
 #define IOTDATA_LINK_SNR_BITS (2)
+/* _DECIMALS: places at which every quantised value is exact (and the NO_FLOATING scale) */
+#define IOTDATA_LINK_SNR_DECIMALS (1)
 #else
 #define IOTDATA_LINK_FIELDS
+#define IOTDATA_LINK_COLUMNS
 #endif
 
 /* ---------------------------------------------------------------------------
@@ -146,6 +160,9 @@ extern "C" {
 
 #if defined(IOTDATA_ENABLE_ENVIRONMENT) || defined(IOTDATA_ENABLE_TEMPERATURE)
 #define IOTDATA_TEMPERATURE_FIELD iotdata_float_t temperature;
+#define IOTDATA_TEMPERATURE_COLUMN \
+    iotdata_float_t *temperature; \
+    uint8_t *temperature_valid;
 #if !defined(IOTDATA_NO_FLOATING)
 #define IOTDATA_TEMPERATURE_MIN (-40.0f)
 #define IOTDATA_TEMPERATURE_MAX (80.0f)
@@ -155,26 +172,37 @@ extern "C" {
 #define IOTDATA_TEMPERATURE_MAX (8000)
 #define IOTDATA_TEMPERATURE_RES (25)
 #endif
-#define IOTDATA_TEMPERATURE_BITS 9
+#define IOTDATA_TEMPERATURE_BITS     9
+#define IOTDATA_TEMPERATURE_DECIMALS 2
 #else
 #define IOTDATA_TEMPERATURE_FIELD
+#define IOTDATA_TEMPERATURE_COLUMN
 #endif
 #if defined(IOTDATA_ENABLE_ENVIRONMENT) || defined(IOTDATA_ENABLE_PRESSURE)
 #define IOTDATA_PRESSURE_FIELD uint16_t pressure;
+#define IOTDATA_PRESSURE_COLUMN \
+    uint16_t *pressure; \
+    uint8_t *pressure_valid;
 #define IOTDATA_PRESSURE_MIN   850
 #define IOTDATA_PRESSURE_MAX   1105
 #define IOTDATA_PRESSURE_BITS  8
 #else
 #define IOTDATA_PRESSURE_FIELD
+#define IOTDATA_PRESSURE_COLUMN
 #endif
 #if defined(IOTDATA_ENABLE_ENVIRONMENT) || defined(IOTDATA_ENABLE_HUMIDITY)
 #define IOTDATA_HUMIDITY_FIELD uint8_t humidity;
+#define IOTDATA_HUMIDITY_COLUMN \
+    uint8_t *humidity; \
+    uint8_t *humidity_valid;
 #define IOTDATA_HUMIDITY_MAX   100
 #define IOTDATA_HUMIDITY_BITS  7
 #else
 #define IOTDATA_HUMIDITY_FIELD
+#define IOTDATA_HUMIDITY_COLUMN
 #endif
 #define IOTDATA_ENVIRONMENT_FIELDS IOTDATA_TEMPERATURE_FIELD IOTDATA_PRESSURE_FIELD IOTDATA_HUMIDITY_FIELD
+#define IOTDATA_ENVIRONMENT_COLUMNS IOTDATA_TEMPERATURE_COLUMN IOTDATA_PRESSURE_COLUMN IOTDATA_HUMIDITY_COLUMN
 
 /* ---------------------------------------------------------------------------
  * Field WIND, WIND_SPEED, WIND_DIRECTION, WIND_GUST
@@ -182,6 +210,9 @@ extern "C" {
 
 #if defined(IOTDATA_ENABLE_WIND) || defined(IOTDATA_ENABLE_WIND_SPEED)
 #define IOTDATA_WIND_SPEED_FIELD iotdata_float_t wind_speed;
+#define IOTDATA_WIND_SPEED_COLUMN \
+    iotdata_float_t *wind_speed; \
+    uint8_t *wind_speed_valid;
 #if !defined(IOTDATA_NO_FLOATING)
 #define IOTDATA_WIND_SPEED_RES (0.5f)
 #define IOTDATA_WIND_SPEED_MAX (63.5f)
@@ -189,24 +220,35 @@ extern "C" {
 #define IOTDATA_WIND_SPEED_RES (50)
 #define IOTDATA_WIND_SPEED_MAX (6350)
 #endif
-#define IOTDATA_WIND_SPEED_BITS 7
+#define IOTDATA_WIND_SPEED_BITS     7
+#define IOTDATA_WIND_SPEED_DECIMALS 2
 #else
 #define IOTDATA_WIND_SPEED_FIELD
+#define IOTDATA_WIND_SPEED_COLUMN
 #endif
 #if defined(IOTDATA_ENABLE_WIND) || defined(IOTDATA_ENABLE_WIND_DIRECTION)
 #define IOTDATA_WIND_DIRECTION_FIELD uint16_t wind_direction;
+#define IOTDATA_WIND_DIRECTION_COLUMN \
+    uint16_t *wind_direction; \
+    uint8_t *wind_direction_valid;
 #define IOTDATA_WIND_DIRECTION_MAX   359
 #define IOTDATA_WIND_DIRECTION_BITS  8
 #else
 #define IOTDATA_WIND_DIRECTION_FIELD
+#define IOTDATA_WIND_DIRECTION_COLUMN
 #endif
 #if defined(IOTDATA_ENABLE_WIND) || defined(IOTDATA_ENABLE_WIND_GUST)
 #define IOTDATA_WIND_GUST_FIELD iotdata_float_t wind_gust;
+#define IOTDATA_WIND_GUST_COLUMN \
+    iotdata_float_t *wind_gust; \
+    uint8_t *wind_gust_valid;
 #define IOTDATA_WIND_GUST_BITS  7
 #else
 #define IOTDATA_WIND_GUST_FIELD
+#define IOTDATA_WIND_GUST_COLUMN
 #endif
 #define IOTDATA_WIND_FIELDS IOTDATA_WIND_SPEED_FIELD IOTDATA_WIND_DIRECTION_FIELD IOTDATA_WIND_GUST_FIELD
+#define IOTDATA_WIND_COLUMNS IOTDATA_WIND_SPEED_COLUMN IOTDATA_WIND_DIRECTION_COLUMN IOTDATA_WIND_GUST_COLUMN
 
 /* ---------------------------------------------------------------------------
  * Field RAIN, RAIN_RATE, RAIN_SIZE
@@ -214,20 +256,29 @@ extern "C" {
 
 #if defined(IOTDATA_ENABLE_RAIN) || defined(IOTDATA_ENABLE_RAIN_RATE)
 #define IOTDATA_RAIN_RATE_FIELD uint8_t rain_rate;
+#define IOTDATA_RAIN_RATE_COLUMN \
+    uint8_t *rain_rate; \
+    uint8_t *rain_rate_valid;
 #define IOTDATA_RAIN_RATE_MAX   255
 #define IOTDATA_RAIN_RATE_BITS  8
 #else
 #define IOTDATA_RAIN_RATE_FIELD
+#define IOTDATA_RAIN_RATE_COLUMN
 #endif
 #if defined(IOTDATA_ENABLE_RAIN) || defined(IOTDATA_ENABLE_RAIN_SIZE)
 #define IOTDATA_RAIN_SIZE_FIELD uint8_t rain_size10;
+#define IOTDATA_RAIN_SIZE_COLUMN \
+    uint8_t *rain_size10; \
+    uint8_t *rain_size_valid;
 #define IOTDATA_RAIN_SIZE_MAX   15
 #define IOTDATA_RAIN_SIZE_BITS  4
 #define IOTDATA_RAIN_SIZE_SCALE 4
 #else
 #define IOTDATA_RAIN_SIZE_FIELD
+#define IOTDATA_RAIN_SIZE_COLUMN
 #endif
 #define IOTDATA_RAIN_FIELDS IOTDATA_RAIN_RATE_FIELD IOTDATA_RAIN_SIZE_FIELD
+#define IOTDATA_RAIN_COLUMNS IOTDATA_RAIN_RATE_COLUMN IOTDATA_RAIN_SIZE_COLUMN
 
 /* ---------------------------------------------------------------------------
  * Field SOLAR, SOLAR_IRRADIATION, SOLAR_ULTRAVIOLET
@@ -237,12 +288,17 @@ extern "C" {
 #define IOTDATA_SOLAR_FIELDS \
     uint16_t solar_irradiance; \
     uint8_t solar_ultraviolet;
+#define IOTDATA_SOLAR_COLUMNS \
+    uint16_t *solar_irradiance; \
+    uint8_t *solar_ultraviolet; \
+    uint8_t *solar_valid;
 #define IOTDATA_SOLAR_IRRADIATION_MAX  1023
 #define IOTDATA_SOLAR_IRRADIATION_BITS 10
 #define IOTDATA_SOLAR_ULTRAVIOLET_MAX  15
 #define IOTDATA_SOLAR_ULTRAVIOLET_BITS 4
 #else
 #define IOTDATA_SOLAR_FIELDS
+#define IOTDATA_SOLAR_COLUMNS
 #endif
 
 /* ---------------------------------------------------------------------------
@@ -251,10 +307,14 @@ extern "C" {
 
 #if defined(IOTDATA_ENABLE_CLOUDS)
 #define IOTDATA_CLOUDS_FIELDS uint8_t clouds;
+#define IOTDATA_CLOUDS_COLUMNS \
+    uint8_t *clouds; \
+    uint8_t *clouds_valid;
 #define IOTDATA_CLOUDS_MAX    8
 #define IOTDATA_CLOUDS_BITS   4
 #else
 #define IOTDATA_CLOUDS_FIELDS
+#define IOTDATA_CLOUDS_COLUMNS
 #endif
 
 /* ---------------------------------------------------------------------------
@@ -264,10 +324,14 @@ extern "C" {
 /* --- Sub-field: AQ_INDEX (AQI 0-500, 9 bits) --- */
 #if defined(IOTDATA_ENABLE_AIR_QUALITY) || defined(IOTDATA_ENABLE_AIR_QUALITY_INDEX)
 #define IOTDATA_AIR_QUALITY_INDEX_FIELD uint16_t aq_index;
+#define IOTDATA_AIR_QUALITY_INDEX_COLUMN \
+    uint16_t *aq_index; \
+    uint8_t *aq_index_valid;
 #define IOTDATA_AIR_QUALITY_INDEX_MAX   500
 #define IOTDATA_AIR_QUALITY_INDEX_BITS  9
 #else
 #define IOTDATA_AIR_QUALITY_INDEX_FIELD
+#define IOTDATA_AIR_QUALITY_INDEX_COLUMN
 #endif
 /* --- Sub-field: AQ_PM (4 channels, presence + 8 bits each, res 5 ug/m3) --- */
 #if defined(IOTDATA_ENABLE_AIR_QUALITY) || defined(IOTDATA_ENABLE_AIR_QUALITY_PM)
@@ -275,6 +339,10 @@ extern "C" {
 #define IOTDATA_AIR_QUALITY_PM_FIELD \
     uint8_t aq_pm_present; \
     uint16_t aq_pm[IOTDATA_AIR_QUALITY_PM_COUNT];
+#define IOTDATA_AIR_QUALITY_PM_COLUMN \
+    uint8_t *aq_pm_present; \
+    uint16_t (*aq_pm)[IOTDATA_AIR_QUALITY_PM_COUNT]; \
+    uint8_t *aq_pm_valid;
 #define IOTDATA_AIR_QUALITY_PM_PRESENT_BITS 4
 #define IOTDATA_AIR_QUALITY_PM_VALUE_BITS   8
 #define IOTDATA_AIR_QUALITY_PM_VALUE_RES    5
@@ -286,6 +354,7 @@ extern "C" {
 #define IOTDATA_AIR_QUALITY_PM_INDEX_PM10   3
 #else
 #define IOTDATA_AIR_QUALITY_PM_FIELD
+#define IOTDATA_AIR_QUALITY_PM_COLUMN
 #endif
 /* --- Sub-field: AQ_GAS (8 slots, presence + variable bits per slot) --- */
 #if defined(IOTDATA_ENABLE_AIR_QUALITY) || defined(IOTDATA_ENABLE_AIR_QUALITY_GAS)
@@ -293,6 +362,10 @@ extern "C" {
 #define IOTDATA_AIR_QUALITY_GAS_FIELD \
     uint8_t aq_gas_present; \
     uint16_t aq_gas[IOTDATA_AIR_QUALITY_GAS_COUNT];
+#define IOTDATA_AIR_QUALITY_GAS_COLUMN \
+    uint8_t *aq_gas_present; \
+    uint16_t (*aq_gas)[IOTDATA_AIR_QUALITY_GAS_COUNT]; \
+    uint8_t *aq_gas_valid;
 #define IOTDATA_AIR_QUALITY_GAS_PRESENT_BITS 8
 #define IOTDATA_AIR_QUALITY_GAS_INDEX_VOC    0
 #define IOTDATA_AIR_QUALITY_GAS_INDEX_NOX    1
@@ -331,8 +404,10 @@ extern "C" {
 #define IOTDATA_AIR_QUALITY_GAS_MAX_RSVD7    1023
 #else
 #define IOTDATA_AIR_QUALITY_GAS_FIELD
+#define IOTDATA_AIR_QUALITY_GAS_COLUMN
 #endif
 #define IOTDATA_AIR_QUALITY_FIELDS IOTDATA_AIR_QUALITY_INDEX_FIELD IOTDATA_AIR_QUALITY_PM_FIELD IOTDATA_AIR_QUALITY_GAS_FIELD
+#define IOTDATA_AIR_QUALITY_COLUMNS IOTDATA_AIR_QUALITY_INDEX_COLUMN IOTDATA_AIR_QUALITY_PM_COLUMN IOTDATA_AIR_QUALITY_GAS_COLUMN
 
 /* ---------------------------------------------------------------------------
  * Field RADIATION, RADIATION_CPM, RADIATION_DOSE
@@ -340,13 +415,20 @@ extern "C" {
 
 #if defined(IOTDATA_ENABLE_RADIATION) || defined(IOTDATA_ENABLE_RADIATION_CPM)
 #define IOTDATA_RADIATION_CPM_FIELD uint16_t radiation_cpm;
+#define IOTDATA_RADIATION_CPM_COLUMN \
+    uint16_t *radiation_cpm; \
+    uint8_t *radiation_cpm_valid;
 #define IOTDATA_RADIATION_CPM_MAX   16383
 #define IOTDATA_RADIATION_CPM_BITS  14
 #else
 #define IOTDATA_RADIATION_CPM_FIELD
+#define IOTDATA_RADIATION_CPM_COLUMN
 #endif
 #if defined(IOTDATA_ENABLE_RADIATION) || defined(IOTDATA_ENABLE_RADIATION_DOSE)
 #define IOTDATA_RADIATION_DOSE_FIELD iotdata_float_t radiation_dose;
+#define IOTDATA_RADIATION_DOSE_COLUMN \
+    iotdata_float_t *radiation_dose; \
+    uint8_t *radiation_dose_valid;
 #if !defined(IOTDATA_NO_FLOATING)
 #define IOTDATA_RADIATION_DOSE_MAX_RAW 16383
 #define IOTDATA_RADIATION_DOSE_RES     (0.01f)
@@ -354,11 +436,14 @@ extern "C" {
 #else
 #define IOTDATA_RADIATION_DOSE_MAX 16383
 #endif
-#define IOTDATA_RADIATION_DOSE_BITS 14
+#define IOTDATA_RADIATION_DOSE_BITS     14
+#define IOTDATA_RADIATION_DOSE_DECIMALS 2
 #else
 #define IOTDATA_RADIATION_DOSE_FIELD
+#define IOTDATA_RADIATION_DOSE_COLUMN
 #endif
 #define IOTDATA_RADIATION_FIELDS IOTDATA_RADIATION_CPM_FIELD IOTDATA_RADIATION_DOSE_FIELD
+#define IOTDATA_RADIATION_COLUMNS IOTDATA_RADIATION_CPM_COLUMN IOTDATA_RADIATION_DOSE_COLUMN
 
 /* ---------------------------------------------------------------------------
  * Field DEPTH
@@ -366,10 +451,14 @@ extern "C" {
 
 #if defined(IOTDATA_ENABLE_DEPTH)
 #define IOTDATA_DEPTH_FIELDS uint16_t depth;
+#define IOTDATA_DEPTH_COLUMNS \
+    uint16_t *depth; \
+    uint8_t *depth_valid;
 #define IOTDATA_DEPTH_MAX    1023
 #define IOTDATA_DEPTH_BITS   10
 #else
 #define IOTDATA_DEPTH_FIELDS
+#define IOTDATA_DEPTH_COLUMNS
 #endif
 
 /* ---------------------------------------------------------------------------
@@ -388,6 +477,10 @@ extern "C" {
 #define IOTDATA_POSITION_FIELDS \
     iotdata_double_t position_lat; \
     iotdata_double_t position_lon;
+#define IOTDATA_POSITION_COLUMNS \
+    iotdata_double_t *position_lat; \
+    iotdata_double_t *position_lon; \
+    uint8_t *position_valid;
 #if !defined(IOTDATA_NO_FLOATING)
 #define IOTDATA_POS_LAT_LOW  (-90.0)
 #define IOTDATA_POS_LAT_HIGH (90.0)
@@ -403,8 +496,10 @@ extern "C" {
 #define IOTDATA_POS_LON_BITS 24
 #define IOTDATA_POS_SCALE    16777215 /* (1 << 24) - 1 */
 #define IOTDATA_POS_BITS     (IOTDATA_POS_LAT_BITS + IOTDATA_POS_LON_BITS)
+#define IOTDATA_POS_DECIMALS 7 /* finer than POS_SCALE, so values re-encode to the same raw */
 #else
 #define IOTDATA_POSITION_FIELDS
+#define IOTDATA_POSITION_COLUMNS
 #endif
 
 /* ---------------------------------------------------------------------------
@@ -413,11 +508,15 @@ extern "C" {
 
 #if defined(IOTDATA_ENABLE_DATETIME)
 #define IOTDATA_DATETIME_FIELDS uint32_t datetime_secs;
+#define IOTDATA_DATETIME_COLUMNS \
+    uint32_t *datetime_secs; \
+    uint8_t *datetime_valid;
 #define IOTDATA_DATETIME_BITS   24
 #define IOTDATA_DATETIME_RES    5
 #define IOTDATA_DATETIME_MAX    ((1 << IOTDATA_DATETIME_BITS) - 1)
 #else
 #define IOTDATA_DATETIME_FIELDS
+#define IOTDATA_DATETIME_COLUMNS
 #endif
 
 /* ---------------------------------------------------------------------------
@@ -426,9 +525,13 @@ extern "C" {
 
 #if defined(IOTDATA_ENABLE_FLAGS)
 #define IOTDATA_FLAGS_FIELDS uint8_t flags;
+#define IOTDATA_FLAGS_COLUMNS \
+    uint8_t *flags; \
+    uint8_t *flags_valid;
 #define IOTDATA_FLAGS_BITS   8
 #else
 #define IOTDATA_FLAGS_FIELDS
+#define IOTDATA_FLAGS_COLUMNS
 #endif
 
 /* ---------------------------------------------------------------------------
@@ -453,6 +556,13 @@ extern "C" {
 /* Heatshrink fixed parameters */
 #define IOTDATA_IMAGE_HS_WINDOW_SZ2    8 /* 256-byte window */
 #define IOTDATA_IMAGE_HS_LOOKAHEAD_SZ2 4 /* 16-byte lookahead */
+/* Heatshrink compressor parsing */
+#define IOTDATA_IMAGE_HS_PARSE_GREEDY  0 /* longest match at each position */
+#define IOTDATA_IMAGE_HS_PARSE_LAZY    1 /* literal first when the next position matches 2+ bytes longer */
+#define IOTDATA_IMAGE_HS_PARSE_OPTIMAL 2 /* fewest bits over the matches found, ~5x the time of greedy */
+#if !defined(IOTDATA_IMAGE_HS_CHAIN_MAX)
+#define IOTDATA_IMAGE_HS_CHAIN_MAX 64 /* match candidates examined per position */
+#endif
 #if !defined(IOTDATA_NO_ENCODE)
 #define IOTDATA_IMAGE_FIELDS_ENCODE \
     uint8_t image_pixel_format; \
@@ -465,28 +575,33 @@ typedef struct {
     union {
         uint8_t data[IOTDATA_IMAGE_DATA_MAX];
     };
+    char b64[((IOTDATA_IMAGE_DATA_MAX + 2) / 3) * 4 + 1];
 } iotdata_encode_to_json_scratch_image_t;
 #else
 #define IOTDATA_IMAGE_FIELDS_ENCODE
 #endif
 #if !defined(IOTDATA_NO_DECODE)
-#define IOTDATA_IMAGE_FIELDS_DECODE \
+#define IOTDATA_IMAGE_FIELDS_VIEW \
     uint8_t image_pixel_format; \
     uint8_t image_size_tier; \
     uint8_t image_compression; \
     uint8_t image_flags; \
-    uint8_t image_data[IOTDATA_IMAGE_DATA_MAX]; \
-    uint8_t image_data_len;
+    uint8_t image_data_len; \
+    uint16_t image_data_offset; /* bit offset of the pixel data in the packet */
+#define IOTDATA_IMAGE_FIELDS_DECODE \
+    uint8_t image_data[IOTDATA_IMAGE_DATA_MAX];
 typedef struct {
     union {
         char b64[((IOTDATA_IMAGE_DATA_MAX + 2) / 3) * 4 + 1];
     };
 } iotdata_decode_to_json_scratch_image_t;
 #else
+#define IOTDATA_IMAGE_FIELDS_VIEW
 #define IOTDATA_IMAGE_FIELDS_DECODE
 #endif
 #else
 #define IOTDATA_IMAGE_FIELDS_ENCODE
+#define IOTDATA_IMAGE_FIELDS_VIEW
 #define IOTDATA_IMAGE_FIELDS_DECODE
 #endif
 
@@ -511,6 +626,7 @@ typedef struct {
         uint8_t raw[IOTDATA_TLV_MAX][IOTDATA_TLV_DATA_MAX];
         char str[IOTDATA_TLV_MAX][IOTDATA_TLV_STR_LEN_MAX + 1];
     };
+    char b64[((IOTDATA_TLV_DATA_MAX + 2) / 3) * 4 + 1];
 } iotdata_encode_from_json_scratch_tlv_t;
 #define IOTDATA_TLV_FIELDS_ENCODE \
     uint8_t tlv_count; \
@@ -528,16 +644,25 @@ typedef struct {
         char str[IOTDATA_TLV_STR_LEN_MAX + 1];
     };
 } iotdata_decoded_tlv_t;
+typedef struct {
+    uint8_t format;
+    uint8_t type;
+    uint8_t length;
+    uint16_t offset; /* bit offset of the data in the packet */
+} iotdata_decoded_tlv_view_t;
 typedef struct {
     union {
         char b64[((IOTDATA_TLV_DATA_MAX + 2) / 3) * 4 + 1];
         char str[IOTDATA_TLV_STR_LEN_MAX + 1];
     };
 } iotdata_decode_to_json_scratch_tlv_t;
-#define IOTDATA_TLV_FIELDS_DECODE \
+#define IOTDATA_TLV_FIELDS_VIEW \
     uint8_t tlv_count; \
+    iotdata_decoded_tlv_view_t tlv_view[IOTDATA_TLV_MAX];
+#define IOTDATA_TLV_FIELDS_DECODE \
     iotdata_decoded_tlv_t tlv[IOTDATA_TLV_MAX];
 #else
+#define IOTDATA_TLV_FIELDS_VIEW
 #define IOTDATA_TLV_FIELDS_DECODE
 #endif
 #define IOTDATA_TLV_FMT_BITS    1
@@ -551,6 +676,7 @@ typedef struct {
 #define IOTDATA_TLV_CHAR_BITS   6
 #else
 #define IOTDATA_TLV_FIELDS_ENCODE
+#define IOTDATA_TLV_FIELDS_VIEW
 #define IOTDATA_TLV_FIELDS_DECODE
 #endif
 
@@ -757,6 +883,9 @@ typedef enum {
     IOTDATA_ERR_CTX_ALREADY_BEGUN,
     IOTDATA_ERR_CTX_ALREADY_ENDED,
     IOTDATA_ERR_CTX_DUPLICATE_FIELD,
+#if defined(IOTDATA_ENCODE_STREAMING)
+    IOTDATA_ERR_CTX_FIELD_ORDER,
+#endif
     IOTDATA_ERR_BUF_NULL,
     IOTDATA_ERR_BUF_OVERFLOW,
     IOTDATA_ERR_BUF_TOO_SMALL,
@@ -769,6 +898,8 @@ typedef enum {
     IOTDATA_ERR_DECODE_SHORT,
     IOTDATA_ERR_DECODE_TRUNCATED,
     IOTDATA_ERR_DECODE_VARIANT,
+    IOTDATA_ERR_DECODE_COLUMNS_FULL,
+    IOTDATA_ERR_DECODE_VIEW_ABSENT,
 #elif !defined(IOTDATA_NO_DUMP)
     IOTDATA_ERR_DECODE_SHORT,
     IOTDATA_ERR_DECODE_TRUNCATED,
@@ -785,6 +916,7 @@ typedef enum {
 #if !defined(IOTDATA_NO_JSON)
     IOTDATA_ERR_JSON_PARSE,
     IOTDATA_ERR_JSON_ALLOC,
+    IOTDATA_ERR_JSON_OVERFLOW,
     IOTDATA_ERR_JSON_MISSING_FIELD,
 #endif
 
@@ -911,12 +1043,20 @@ typedef uint32_t iotdata_field_t;
  * -------------------------------------------------------------------------*/
 
 #if !defined(IOTDATA_NO_ENCODE)
+#if defined(IOTDATA_ENCODE_STREAMING)
+/* One member of the field union; the leading byte keeps it non-empty when the field is compiled out */
+#define _IOTDATA_ENCODE_STREAMING_FIELDS(name, fields) \
+    struct { \
+        uint8_t _##name; \
+        fields \
+    };
+#endif
 typedef struct {
     uint8_t *buf;
     size_t buf_size;
     iotdata_state_t state;
 
-    size_t packed_bits;
+    size_t packed_bits; /* streaming: the write cursor until end */
     size_t packed_bytes;
 
     uint8_t variant;
@@ -924,6 +1064,7 @@ typedef struct {
     uint16_t sequence;
     iotdata_field_t fields;
 
+#if !defined(IOTDATA_ENCODE_STREAMING)
     IOTDATA_BATTERY_FIELDS
     IOTDATA_LINK_FIELDS
     IOTDATA_ENVIRONMENT_FIELDS
@@ -938,6 +1079,26 @@ typedef struct {
     IOTDATA_DATETIME_FIELDS
     IOTDATA_IMAGE_FIELDS_ENCODE
     IOTDATA_FLAGS_FIELDS
+#else
+    const iotdata_variant_def_t *vdef; /* resolved at begin */
+    uint8_t slot_next;                 /* slot after the last field packed */
+    union {            /* each field is packed as it is added, so only one is held at a time */
+        _IOTDATA_ENCODE_STREAMING_FIELDS(battery, IOTDATA_BATTERY_FIELDS)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(link, IOTDATA_LINK_FIELDS)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(environment, IOTDATA_ENVIRONMENT_FIELDS)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(wind, IOTDATA_WIND_FIELDS)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(rain, IOTDATA_RAIN_FIELDS)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(solar, IOTDATA_SOLAR_FIELDS)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(clouds, IOTDATA_CLOUDS_FIELDS)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(air_quality, IOTDATA_AIR_QUALITY_FIELDS)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(radiation, IOTDATA_RADIATION_FIELDS)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(depth, IOTDATA_DEPTH_FIELDS)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(position, IOTDATA_POSITION_FIELDS)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(datetime, IOTDATA_DATETIME_FIELDS)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(image, IOTDATA_IMAGE_FIELDS_ENCODE)
+        _IOTDATA_ENCODE_STREAMING_FIELDS(flags, IOTDATA_FLAGS_FIELDS)
+    };
+#endif
 
     IOTDATA_TLV_FIELDS_ENCODE
 } iotdata_encoder_t;
@@ -948,31 +1109,50 @@ typedef struct {
  * -------------------------------------------------------------------------*/
 
 #if !defined(IOTDATA_NO_DECODE)
-typedef struct {
-    size_t packed_bits;
-    size_t packed_bytes;
-
-    uint8_t variant;
-    uint16_t station;
-    uint16_t sequence;
-    iotdata_field_t fields;
+#define _IOTDATA_DECODED_VIEW_FIELDS \
+    size_t packed_bits; \
+    size_t packed_bytes; \
+\
+    uint8_t variant; \
+    uint16_t station; \
+    uint16_t sequence; \
+    iotdata_field_t fields; \
+\
+    IOTDATA_BATTERY_FIELDS \
+    IOTDATA_LINK_FIELDS \
+    IOTDATA_ENVIRONMENT_FIELDS \
+    IOTDATA_WIND_FIELDS \
+    IOTDATA_RAIN_FIELDS \
+    IOTDATA_SOLAR_FIELDS \
+    IOTDATA_CLOUDS_FIELDS \
+    IOTDATA_AIR_QUALITY_FIELDS \
+    IOTDATA_RADIATION_FIELDS \
+    IOTDATA_DEPTH_FIELDS \
+    IOTDATA_POSITION_FIELDS \
+    IOTDATA_DATETIME_FIELDS \
+    IOTDATA_IMAGE_FIELDS_VIEW \
+    IOTDATA_FLAGS_FIELDS \
+\
+    IOTDATA_TLV_FIELDS_VIEW
 
-    IOTDATA_BATTERY_FIELDS
-    IOTDATA_LINK_FIELDS
-    IOTDATA_ENVIRONMENT_FIELDS
-    IOTDATA_WIND_FIELDS
-    IOTDATA_RAIN_FIELDS
-    IOTDATA_SOLAR_FIELDS
-    IOTDATA_CLOUDS_FIELDS
-    IOTDATA_AIR_QUALITY_FIELDS
-    IOTDATA_RADIATION_FIELDS
-    IOTDATA_DEPTH_FIELDS
-    IOTDATA_POSITION_FIELDS
-    IOTDATA_DATETIME_FIELDS
-    IOTDATA_IMAGE_FIELDS_DECODE
-    IOTDATA_FLAGS_FIELDS
-
-    IOTDATA_TLV_FIELDS_DECODE
+/*
+ * Decoded view: every field except the image and TLV payloads, which are
+ * left in the packet and located by bit offset (image_data_offset,
+ * tlv_view[]). Copy them out on demand with iotdata_view_image() and
+ * iotdata_view_tlv() while the packet buffer is still held.
+ */
+typedef struct {
+    _IOTDATA_DECODED_VIEW_FIELDS
+} iotdata_decoded_view_t;
+
+/* Fully decoded: the view plus the payloads copied out (view aliases the leading members) */
+typedef union {
+    struct {
+        _IOTDATA_DECODED_VIEW_FIELDS
+        IOTDATA_IMAGE_FIELDS_DECODE
+        IOTDATA_TLV_FIELDS_DECODE
+    };
+    iotdata_decoded_view_t view;
 } iotdata_decoded_t;
 #endif /* !IOTDATA_NO_DECODE */
 
@@ -984,11 +1164,12 @@ typedef struct {
 size_t iotdata_image_pixel_count(uint8_t size_tier);
 uint8_t iotdata_image_bpp(uint8_t pixel_format);
 size_t iotdata_image_bytes(uint8_t pixel_format, uint8_t size_tier);
-/* RLE: returns output bytes written, 0 on error */
+/* RLE: returns output bytes written (or that would be, when out is NULL), 0 on error or past out_max */
 size_t iotdata_image_rle_compress(const uint8_t *pixels, size_t pixel_count, uint8_t bpp, uint8_t *out, size_t out_max);
 size_t iotdata_image_rle_decompress(const uint8_t *compressed, size_t comp_len, uint8_t bpp, uint8_t *pixels, size_t pixel_buf_bytes);
-/* Heatshrink LZSS (w=8, l=4): returns output bytes written, 0 on error */
+/* Heatshrink LZSS (w=8, l=4): returns output bytes written (or that would be, when out is NULL), 0 on error or past out_max */
 size_t iotdata_image_hs_compress(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_max);
+size_t iotdata_image_hs_compress_parse(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_max, uint8_t parse);
 size_t iotdata_image_hs_decompress(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_max);
 #endif
 
@@ -1127,6 +1308,12 @@ iotdata_status_t iotdata_encode_datetime(iotdata_encoder_t *enc, uint32_t second
 #endif
 #if defined(IOTDATA_ENABLE_IMAGE)
 iotdata_status_t iotdata_encode_image(iotdata_encoder_t *enc, uint8_t pixel_format, uint8_t size_tier, uint8_t compression, uint8_t flags, const uint8_t *data, uint8_t data_len);
+typedef struct { /* the encoder holds the image data by reference until the end */
+    uint8_t data[IOTDATA_IMAGE_DATA_MAX];
+    uint8_t pixels[(48 * 36 * 4) / 8]; /* largest tier stepped down to, GREY16 48x36 */
+} iotdata_image_encode_best_scratch_t;
+/* Encodes packed pixels at size_tier with the smallest of raw, RLE and heatshrink (hs_parse) that fits the room left in the buffer, stepping down size_tier (nearest-pixel) if none does; add other fields first */
+iotdata_status_t iotdata_image_encode_best(iotdata_encoder_t *enc, uint8_t pixel_format, uint8_t size_tier, uint8_t flags, const uint8_t *pixels, uint8_t hs_parse, iotdata_image_encode_best_scratch_t *scratch);
 #endif
 #if defined(IOTDATA_ENABLE_FLAGS)
 iotdata_status_t iotdata_encode_flags(iotdata_encoder_t *enc, uint8_t flags);
@@ -1140,6 +1327,54 @@ iotdata_status_t iotdata_encode_flags(iotdata_encoder_t *enc, uint8_t flags);
 #if !defined(IOTDATA_NO_DECODE)
 iotdata_status_t iotdata_peek(const uint8_t *buf, size_t len, uint8_t *variant, uint16_t *station, uint16_t *sequence);
 iotdata_status_t iotdata_decode(const uint8_t *buf, size_t len, iotdata_decoded_t *out);
+/* Decode without copying out image or TLV payloads; the view refers into buf */
+iotdata_status_t iotdata_decode_view(const uint8_t *buf, size_t len, iotdata_decoded_view_t *out);
+#if defined(IOTDATA_ENABLE_IMAGE)
+/* Copy the image pixel data (image_data_len bytes) of a view out of the buf it was decoded from */
+iotdata_status_t iotdata_view_image(const iotdata_decoded_view_t *view, const uint8_t *buf, uint8_t data[IOTDATA_IMAGE_DATA_MAX]);
+#endif
+#if defined(IOTDATA_ENABLE_TLV)
+/* Materialise TLV entry index of a view from the buf it was decoded from */
+iotdata_status_t iotdata_view_tlv(const iotdata_decoded_view_t *view, const uint8_t *buf, uint8_t index, iotdata_decoded_tlv_t *tlv);
+#endif
+/* Decode n packets into out[0..n-1], per-packet status into rc[] (optional); returns count decoded OK */
+size_t iotdata_decode_many(const uint8_t *const *bufs, const size_t *lens, size_t n, iotdata_decoded_t *out, iotdata_status_t *rc);
+
+/*
+ * Columnar (struct-of-arrays) output: caller-owned column buffers, each with
+ * room for capacity rows. Register only the columns wanted; NULL columns are
+ * skipped. Each packet decoded appends row count: values are as in
+ * iotdata_decoded_t, and where the packet lacks the field the value is 0 and
+ * the bit is clear in the field's _valid bitmap (bit row % 8 of byte row / 8,
+ * so (capacity + 7) / 8 bytes). Image and TLV data are not output.
+ */
+typedef struct {
+    size_t capacity;
+    size_t count;
+
+    uint8_t *variant;
+    uint16_t *station;
+    uint16_t *sequence;
+
+    IOTDATA_BATTERY_COLUMNS
+    IOTDATA_LINK_COLUMNS
+    IOTDATA_ENVIRONMENT_COLUMNS
+    IOTDATA_WIND_COLUMNS
+    IOTDATA_RAIN_COLUMNS
+    IOTDATA_SOLAR_COLUMNS
+    IOTDATA_CLOUDS_COLUMNS
+    IOTDATA_AIR_QUALITY_COLUMNS
+    IOTDATA_RADIATION_COLUMNS
+    IOTDATA_DEPTH_COLUMNS
+    IOTDATA_POSITION_COLUMNS
+    IOTDATA_DATETIME_COLUMNS
+    IOTDATA_FLAGS_COLUMNS
+} iotdata_columns_t;
+typedef struct {
+    iotdata_decoded_view_t view;
+} iotdata_decode_columns_scratch_t;
+/* Decode n packets, appending a row to cols for each decoded OK, per-packet status into rc[] (optional); returns rows appended */
+size_t iotdata_decode_columns(const uint8_t *const *bufs, const size_t *lens, size_t n, iotdata_columns_t *cols, iotdata_status_t *rc, iotdata_decode_columns_scratch_t *scratch);
 #endif /* !IOTDATA_NO_DECODE */
 
 /* ---------------------------------------------------------------------------
@@ -1200,11 +1435,13 @@ typedef struct {
     };
 } iotdata_decode_to_json_scratch_t;
 iotdata_status_t iotdata_decode_to_json(const uint8_t *buf, size_t len, char **json_out, iotdata_decode_to_json_scratch_t *scratch);
+/* Allocation-free: writes NUL-terminated JSON into out; *out_len receives the length required (excluding NUL) even on overflow */
+iotdata_status_t iotdata_decode_to_json_buffer(const uint8_t *buf, size_t len, char *out, size_t out_size, size_t *out_len, iotdata_decode_to_json_scratch_t *scratch);
 #endif /* !IOTDATA_NO_DECODE */
 #if !defined(IOTDATA_NO_ENCODE)
 typedef struct {
     iotdata_encoder_t enc;
-    union {
+    struct { /* not a union: the encoder holds image and TLV data by reference until the end */
         bool _dummy;
 #if defined(IOTDATA_ENABLE_IMAGE)
         iotdata_encode_to_json_scratch_image_t image;
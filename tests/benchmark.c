@@ -0,0 +1,924 @@
+/*
+ * IoT Sensor Telemetry Protocol
+ * Copyright(C) 2026 Matthew Gream (https://libiotdata.org)
+ *
+ * benchmark.c - microbenchmarks for internal hot paths
+ *
+ * Includes iotdata.c directly so that static internals can be measured
+ * against the reference (previous) implementations they replaced.  Each
+ * benchmark first verifies that both implementations produce identical
+ * output over a randomised workload, then reports timings.
+ *
+ * Not part of the test suites: timings depend on the host and build flags.
+ */
+
+#include "iotdata.c"
+
+#include <stdlib.h>
+#include <time.h>
+
+/* ---------------------------------------------------------------------------
+ * Timing helpers
+ * -------------------------------------------------------------------------*/
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint32_t rng_state = 0x12345678U;
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static volatile uint32_t bench_sink;
+static int bench_failures = 0;
+
+static void report(const char *name, double reference, double current, size_t ops) {
+    printf("  %-40s ref %8.2f ns/op   new %8.2f ns/op   x%.2f\n", name, reference * 1e9 / (double)ops, current * 1e9 / (double)ops, current > 0 ? reference / current : 0.0);
+}
+
+/* ---------------------------------------------------------------------------
+ * Bit-packing: byte-at-a-time reference
+ * -------------------------------------------------------------------------*/
+
+static bool bits_write_ref(uint8_t *buf, size_t buf_bits, size_t *bp, uint32_t value, uint8_t nbits) {
+    if (*bp + nbits > buf_bits)
+        return false;
+    size_t pos = *bp;
+    int rem = nbits, off = pos & 7;
+    if (off) {
+        const int n = rem < (8 - off) ? rem : (8 - off);
+        buf[pos >> 3] = (buf[pos >> 3] & ~(uint8_t)(((1U << n) - 1) << ((8 - off) - n))) | (uint8_t)(((value >> (rem - n)) & ((1U << n) - 1)) << ((8 - off) - n));
+        pos += (size_t)n;
+        rem -= n;
+    }
+    while (rem >= 8) {
+        rem -= 8;
+        buf[pos >> 3] = (uint8_t)(value >> rem);
+        pos += 8;
+    }
+    if (rem > 0) {
+        buf[pos >> 3] = (buf[pos >> 3] & ~(uint8_t)(((1U << rem) - 1) << (8 - rem))) | (uint8_t)((value & ((1U << rem) - 1)) << (8 - rem));
+        pos += (size_t)rem;
+    }
+    *bp = pos;
+    return true;
+}
+
+static uint32_t bits_read_ref(const uint8_t *buf, size_t buf_bits, size_t *bp, uint8_t nbits) {
+    if (*bp + nbits > buf_bits) {
+        uint32_t value = 0;
+        for (int i = nbits - 1; i >= 0 && *bp < buf_bits; i--, (*bp)++)
+            value |= ((uint32_t)((buf[*bp / 8] >> (7 - (*bp % 8))) & 1U) << i);
+        return value;
+    }
+    uint32_t value = 0;
+    size_t pos = *bp;
+    int rem = nbits, off = pos & 7;
+    if (off) {
+        const int n = rem < (8 - off) ? rem : (8 - off);
+        value = (buf[pos >> 3] >> ((8 - off) - n)) & ((1U << n) - 1);
+        pos += (size_t)n;
+        rem -= n;
+    }
+    while (rem >= 8) {
+        value = (value << 8) | buf[pos >> 3];
+        pos += 8;
+        rem -= 8;
+    }
+    if (rem > 0) {
+        value = (value << rem) | ((buf[pos >> 3] >> (8 - rem)) & ((1U << rem) - 1));
+        pos += (size_t)rem;
+    }
+    *bp = pos;
+    return value;
+}
+
+/* ---------------------------------------------------------------------------
+ * Bit-packing: verification and timing
+ * -------------------------------------------------------------------------*/
+
+#define BITS_FIELDS  64
+#define BITS_BUF     256
+#define BITS_ROUNDS  200000
+#define BITS_VERIFY  20000
+
+/* A packet-shaped workload: a run of fields of 1..32 bits at arbitrary offsets */
+static void bits_workload(uint8_t *widths, uint32_t *values, size_t *total) {
+    size_t bits = 0;
+    for (int i = 0; i < BITS_FIELDS; i++) {
+        widths[i] = (uint8_t)(1 + rng_next() % 32);
+        values[i] = rng_next() & (widths[i] == 32 ? 0xFFFFFFFFU : ((1U << widths[i]) - 1));
+        bits += widths[i];
+    }
+    *total = bits;
+}
+
+static void bench_bits_verify(void) {
+    uint8_t widths[BITS_FIELDS];
+    uint32_t values[BITS_FIELDS];
+    for (int round = 0; round < BITS_VERIFY; round++) {
+        size_t total;
+        bits_workload(widths, values, &total);
+        /* vary the buffer length so the tail path is exercised, including sub-byte ends */
+        const size_t buf_bits = total + (size_t)(rng_next() % 16) - 8;
+        uint8_t a[BITS_BUF], b[BITS_BUF];
+        const uint8_t fill = (uint8_t)rng_next();
+        memset(a, fill, sizeof(a));
+        memset(b, fill, sizeof(b));
+        size_t pa = 0, pb = 0;
+        for (int i = 0; i < BITS_FIELDS; i++) {
+            const bool ra = bits_write_ref(a, buf_bits, &pa, values[i], widths[i]), rb = bits_write(b, buf_bits, &pb, values[i], widths[i]);
+            if (ra != rb || pa != pb) {
+                printf("  bits_write mismatch: round %d field %d\n", round, i);
+                bench_failures++;
+                return;
+            }
+        }
+        if (memcmp(a, b, sizeof(a)) != 0) {
+            printf("  bits_write output mismatch: round %d\n", round);
+            bench_failures++;
+            return;
+        }
+        pa = pb = (size_t)(rng_next() % 8);
+        for (int i = 0; i < BITS_FIELDS; i++) {
+            const uint32_t va = bits_read_ref(a, buf_bits, &pa, widths[i]), vb = bits_read(b, buf_bits, &pb, widths[i]);
+            if (va != vb || pa != pb) {
+                printf("  bits_read mismatch: round %d field %d\n", round, i);
+                bench_failures++;
+                return;
+            }
+        }
+    }
+    printf("  %-40s ok (%d randomised packets)\n", "bits_write/bits_read equivalence", BITS_VERIFY);
+}
+
+static void bench_bits_timing(void) {
+    uint8_t widths[BITS_FIELDS];
+    uint32_t values[BITS_FIELDS];
+    size_t total;
+    bits_workload(widths, values, &total);
+    uint8_t buf[BITS_BUF];
+    memset(buf, 0, sizeof(buf));
+    const size_t buf_bits = sizeof(buf) * 8, ops = (size_t)BITS_ROUNDS * BITS_FIELDS;
+    uint32_t acc = 0;
+    double t0, ref, cur;
+
+    t0 = now_seconds();
+    for (int r = 0; r < BITS_ROUNDS; r++) {
+        size_t bp = (size_t)(r & 7);
+        for (int i = 0; i < BITS_FIELDS; i++)
+            acc += bits_write_ref(buf, buf_bits, &bp, values[i] ^ (uint32_t)r, widths[i]);
+    }
+    ref = now_seconds() - t0;
+    t0 = now_seconds();
+    for (int r = 0; r < BITS_ROUNDS; r++) {
+        size_t bp = (size_t)(r & 7);
+        for (int i = 0; i < BITS_FIELDS; i++)
+            acc += bits_write(buf, buf_bits, &bp, values[i] ^ (uint32_t)r, widths[i]);
+    }
+    cur = now_seconds() - t0;
+    report("bits_write", ref, cur, ops);
+
+    t0 = now_seconds();
+    for (int r = 0; r < BITS_ROUNDS; r++) {
+        size_t bp = (size_t)(r & 7);
+        for (int i = 0; i < BITS_FIELDS; i++)
+            acc += bits_read_ref(buf, buf_bits, &bp, widths[i]);
+    }
+    ref = now_seconds() - t0;
+    t0 = now_seconds();
+    for (int r = 0; r < BITS_ROUNDS; r++) {
+        size_t bp = (size_t)(r & 7);
+        for (int i = 0; i < BITS_FIELDS; i++)
+            acc += bits_read(buf, buf_bits, &bp, widths[i]);
+    }
+    cur = now_seconds() - t0;
+    report("bits_read", ref, cur, ops);
+
+    bench_sink = acc;
+}
+
+/* ---------------------------------------------------------------------------
+ * Decimal formatting: %g reference (as the JSON writer used for doubles)
+ * -------------------------------------------------------------------------*/
+
+static size_t fmt_double_ref(char *out, size_t size, double d) {
+    int n = snprintf(out, size, "%1.15g", d);
+    const double r = strtod(out, NULL), m = fabs(r) > fabs(d) ? fabs(r) : fabs(d);
+    if (!(fabs(r - d) <= m * DBL_EPSILON))
+        n = snprintf(out, size, "%1.17g", d);
+    return n > 0 ? (size_t)n : 0;
+}
+
+#define FIXED_VALUES 4096
+#define FIXED_ROUNDS 100
+
+/* Quantised temperatures and positions, as decoded */
+static void fixed_workload(double *values, int *decimals) {
+    for (int i = 0; i < FIXED_VALUES; i++)
+        if (i & 1) {
+            values[i] = dequantise_position_lat(rng_next() & IOTDATA_POS_SCALE);
+            decimals[i] = IOTDATA_POS_DECIMALS;
+        } else {
+            values[i] = dequantise_temperature(rng_next() % (1U << IOTDATA_TEMPERATURE_BITS));
+            decimals[i] = IOTDATA_TEMPERATURE_DECIMALS;
+        }
+}
+
+static void bench_fixed_verify(void) {
+    double values[FIXED_VALUES];
+    int decimals[FIXED_VALUES];
+    fixed_workload(values, decimals);
+    for (int i = 0; i < FIXED_VALUES; i++) {
+        char a[32], b[_IOTDATA_FIXED_MAX];
+        fmt_double_ref(a, sizeof(a), values[i]);
+        fmt_fixed(b, values[i], decimals[i], -1);
+        /* same value at the field's resolution, and never longer */
+        const bool temp = decimals[i] == IOTDATA_TEMPERATURE_DECIMALS;
+        const uint32_t qa = temp ? quantise_temperature((float)strtod(a, NULL)) : quantise_position_lat(strtod(a, NULL)), qb = temp ? quantise_temperature((float)strtod(b, NULL)) : quantise_position_lat(strtod(b, NULL));
+        if (qa != qb || strlen(b) > strlen(a)) {
+            printf("  fmt_fixed mismatch: %s vs %s\n", a, b);
+            bench_failures++;
+            return;
+        }
+    }
+    printf("  %-40s ok (%d quantised values)\n", "fmt_fixed equivalence", FIXED_VALUES);
+}
+
+static void bench_fixed_timing(void) {
+    double values[FIXED_VALUES];
+    int decimals[FIXED_VALUES];
+    fixed_workload(values, decimals);
+    const size_t ops = (size_t)FIXED_ROUNDS * FIXED_VALUES;
+    uint32_t acc = 0;
+    char tmp[32];
+    double t0, ref, cur;
+
+    t0 = now_seconds();
+    for (int r = 0; r < FIXED_ROUNDS; r++)
+        for (int i = 0; i < FIXED_VALUES; i++)
+            acc += (uint32_t)fmt_double_ref(tmp, sizeof(tmp), values[i]);
+    ref = now_seconds() - t0;
+    t0 = now_seconds();
+    for (int r = 0; r < FIXED_ROUNDS; r++)
+        for (int i = 0; i < FIXED_VALUES; i++)
+            acc += (uint32_t)fmt_fixed(tmp, values[i], decimals[i], -1);
+    cur = now_seconds() - t0;
+    report("fmt_fixed (JSON number)", ref, cur, ops);
+
+    bench_sink = acc;
+}
+
+/* ---------------------------------------------------------------------------
+ * Six-bit strings: if-chain conversion, one bits_write/bits_read per character
+ * -------------------------------------------------------------------------*/
+
+static int char_to_sixbit_ref(char c) {
+    if (c == ' ')
+        return 0;
+    else if (c >= 'a' && c <= 'z')
+        return 1 + (c - 'a');
+    else if (c >= '0' && c <= '9')
+        return 27 + (c - '0');
+    else if (c >= 'A' && c <= 'Z')
+        return 37 + (c - 'A');
+    else
+        return -1;
+}
+
+static char sixbit_to_char_ref(uint8_t val) {
+    if (val == 0)
+        return ' ';
+    else if (val >= 1 && val <= 26)
+        return 'a' + (char)(val - 1);
+    else if (val >= 27 && val <= 36)
+        return '0' + (char)(val - 27);
+    else if (val >= 37 && val <= 62)
+        return 'A' + (char)(val - 37);
+    else
+        return '?';
+}
+
+static bool sixbit_write_ref(uint8_t *buf, size_t bb, size_t *bp, const char *str, size_t n) {
+    for (size_t j = 0; j < n; j++)
+        if (!bits_write(buf, bb, bp, (uint32_t)char_to_sixbit_ref(str[j]), IOTDATA_TLV_CHAR_BITS))
+            return false;
+    return true;
+}
+
+static void sixbit_read_ref(const uint8_t *buf, size_t bp, char *out, size_t n) {
+    const size_t bb = bp + n * IOTDATA_TLV_CHAR_BITS;
+    for (size_t j = 0; j < n; j++)
+        out[j] = sixbit_to_char_ref((uint8_t)bits_read(buf, bb, &bp, IOTDATA_TLV_CHAR_BITS));
+}
+
+#define SIXBIT_STRINGS 64
+
+static char sixbit_strs[SIXBIT_STRINGS][IOTDATA_TLV_STR_LEN_MAX + 1];
+
+/* Diagnostic-style text over the six-bit set, with a few invalid characters for the unchecked path */
+static void sixbit_workload(void) {
+    static const char set[] = " abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    for (int i = 0; i < SIXBIT_STRINGS; i++)
+        for (int j = 0; j <= IOTDATA_TLV_STR_LEN_MAX; j++)
+            sixbit_strs[i][j] = (rng_next() % 97) == 0 ? '#' : set[rng_next() % (sizeof(set) - 1)];
+}
+
+static void bench_sixbit_verify(void) {
+    uint8_t a[224], b[224];
+    char sa[IOTDATA_TLV_STR_LEN_MAX + 1], sb[IOTDATA_TLV_STR_LEN_MAX + 1];
+    sixbit_workload();
+    int checks = 0;
+    for (int i = 0; i < SIXBIT_STRINGS; i++)
+        for (size_t off = 0; off < 8; off++)
+            for (size_t n = 0; n <= IOTDATA_TLV_STR_LEN_MAX; n += n > 32 ? 8 : 1) {
+                size_t pa = off, pb = off;
+                memset(a, 0xA5, sizeof(a));
+                memset(b, 0xA5, sizeof(b));
+                sixbit_write_ref(a, sizeof(a) * 8, &pa, sixbit_strs[i], n);
+                sixbit_write(b, sizeof(b) * 8, &pb, sixbit_strs[i], n);
+                if (pa != pb || memcmp(a, b, sizeof(a)) != 0) {
+                    printf("  sixbit_write mismatch: off=%zu n=%zu\n", off, n);
+                    bench_failures++;
+                    return;
+                }
+                sixbit_read_ref(a, off, sa, n);
+                sixbit_read(a, off, sb, n);
+                if (memcmp(sa, sb, n) != 0) {
+                    printf("  sixbit_read mismatch: off=%zu n=%zu\n", off, n);
+                    bench_failures++;
+                    return;
+                }
+                checks++;
+            }
+    printf("  %-40s ok (%d cases)\n", "sixbit_write/sixbit_read equivalence", checks);
+}
+
+static void bench_sixbit_timing(void) {
+    static uint8_t buf[224];
+    char out[IOTDATA_TLV_STR_LEN_MAX + 1];
+    const size_t n = 48, rounds = 20000;
+    const size_t ops = rounds * SIXBIT_STRINGS * n;
+    uint32_t acc = 0;
+    double t0, ref, cur;
+
+    for (size_t off = 0; off <= 2; off += 2) {
+        char name[48];
+        t0 = now_seconds();
+        for (size_t r = 0; r < rounds; r++)
+            for (int i = 0; i < SIXBIT_STRINGS; i++) {
+                size_t bp = off;
+                sixbit_write_ref(buf, sizeof(buf) * 8, &bp, sixbit_strs[i], n);
+                acc += buf[r & 31];
+            }
+        ref = now_seconds() - t0;
+        t0 = now_seconds();
+        for (size_t r = 0; r < rounds; r++)
+            for (int i = 0; i < SIXBIT_STRINGS; i++) {
+                size_t bp = off;
+                sixbit_write(buf, sizeof(buf) * 8, &bp, sixbit_strs[i], n);
+                acc += buf[r & 31];
+            }
+        cur = now_seconds() - t0;
+        snprintf(name, sizeof(name), "sixbit_write (%s, per char)", off ? "unaligned" : "aligned");
+        report(name, ref, cur, ops);
+
+        t0 = now_seconds();
+        for (size_t r = 0; r < rounds; r++)
+            for (int i = 0; i < SIXBIT_STRINGS; i++) {
+                sixbit_read_ref(buf, off, out, n);
+                acc += (uint8_t)out[r % n];
+            }
+        ref = now_seconds() - t0;
+        t0 = now_seconds();
+        for (size_t r = 0; r < rounds; r++)
+            for (int i = 0; i < SIXBIT_STRINGS; i++) {
+                sixbit_read(buf, off, out, n);
+                acc += (uint8_t)out[r % n];
+            }
+        cur = now_seconds() - t0;
+        snprintf(name, sizeof(name), "sixbit_read (%s, per char)", off ? "unaligned" : "aligned");
+        report(name, ref, cur, ops);
+    }
+    bench_sink = acc;
+}
+
+/* ---------------------------------------------------------------------------
+ * Heatshrink: brute-force window search as the reference
+ * -------------------------------------------------------------------------*/
+
+static size_t hs_compress_ref(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_max) {
+    if (!in || !out || in_len == 0 || out_max == 0)
+        return 0;
+    _hs_bw_t bw;
+    _hs_bw_init(&bw, out, out_max);
+    size_t ip = 0;
+    while (ip < in_len && !bw.overflow) {
+        size_t best_len = 0, best_off = 0;
+        const size_t max_match = (in_len - ip) < _HS_L ? (in_len - ip) : _HS_L;
+        for (size_t off = ip > _HS_W ? ip - _HS_W : 0; off < ip; off++) {
+            size_t ml = 0;
+            while (ml < max_match && in[off + ml] == in[ip + ml])
+                ml++;
+            if (ml > best_len) {
+                best_len = ml;
+                best_off = ip - off;
+                if (ml == max_match)
+                    break;
+            }
+        }
+        if (best_len >= 2) {
+            _hs_bw_put(&bw, 1, 1);
+            _hs_bw_put(&bw, (uint32_t)(best_off - 1), _HS_W_BITS);
+            _hs_bw_put(&bw, (uint32_t)(best_len - 1), _HS_L_BITS);
+            ip += best_len;
+        } else {
+            _hs_bw_put(&bw, 0, 1);
+            _hs_bw_put(&bw, in[ip], 8);
+            ip++;
+        }
+    }
+    return bw.overflow ? 0 : _hs_bw_bytes(&bw);
+}
+
+#define HS_FRAMES      4
+#define HS_FRAME_BYTES (64 * 48 / 2)
+#define HS_ROUNDS      20
+
+static uint8_t hs_frames[HS_FRAMES][HS_FRAME_BYTES];
+static const char *const hs_frame_names[HS_FRAMES] = { "gradient+noise", "sky+horizon", "objects", "thermal" };
+
+/* 64x48 GREY16 frames: the content a thermal or low-resolution camera node sends */
+static void hs_workload(void) {
+    for (int f = 0; f < HS_FRAMES; f++) {
+        memset(hs_frames[f], 0, HS_FRAME_BYTES);
+        for (int y = 0; y < 48; y++)
+            for (int x = 0; x < 64; x++) {
+                int v;
+                if (f == 0)
+                    v = (x + y) / 7 + (int)(rng_next() % 3) - 1;
+                else if (f == 1)
+                    v = y < 20 ? 13 + (int)(rng_next() % 8 == 0) : y < 22 ? 8 : 3 + (int)(rng_next() % 4 == 0) + ((x / 8 + y / 6) & 1);
+                else if (f == 2)
+                    v = ((x - 20) * (x - 20) + (y - 24) * (y - 24) < 100) ? 12 : (x > 40 && x < 56 && y > 10 && y < 40) ? 6 : 2;
+                else
+                    v = 4 + (((x - 32) * (x - 32) + (y - 30) * (y - 30) < 180) ? 6 + (int)(rng_next() % 3) : (int)(rng_next() % 2));
+                v = v < 0 ? 0 : v > 15 ? 15 : v;
+                _pixel_set(hs_frames[f], (size_t)(y * 64 + x), (uint8_t)v, 4);
+            }
+    }
+}
+
+static void bench_hs(void) {
+    static const char *const parse_names[3] = { "hs_compress greedy (per frame)", "hs_compress lazy (per frame)", "hs_compress optimal (per frame)" };
+    static uint8_t comp[HS_FRAME_BYTES * 2], back[HS_FRAME_BYTES];
+    hs_workload();
+
+    size_t total_ref = 0, total[3] = { 0, 0, 0 };
+    for (int f = 0; f < HS_FRAMES; f++) {
+        const size_t r = hs_compress_ref(hs_frames[f], HS_FRAME_BYTES, comp, sizeof(comp));
+        size_t n[3];
+        for (uint8_t parse = 0; parse < 3; parse++) {
+            n[parse] = iotdata_image_hs_compress_parse(hs_frames[f], HS_FRAME_BYTES, comp, sizeof(comp), parse);
+            if (n[parse] == 0 || iotdata_image_hs_decompress(comp, n[parse], back, sizeof(back)) != HS_FRAME_BYTES || memcmp(back, hs_frames[f], HS_FRAME_BYTES) != 0) {
+                printf("  hs round-trip failed: frame %s parse %d\n", hs_frame_names[f], parse);
+                bench_failures++;
+                return;
+            }
+            total[parse] += n[parse];
+        }
+        total_ref += r;
+        printf("  %-40s %4zu -> brute %4zu, greedy %4zu, lazy %4zu, optimal %4zu bytes\n", hs_frame_names[f], (size_t)HS_FRAME_BYTES, r, n[0], n[1], n[2]);
+    }
+    printf("  %-40s brute %zu, greedy %zu, lazy %zu, optimal %zu bytes\n", "total compressed", total_ref, total[0], total[1], total[2]);
+
+    const size_t ops = (size_t)HS_ROUNDS * HS_FRAMES;
+    uint32_t acc = 0;
+    double t0, ref, cur;
+    t0 = now_seconds();
+    for (int r = 0; r < HS_ROUNDS; r++)
+        for (int f = 0; f < HS_FRAMES; f++)
+            acc += (uint32_t)hs_compress_ref(hs_frames[f], HS_FRAME_BYTES, comp, sizeof(comp));
+    ref = now_seconds() - t0;
+    for (uint8_t parse = 0; parse < 3; parse++) {
+        t0 = now_seconds();
+        for (int r = 0; r < HS_ROUNDS; r++)
+            for (int f = 0; f < HS_FRAMES; f++)
+                acc += (uint32_t)iotdata_image_hs_compress_parse(hs_frames[f], HS_FRAME_BYTES, comp, sizeof(comp), parse);
+        cur = now_seconds() - t0;
+        report(parse_names[parse], ref, cur, ops);
+    }
+    bench_sink = acc;
+}
+
+/* ---------------------------------------------------------------------------
+ * RLE: per-pixel get/set as the reference
+ * -------------------------------------------------------------------------*/
+
+static size_t rle_compress_ref(const uint8_t *pixels, size_t pixel_count, uint8_t bpp, uint8_t *out, size_t out_max) {
+    const size_t run_max = bpp == 1 ? 128 : 256;
+    size_t op = 0;
+    uint8_t cur = _pixel_get(pixels, 0, bpp);
+    size_t count = 1;
+    for (size_t i = 1; i <= pixel_count; i++) {
+        const uint8_t px = i < pixel_count ? _pixel_get(pixels, i, bpp) : 0;
+        if (i < pixel_count && px == cur && count < run_max)
+            count++;
+        else {
+            if (op + (bpp == 1 ? 1 : 2) > out_max)
+                return 0;
+            if (bpp == 1)
+                out[op++] = (uint8_t)((cur << 7) | (count - 1));
+            else {
+                out[op++] = cur;
+                out[op++] = (uint8_t)(count - 1);
+            }
+            cur = px;
+            count = 1;
+        }
+    }
+    return op;
+}
+
+static size_t rle_decompress_ref(const uint8_t *compressed, size_t comp_len, uint8_t bpp, uint8_t *pixels, size_t pixel_buf_bytes) {
+    const size_t px_max = (pixel_buf_bytes * 8) / bpp;
+    size_t px_idx = 0;
+    for (size_t ip = 0; ip + (bpp == 1 ? 0 : 1) < comp_len; ip += bpp == 1 ? 1 : 2) {
+        const uint8_t val = bpp == 1 ? (compressed[ip] >> 7) & 1 : compressed[ip];
+        const size_t count = bpp == 1 ? (size_t)(compressed[ip] & 0x7F) + 1 : (size_t)compressed[ip + 1] + 1;
+        for (size_t j = 0; j < count && px_idx < px_max; j++)
+            _pixel_set(pixels, px_idx++, val, bpp);
+    }
+    return px_idx;
+}
+
+#define RLE_FRAMES 3
+#define RLE_PIXELS (128 * 96)
+#define RLE_ROUNDS 200
+
+static uint8_t rle_frames[RLE_FRAMES][RLE_PIXELS / 2];
+static const uint8_t rle_frame_bpp[RLE_FRAMES] = { 1, 2, 4 };
+static const char *const rle_frame_names[RLE_FRAMES] = { "bilevel 128x96", "grey4 128x96", "grey16 128x96" };
+
+/* 128x96 frames of flat shapes over a background: the content RLE is chosen for */
+static void rle_workload(void) {
+    for (int f = 0; f < RLE_FRAMES; f++) {
+        const uint8_t bpp = rle_frame_bpp[f], vmax = (uint8_t)((1U << bpp) - 1);
+        for (int y = 0; y < 96; y++)
+            for (int x = 0; x < 128; x++) {
+                int v = (x - 40) * (x - 40) + (y - 48) * (y - 48) < 600 ? vmax : (x > 80 && x < 120 && y > 20 && y < 70) ? vmax / 2 : 0;
+                if (y > 85 && (x / 8) % 2 == 0)
+                    v = vmax / 3;
+                _pixel_set(rle_frames[f], (size_t)(y * 128 + x), (uint8_t)v, bpp);
+            }
+    }
+}
+
+static void bench_rle(void) {
+    static uint8_t comp[RLE_PIXELS], ref_comp[RLE_PIXELS], back[RLE_PIXELS / 2], ref_back[RLE_PIXELS / 2];
+    rle_workload();
+
+    for (int f = 0; f < RLE_FRAMES; f++) {
+        const uint8_t bpp = rle_frame_bpp[f];
+        const size_t bytes = RLE_PIXELS * bpp / 8;
+        const size_t r = rle_compress_ref(rle_frames[f], RLE_PIXELS, bpp, ref_comp, sizeof(ref_comp));
+        const size_t n = iotdata_image_rle_compress(rle_frames[f], RLE_PIXELS, bpp, comp, sizeof(comp));
+        if (n != r || memcmp(comp, ref_comp, n) != 0 || iotdata_image_rle_decompress(comp, n, bpp, back, bytes) != RLE_PIXELS ||
+            rle_decompress_ref(comp, n, bpp, ref_back, bytes) != RLE_PIXELS || memcmp(back, rle_frames[f], bytes) != 0 || memcmp(ref_back, back, bytes) != 0) {
+            printf("  rle mismatch: frame %s\n", rle_frame_names[f]);
+            bench_failures++;
+            return;
+        }
+        printf("  %-40s %4zu -> %4zu bytes (identical)\n", rle_frame_names[f], bytes, n);
+    }
+
+    const size_t ops = (size_t)RLE_ROUNDS * RLE_FRAMES;
+    uint32_t acc = 0;
+    double t0, ref, cur;
+    t0 = now_seconds();
+    for (int r = 0; r < RLE_ROUNDS; r++)
+        for (int f = 0; f < RLE_FRAMES; f++)
+            acc += (uint32_t)rle_compress_ref(rle_frames[f], RLE_PIXELS, rle_frame_bpp[f], comp, sizeof(comp));
+    ref = now_seconds() - t0;
+    t0 = now_seconds();
+    for (int r = 0; r < RLE_ROUNDS; r++)
+        for (int f = 0; f < RLE_FRAMES; f++)
+            acc += (uint32_t)iotdata_image_rle_compress(rle_frames[f], RLE_PIXELS, rle_frame_bpp[f], comp, sizeof(comp));
+    cur = now_seconds() - t0;
+    report("rle_compress (per frame)", ref, cur, ops);
+
+    size_t lens[RLE_FRAMES];
+    for (int f = 0; f < RLE_FRAMES; f++)
+        lens[f] = iotdata_image_rle_compress(rle_frames[f], RLE_PIXELS, rle_frame_bpp[f], ref_comp + f * (RLE_PIXELS / RLE_FRAMES), RLE_PIXELS / RLE_FRAMES);
+    t0 = now_seconds();
+    for (int r = 0; r < RLE_ROUNDS; r++)
+        for (int f = 0; f < RLE_FRAMES; f++)
+            acc += (uint32_t)rle_decompress_ref(ref_comp + f * (RLE_PIXELS / RLE_FRAMES), lens[f], rle_frame_bpp[f], back, sizeof(back));
+    ref = now_seconds() - t0;
+    t0 = now_seconds();
+    for (int r = 0; r < RLE_ROUNDS; r++)
+        for (int f = 0; f < RLE_FRAMES; f++)
+            acc += (uint32_t)iotdata_image_rle_decompress(ref_comp + f * (RLE_PIXELS / RLE_FRAMES), lens[f], rle_frame_bpp[f], back, sizeof(back));
+    cur = now_seconds() - t0;
+    report("rle_decompress (per frame)", ref, cur, ops);
+    bench_sink = acc;
+}
+
+/* ---------------------------------------------------------------------------
+ * Image encode best: full compression into buffers as the reference
+ * -------------------------------------------------------------------------*/
+
+/* Compresses with each codec in full, picks the smallest that fits, else the next tier down */
+static size_t best_ref(const uint8_t *pixels, size_t room, uint8_t *tier_out, uint8_t *comp_out) {
+    static uint8_t px[HS_FRAME_BYTES], rle[HS_FRAME_BYTES * 2], hs[HS_FRAME_BYTES * 2];
+    for (int tier = IOTDATA_IMAGE_SIZE_64x48; tier >= 0; tier--) {
+        const uint8_t *p = pixels;
+        if (tier != IOTDATA_IMAGE_SIZE_64x48) {
+            _image_downscale(pixels, IOTDATA_IMAGE_SIZE_64x48, px, (uint8_t)tier, 4);
+            p = px;
+        }
+        const size_t raw = iotdata_image_bytes(IOTDATA_IMAGE_FMT_GREY16, (uint8_t)tier);
+        const size_t r = iotdata_image_rle_compress(p, iotdata_image_pixel_count((uint8_t)tier), 4, rle, sizeof(rle));
+        const size_t h = iotdata_image_hs_compress(p, raw, hs, sizeof(hs));
+        size_t best = raw;
+        *comp_out = IOTDATA_IMAGE_COMP_RAW;
+        if (r > 0 && r < best) {
+            best = r;
+            *comp_out = IOTDATA_IMAGE_COMP_RLE;
+        }
+        if (h > 0 && h < best) {
+            best = h;
+            *comp_out = IOTDATA_IMAGE_COMP_HEATSHRINK;
+        }
+        if (best <= room) {
+            *tier_out = (uint8_t)tier;
+            return best;
+        }
+    }
+    return 0;
+}
+
+static void bench_best(void) {
+    static iotdata_image_encode_best_scratch_t scratch;
+    static uint8_t buf[256];
+    iotdata_encoder_t enc;
+    hs_workload();
+
+    size_t room;
+    if (iotdata_encode_begin(&enc, buf, sizeof(buf), 0, 1, 1) != IOTDATA_OK || _image_data_room(&enc, IOTDATA_IMAGE_FMT_GREY16, IOTDATA_IMAGE_SIZE_64x48, 0, &room) != IOTDATA_OK) {
+        printf("  encode_best room failed\n");
+        bench_failures++;
+        return;
+    }
+    for (int f = 0; f < HS_FRAMES; f++) {
+        if (iotdata_encode_begin(&enc, buf, sizeof(buf), 0, 1, 1) != IOTDATA_OK || iotdata_image_encode_best(&enc, IOTDATA_IMAGE_FMT_GREY16, IOTDATA_IMAGE_SIZE_64x48, 0, hs_frames[f], IOTDATA_IMAGE_HS_PARSE_GREEDY, &scratch) != IOTDATA_OK) {
+            printf("  encode_best failed: frame %s\n", hs_frame_names[f]);
+            bench_failures++;
+            return;
+        }
+        uint8_t tier, comp;
+        const size_t r = best_ref(hs_frames[f], room, &tier, &comp);
+        if (r != enc.image_data_len || tier != enc.image_size_tier || comp != enc.image_compression) {
+            printf("  encode_best mismatch: frame %s\n", hs_frame_names[f]);
+            bench_failures++;
+            return;
+        }
+        printf("  %-40s %s, %s, %3zu of %zu bytes (identical)\n", hs_frame_names[f], _image_size_names[tier], _image_comp_names[comp], r, room);
+    }
+
+    const size_t ops = (size_t)HS_ROUNDS * HS_FRAMES;
+    uint32_t acc = 0;
+    double t0, ref, cur;
+    uint8_t tier, comp;
+    t0 = now_seconds();
+    for (int r = 0; r < HS_ROUNDS; r++)
+        for (int f = 0; f < HS_FRAMES; f++)
+            acc += (uint32_t)best_ref(hs_frames[f], room, &tier, &comp);
+    ref = now_seconds() - t0;
+    t0 = now_seconds();
+    for (int r = 0; r < HS_ROUNDS; r++)
+        for (int f = 0; f < HS_FRAMES; f++) {
+            iotdata_encode_begin(&enc, buf, sizeof(buf), 0, 1, 1);
+            iotdata_image_encode_best(&enc, IOTDATA_IMAGE_FMT_GREY16, IOTDATA_IMAGE_SIZE_64x48, 0, hs_frames[f], IOTDATA_IMAGE_HS_PARSE_GREEDY, &scratch);
+            acc += enc.image_data_len;
+        }
+    cur = now_seconds() - t0;
+    report("image_encode_best (per frame)", ref, cur, ops);
+    bench_sink = acc;
+}
+
+/* ---------------------------------------------------------------------------
+ * Columnar decode: decode_many into iotdata_decoded_t rows as the reference
+ * -------------------------------------------------------------------------*/
+
+#define COLUMNS_PACKETS 4096
+#define COLUMNS_ROUNDS  20
+
+static uint8_t columns_bufs[COLUMNS_PACKETS][32];
+static const uint8_t *columns_ptrs[COLUMNS_PACKETS];
+static size_t columns_lens[COLUMNS_PACKETS];
+
+/* Weather packets, a quarter of them without environment */
+static void columns_workload(void) {
+    for (int i = 0; i < COLUMNS_PACKETS; i++) {
+        iotdata_encoder_t enc;
+        iotdata_encode_begin(&enc, columns_bufs[i], sizeof(columns_bufs[i]), 0, (uint16_t)(i & 0xFF), (uint16_t)i);
+        iotdata_encode_battery(&enc, (uint8_t)(rng_next() % 101), false);
+        if (rng_next() & 3)
+            iotdata_encode_environment(&enc, (float)(rng_next() % 1000) / 10.0f - 30.0f, (uint16_t)(900 + rng_next() % 200), (uint8_t)(rng_next() % 101));
+        iotdata_encode_wind(&enc, (float)(rng_next() % 60), (uint16_t)(rng_next() % 360), (float)(rng_next() % 60));
+        iotdata_encode_end(&enc, &columns_lens[i]);
+        columns_ptrs[i] = columns_bufs[i];
+    }
+}
+
+static double columns_mean_ref(const iotdata_decoded_t *rows) {
+    double sum = 0.0;
+    int n = 0;
+    for (int i = 0; i < COLUMNS_PACKETS; i++)
+        if (IOTDATA_FIELD_PRESENT(rows[i].fields, IOTDATA_FIELD_ENVIRONMENT)) {
+            sum += rows[i].temperature;
+            n++;
+        }
+    return n ? sum / n : 0.0;
+}
+
+static double columns_mean(const iotdata_columns_t *cols) {
+    double sum = 0.0;
+    int n = 0;
+    for (size_t i = 0; i < cols->count; i++) {
+        const int valid = (cols->temperature_valid[i >> 3] >> (i & 7)) & 1;
+        sum += cols->temperature[i] * (float)valid; /* absent rows hold 0 */
+        n += valid;
+    }
+    return n ? sum / n : 0.0;
+}
+
+static void bench_columns(void) {
+    static float temperature[COLUMNS_PACKETS];
+    static uint8_t temperature_valid[(COLUMNS_PACKETS + 7) / 8];
+    static iotdata_decode_columns_scratch_t scratch;
+    iotdata_decoded_t *rows = malloc(sizeof(iotdata_decoded_t) * COLUMNS_PACKETS);
+    if (rows == NULL) {
+        printf("  columns: allocation failed\n");
+        bench_failures++;
+        return;
+    }
+    columns_workload();
+    iotdata_columns_t cols = { .capacity = COLUMNS_PACKETS };
+    cols.temperature = temperature;
+    cols.temperature_valid = temperature_valid;
+
+    iotdata_decode_many(columns_ptrs, columns_lens, COLUMNS_PACKETS, rows, NULL);
+    iotdata_decode_columns(columns_ptrs, columns_lens, COLUMNS_PACKETS, &cols, NULL, &scratch);
+    const double a = columns_mean_ref(rows), b = columns_mean(&cols);
+    if (fabs(a - b) > 1e-9 || cols.count != COLUMNS_PACKETS) {
+        printf("  columns mismatch: %f vs %f\n", a, b);
+        bench_failures++;
+        free(rows);
+        return;
+    }
+    printf("  %-40s ok (%d packets, %zu vs %zu bytes per row)\n", "decode_columns equivalence", COLUMNS_PACKETS, sizeof(iotdata_decoded_t), sizeof(float));
+
+    const size_t ops = (size_t)COLUMNS_ROUNDS * COLUMNS_PACKETS;
+    double acc = 0.0, t0, ref, cur;
+    t0 = now_seconds();
+    for (int r = 0; r < COLUMNS_ROUNDS; r++)
+        acc += (double)iotdata_decode_many(columns_ptrs, columns_lens, COLUMNS_PACKETS, rows, NULL);
+    ref = now_seconds() - t0;
+    t0 = now_seconds();
+    for (int r = 0; r < COLUMNS_ROUNDS; r++) {
+        cols.count = 0;
+        acc += (double)iotdata_decode_columns(columns_ptrs, columns_lens, COLUMNS_PACKETS, &cols, NULL, &scratch);
+    }
+    cur = now_seconds() - t0;
+    report("decode (rows vs columns)", ref, cur, ops);
+
+    /* volatile views keep the compiler from hoisting the pure scans out of the loops */
+    iotdata_decoded_t *volatile rows_v = rows;
+    iotdata_columns_t *volatile cols_v = &cols;
+    t0 = now_seconds();
+    for (int r = 0; r < COLUMNS_ROUNDS * 10; r++)
+        acc += columns_mean_ref(rows_v);
+    ref = now_seconds() - t0;
+    t0 = now_seconds();
+    for (int r = 0; r < COLUMNS_ROUNDS * 10; r++)
+        acc += columns_mean(cols_v);
+    cur = now_seconds() - t0;
+    report("mean temperature (rows vs columns)", ref, cur, ops * 10);
+
+    bench_sink = (uint32_t)acc;
+    free(rows);
+}
+
+/* ---------------------------------------------------------------------------
+ * Decode view: full iotdata_decode (payloads copied out) as the reference
+ * -------------------------------------------------------------------------*/
+
+#define VIEW_PACKETS 256
+#define VIEW_ROUNDS  200
+
+static uint8_t view_bufs[VIEW_PACKETS][96];
+static size_t view_lens[VIEW_PACKETS];
+
+/* Weather packets carrying a status TLV and a diagnostic string, which most consumers ignore */
+static void view_workload(void) {
+    static const char *const diags[] = { "SENSOR OK", "LOW BATTERY WARNING", "RAIN GAUGE BLOCKED", "WIND VANE STUCK" };
+    for (int i = 0; i < VIEW_PACKETS; i++) {
+        iotdata_encoder_t enc;
+        uint8_t status[9];
+        iotdata_encode_begin(&enc, view_bufs[i], sizeof(view_bufs[i]), 0, (uint16_t)(i & 0xFF), (uint16_t)i);
+        iotdata_encode_battery(&enc, (uint8_t)(rng_next() % 101), false);
+        iotdata_encode_environment(&enc, (float)(rng_next() % 1000) / 10.0f - 30.0f, (uint16_t)(900 + rng_next() % 200), (uint8_t)(rng_next() % 101));
+        iotdata_encode_wind(&enc, (float)(rng_next() % 60), (uint16_t)(rng_next() % 360), (float)(rng_next() % 60));
+        iotdata_encode_tlv_type_status(&enc, rng_next() % 86400, rng_next() % 864000, (uint16_t)(rng_next() % 100), IOTDATA_TLV_REASON_POWER_ON, status);
+        iotdata_encode_tlv_type_diagnostic(&enc, diags[rng_next() % 4], false);
+        iotdata_encode_end(&enc, &view_lens[i]);
+    }
+}
+
+static void bench_view(void) {
+    static iotdata_decoded_t dec;
+    static iotdata_decoded_view_t view;
+    view_workload();
+
+    for (int i = 0; i < VIEW_PACKETS; i++) {
+        iotdata_decoded_tlv_t tlv;
+        if (iotdata_decode(view_bufs[i], view_lens[i], &dec) != IOTDATA_OK || iotdata_decode_view(view_bufs[i], view_lens[i], &view) != IOTDATA_OK || memcmp(&dec.view, &view, sizeof(view)) != 0) {
+            printf("  view mismatch at packet %d\n", i);
+            bench_failures++;
+            return;
+        }
+        for (uint8_t t = 0; t < view.tlv_count; t++)
+            if (iotdata_view_tlv(&view, view_bufs[i], t, &tlv) != IOTDATA_OK || tlv.length != dec.tlv[t].length || memcmp(tlv.raw, dec.tlv[t].raw, tlv.length) != 0) {
+                printf("  view TLV mismatch at packet %d entry %d\n", i, t);
+                bench_failures++;
+                return;
+            }
+    }
+    printf("  %-40s ok (%d packets, %zu vs %zu bytes)\n", "decode_view equivalence", VIEW_PACKETS, sizeof(iotdata_decoded_t), sizeof(iotdata_decoded_view_t));
+
+    const size_t ops = (size_t)VIEW_ROUNDS * VIEW_PACKETS;
+    uint32_t acc = 0;
+    double t0, ref, cur;
+    t0 = now_seconds();
+    for (int r = 0; r < VIEW_ROUNDS; r++)
+        for (int i = 0; i < VIEW_PACKETS; i++) {
+            iotdata_decode(view_bufs[i], view_lens[i], &dec);
+            acc += dec.battery_level;
+        }
+    ref = now_seconds() - t0;
+    t0 = now_seconds();
+    for (int r = 0; r < VIEW_ROUNDS; r++)
+        for (int i = 0; i < VIEW_PACKETS; i++) {
+            iotdata_decode_view(view_bufs[i], view_lens[i], &view);
+            acc += view.battery_level;
+        }
+    cur = now_seconds() - t0;
+    report("decode, payloads ignored", ref, cur, ops);
+    bench_sink = acc;
+}
+
+/* ---------------------------------------------------------------------------
+ * Main
+ * -------------------------------------------------------------------------*/
+
+int main(void) {
+    printf("\n=== iotdata — benchmarks ===\n\n");
+
+    printf("--- Bit-packing ---\n");
+    bench_bits_verify();
+    bench_bits_timing();
+
+    printf("\n--- Decimal formatting ---\n");
+    bench_fixed_verify();
+    bench_fixed_timing();
+
+    printf("\n--- Six-bit strings ---\n");
+    bench_sixbit_verify();
+    bench_sixbit_timing();
+
+    printf("\n--- Heatshrink (64x48 GREY16) ---\n");
+    bench_hs();
+
+    printf("\n--- RLE (128x96 shapes) ---\n");
+    bench_rle();
+
+    printf("\n--- Image encode best (64x48 GREY16, 256-byte packet) ---\n");
+    bench_best();
+
+    printf("\n--- Columnar decode ---\n");
+    bench_columns();
+
+    printf("\n--- Decode view ---\n");
+    bench_view();
+
+    printf("\n--- Results: %s ---\n\n", bench_failures ? "FAILED" : "ok");
+    return bench_failures ? 1 : 0;
+}
@@ -600,6 +600,30 @@ static void test_tlv_diagnostic_round_trip(void) {
     PASS();
 }
 
+static void test_tlv_string_alignments(void) {
+    TEST("TLV strings round-trip at every bit alignment");
+    begin(0, 1, 36);
+
+    /* Strings of 1..7 characters shift the next one through every even bit offset, the last is the whole set */
+    static const char alphabet[] = " abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    char strs[IOTDATA_TLV_MAX][sizeof(alphabet)];
+    for (int i = 0; i < IOTDATA_TLV_MAX; i++) {
+        const size_t n = i < IOTDATA_TLV_MAX - 1 ? (size_t)i + 1 : sizeof(alphabet) - 1;
+        memcpy(strs[i], alphabet + ((size_t)i * 9) % (sizeof(alphabet) - n), n);
+        strs[i][n] = '\0';
+        ASSERT_OK(iotdata_encode_tlv_string(&enc, (uint8_t)(0x20 + i), strs[i]), "encode");
+    }
+    finish();
+    decode_pkt();
+
+    ASSERT_EQ(dec.tlv_count, IOTDATA_TLV_MAX, "count");
+    for (int i = 0; i < IOTDATA_TLV_MAX; i++) {
+        ASSERT_EQ(dec.tlv[i].format, IOTDATA_TLV_FMT_STRING, "format");
+        ASSERT_EQ(strcmp(dec.tlv[i].str, strs[i]), 0, "string");
+    }
+    PASS();
+}
+
 static void test_tlv_userdata_round_trip(void) {
     TEST("TLV userdata round-trip");
     begin(0, 1, 36);
@@ -639,6 +663,53 @@ static void test_tlv_multiple(void) {
     PASS();
 }
 
+static void test_decode_view_payloads(void) {
+    TEST("Decode view: image and TLV copied out on demand");
+    begin(0, 1, 38);
+
+    ASSERT_OK(iotdata_encode_battery(&enc, 50, false), "bat");
+    uint8_t img[] = { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE };
+    ASSERT_OK(iotdata_encode_image(&enc, IOTDATA_IMAGE_FMT_GREY16, IOTDATA_IMAGE_SIZE_24x18, IOTDATA_IMAGE_COMP_RAW, 0, img, sizeof(img)), "image");
+    uint8_t status_buf[9];
+    ASSERT_OK(iotdata_encode_tlv_type_status(&enc, 600, 7200, 1, IOTDATA_TLV_REASON_SOFTWARE, status_buf), "status");
+    ASSERT_OK(iotdata_encode_tlv_type_userdata(&enc, "view test", false), "user");
+    finish();
+    decode_pkt();
+
+    iotdata_decoded_view_t view;
+    ASSERT_OK(iotdata_decode_view(pkt, pkt_len, &view), "view");
+    ASSERT_EQ_U(view.fields, dec.fields, "fields");
+    ASSERT_EQ_U(view.packed_bits, dec.packed_bits, "bits");
+    ASSERT_EQ(view.battery_level, dec.battery_level, "battery");
+    ASSERT_EQ(view.image_pixel_format, IOTDATA_IMAGE_FMT_GREY16, "fmt");
+    ASSERT_EQ(view.image_data_len, sizeof(img), "image len");
+    ASSERT_TRUE(view.image_data_offset % 8 != 0, "unaligned image");
+
+    uint8_t data[IOTDATA_IMAGE_DATA_MAX];
+    ASSERT_OK(iotdata_view_image(&view, pkt, data), "image copy");
+    ASSERT_TRUE(memcmp(data, img, sizeof(img)) == 0, "image data");
+
+    ASSERT_EQ(view.tlv_count, 2, "count");
+    for (uint8_t i = 0; i < view.tlv_count; i++) {
+        iotdata_decoded_tlv_t tlv;
+        ASSERT_OK(iotdata_view_tlv(&view, pkt, i, &tlv), "tlv copy");
+        ASSERT_EQ(tlv.format, dec.tlv[i].format, "tlv format");
+        ASSERT_EQ(tlv.type, dec.tlv[i].type, "tlv type");
+        ASSERT_EQ(tlv.length, dec.tlv[i].length, "tlv length");
+        ASSERT_TRUE(memcmp(tlv.raw, dec.tlv[i].raw, tlv.length) == 0, "tlv data");
+    }
+    iotdata_decoded_tlv_t tlv;
+    ASSERT_ERR(iotdata_view_tlv(&view, pkt, 2, &tlv), IOTDATA_ERR_DECODE_VIEW_ABSENT, "tlv index");
+    ASSERT_TRUE(strcmp(dec.tlv[1].str, "view test") == 0, "full decode string");
+
+    begin(0, 1, 39);
+    ASSERT_OK(iotdata_encode_battery(&enc, 50, false), "bat");
+    finish();
+    ASSERT_OK(iotdata_decode_view(pkt, pkt_len, &view), "view");
+    ASSERT_ERR(iotdata_view_image(&view, pkt, data), IOTDATA_ERR_DECODE_VIEW_ABSENT, "no image");
+    PASS();
+}
+
 /* =========================================================================
  * Section 7: JSON round-trip
  * =========================================================================*/
@@ -868,6 +939,46 @@ static void test_image_rle_round_trip(void) {
     PASS();
 }
 
+static void test_image_rle_run_lengths(void) {
+    TEST("Image RLE runs across words, all depths");
+
+    /* Runs of 1..300 pixels at every alignment, checked against a per-pixel reference encoding */
+    static const size_t lens[] = { 1, 2, 3, 7, 9, 31, 33, 63, 64, 65, 127, 128, 129, 200, 255, 256, 257, 300, 5, 1 };
+    const uint8_t depths[] = { 1, 2, 4 };
+    for (size_t d = 0; d < sizeof(depths); d++) {
+        const uint8_t bpp = depths[d], vmax = (uint8_t)((1U << bpp) - 1);
+        uint8_t pixels[1024] = { 0 }, compressed[512], expected[512], decompressed[1024];
+        size_t n = 0, exp_len = 0;
+        for (size_t r = 0; r < sizeof(lens) / sizeof(lens[0]); r++) {
+            const uint8_t val = (uint8_t)((r * 5 + 1) & vmax);
+            for (size_t j = 0; j < lens[r]; j++, n++)
+                pixels[n * bpp / 8] |= (uint8_t)(val << (8 - bpp - (n * bpp) % 8));
+        }
+        for (size_t i = 0; i < n;) {
+            const uint8_t val = (uint8_t)((pixels[i * bpp / 8] >> (8 - bpp - (i * bpp) % 8)) & vmax);
+            size_t count = 1;
+            while (i + count < n && count < (bpp == 1 ? 128U : 256U) && ((pixels[(i + count) * bpp / 8] >> (8 - bpp - ((i + count) * bpp) % 8)) & vmax) == val)
+                count++;
+            if (bpp == 1)
+                expected[exp_len++] = (uint8_t)((val << 7) | (count - 1));
+            else {
+                expected[exp_len++] = val;
+                expected[exp_len++] = (uint8_t)(count - 1);
+            }
+            i += count;
+        }
+        const size_t comp_len = iotdata_image_rle_compress(pixels, n, bpp, compressed, sizeof(compressed));
+        ASSERT_EQ_U(comp_len, exp_len, "compressed length");
+        ASSERT_EQ(memcmp(compressed, expected, exp_len), 0, "compressed bytes");
+        ASSERT_EQ_U(iotdata_image_rle_compress(pixels, n, bpp, compressed, exp_len - 1), 0, "overflow");
+        memset(decompressed, 0xA5, sizeof(decompressed));
+        ASSERT_EQ_U(iotdata_image_rle_decompress(compressed, comp_len, bpp, decompressed, (n * bpp + 7) / 8), n, "decompressed pixels");
+        ASSERT_EQ(memcmp(pixels, decompressed, (n * bpp + 7) / 8), 0, "round-trip");
+    }
+    ASSERT_EQ_U(iotdata_image_rle_compress((const uint8_t *)"x", 1, 3, (uint8_t[4]) { 0 }, 4), 0, "unsupported depth");
+    PASS();
+}
+
 static void test_image_heatshrink_round_trip(void) {
     TEST("Image heatshrink compress/decompress");
 
@@ -894,6 +1005,88 @@ static void test_image_heatshrink_round_trip(void) {
     PASS();
 }
 
+static void test_image_heatshrink_parse_modes(void) {
+    TEST("Image heatshrink greedy/lazy/optimal parses round-trip");
+
+    /* Flat runs, repeats at varying distances and noise, past the 64 KB where chain positions wrap */
+    static uint8_t raw[70000], compressed[80000], decompressed[70000];
+    uint32_t seed = 1;
+    for (size_t i = 0; i < sizeof(raw); i++) {
+        seed = seed * 1103515245U + 12345U;
+        const uint32_t r = seed >> 16;
+        raw[i] = (r & 7) == 0 ? (uint8_t)r : i > 300 && (r & 7) < 5 ? raw[i - 1 - (r >> 3) % 280] : (uint8_t)(i / 64);
+    }
+
+    size_t comp_lens[3];
+    for (uint8_t parse = IOTDATA_IMAGE_HS_PARSE_GREEDY; parse <= IOTDATA_IMAGE_HS_PARSE_OPTIMAL; parse++) {
+        const size_t comp_len = iotdata_image_hs_compress_parse(raw, sizeof(raw), compressed, sizeof(compressed), parse);
+        ASSERT_TRUE(comp_len > 0 && comp_len < sizeof(raw), "compress");
+        memset(decompressed, 0, sizeof(decompressed));
+        ASSERT_EQ_U(iotdata_image_hs_decompress(compressed, comp_len, decompressed, sizeof(decompressed)), sizeof(raw), "decompress length");
+        ASSERT_EQ(memcmp(raw, decompressed, sizeof(raw)), 0, "round-trip");
+        comp_lens[parse] = comp_len;
+    }
+    ASSERT_TRUE(comp_lens[IOTDATA_IMAGE_HS_PARSE_OPTIMAL] <= comp_lens[IOTDATA_IMAGE_HS_PARSE_LAZY], "optimal no larger than lazy");
+    ASSERT_TRUE(comp_lens[IOTDATA_IMAGE_HS_PARSE_OPTIMAL] <= comp_lens[IOTDATA_IMAGE_HS_PARSE_GREEDY], "optimal no larger than greedy");
+    ASSERT_EQ_U(iotdata_image_hs_compress_parse(raw, sizeof(raw), compressed, 16, IOTDATA_IMAGE_HS_PARSE_LAZY), 0, "overflow");
+    ASSERT_EQ_U(iotdata_image_hs_compress_parse(raw, sizeof(raw), compressed, 16, IOTDATA_IMAGE_HS_PARSE_OPTIMAL), 0, "overflow");
+    for (size_t n = 1; n <= 40; n++) {
+        const size_t comp_len = iotdata_image_hs_compress_parse(raw + 1000, n, compressed, sizeof(compressed), IOTDATA_IMAGE_HS_PARSE_OPTIMAL);
+        ASSERT_EQ_U(iotdata_image_hs_decompress(compressed, comp_len, decompressed, n), n, "short input");
+        ASSERT_EQ(memcmp(raw + 1000, decompressed, n), 0, "short round-trip");
+    }
+    PASS();
+}
+
+static void test_image_encode_best(void) {
+    TEST("Image encode best: smallest codec, stepping down size tier");
+
+    static uint8_t flat[64 * 48 / 2], noise[64 * 48 / 2], comp[2048], back[64 * 48 / 2];
+    static iotdata_image_encode_best_scratch_t scratch;
+    for (size_t i = 0; i < sizeof(flat); i++)
+        flat[i] = i < 700 ? 0x33 : i < 1000 ? 0x3C : 0xCC;
+    uint32_t seed = 7;
+    for (size_t i = 0; i < sizeof(noise); i++) {
+        seed = seed * 1103515245U + 12345U;
+        noise[i] = (uint8_t)(seed >> 16);
+    }
+
+    /* Compressible: full size, with the smaller of RLE and heatshrink */
+    begin(0, 1, 5);
+    ASSERT_OK(iotdata_encode_battery(&enc, 50, false), "battery");
+    ASSERT_OK(iotdata_image_encode_best(&enc, IOTDATA_IMAGE_FMT_GREY16, IOTDATA_IMAGE_SIZE_64x48, 0, flat, IOTDATA_IMAGE_HS_PARSE_OPTIMAL, &scratch), "encode flat");
+    finish();
+    decode_pkt();
+    const size_t rle = iotdata_image_rle_compress(flat, 64 * 48, 4, comp, sizeof(comp)), hs = iotdata_image_hs_compress_parse(flat, sizeof(flat), comp, sizeof(comp), IOTDATA_IMAGE_HS_PARSE_OPTIMAL);
+    ASSERT_EQ(dec.image_size_tier, IOTDATA_IMAGE_SIZE_64x48, "flat size");
+    ASSERT_EQ(dec.image_compression, rle <= hs ? IOTDATA_IMAGE_COMP_RLE : IOTDATA_IMAGE_COMP_HEATSHRINK, "flat comp");
+    ASSERT_EQ_U(dec.image_data_len, rle <= hs ? rle : hs, "flat len");
+    if (dec.image_compression == IOTDATA_IMAGE_COMP_RLE)
+        ASSERT_EQ_U(iotdata_image_rle_decompress(dec.image_data, dec.image_data_len, 4, back, sizeof(back)), 64 * 48, "flat rle");
+    else
+        ASSERT_EQ_U(iotdata_image_hs_decompress(dec.image_data, dec.image_data_len, back, sizeof(back)), sizeof(back), "flat hs");
+    ASSERT_EQ(memcmp(back, flat, sizeof(flat)), 0, "flat pixels");
+
+    /* Incompressible: down to 24x18, raw, sampled at the nearest pixel */
+    begin(0, 1, 6);
+    ASSERT_OK(iotdata_image_encode_best(&enc, IOTDATA_IMAGE_FMT_GREY16, IOTDATA_IMAGE_SIZE_64x48, IOTDATA_IMAGE_FLAG_INVERT, noise, IOTDATA_IMAGE_HS_PARSE_GREEDY, &scratch), "encode noise");
+    finish();
+    ASSERT_TRUE(pkt_len <= sizeof(pkt), "fits");
+    decode_pkt();
+    ASSERT_EQ(dec.image_size_tier, IOTDATA_IMAGE_SIZE_24x18, "noise size");
+    ASSERT_EQ(dec.image_compression, IOTDATA_IMAGE_COMP_RAW, "noise comp");
+    ASSERT_EQ(dec.image_flags, IOTDATA_IMAGE_FLAG_INVERT, "noise flags");
+    ASSERT_EQ_U(dec.image_data_len, 24 * 18 / 2, "noise len");
+    ASSERT_EQ(dec.image_data[0] >> 4, noise[(1 * 64 + 1) / 2] & 0x0F, "noise pixel (0,0) from (1,1)");
+
+    /* Nothing fits */
+    uint8_t small[16];
+    ASSERT_OK(iotdata_encode_begin(&enc, small, sizeof(small), 0, 1, 7), "begin small");
+    ASSERT_ERR(iotdata_image_encode_best(&enc, IOTDATA_IMAGE_FMT_GREY16, IOTDATA_IMAGE_SIZE_64x48, 0, noise, IOTDATA_IMAGE_HS_PARSE_GREEDY, &scratch), IOTDATA_ERR_BUF_TOO_SMALL, "too small");
+    ASSERT_ERR(iotdata_image_encode_best(&enc, IOTDATA_IMAGE_FMT_GREY16, IOTDATA_IMAGE_SIZE_64x48, 0, noise, IOTDATA_IMAGE_HS_PARSE_GREEDY, NULL), IOTDATA_ERR_BUF_NULL, "scratch");
+    PASS();
+}
+
 /* =========================================================================
  * Main
  * =========================================================================*/
@@ -937,8 +1130,10 @@ int main(void) {
     test_tlv_health_round_trip();
     test_tlv_config_round_trip();
     test_tlv_diagnostic_round_trip();
+    test_tlv_string_alignments();
     test_tlv_userdata_round_trip();
     test_tlv_multiple();
+    test_decode_view_payloads();
 
     printf("\n--- Section 7: JSON round-trip ---\n");
     test_json_round_trip_complete();
@@ -956,7 +1151,10 @@ int main(void) {
 
     printf("\n--- Section 10: Image compression ---\n");
     test_image_rle_round_trip();
+    test_image_rle_run_lengths();
     test_image_heatshrink_round_trip();
+    test_image_heatshrink_parse_modes();
+    test_image_encode_best();
 
     printf("\n--- Results: %d/%d passed", tests_passed, tests_run);
     if (tests_failed > 0)
@@ -494,6 +494,108 @@ static void test_empty_packets_all_variants(void) {
     PASS();
 }
 
+/* =========================================================================
+ * Batch decode across variants
+ * =========================================================================*/
+
+static void test_decode_many_mixed_variants(void) {
+    TEST("Batch decode across mixed variants");
+
+    uint8_t bufs[5][64];
+    size_t lens[5];
+    const uint8_t variants[5] = { 0, 0, 2, 1, 0 };
+    for (int i = 0; i < 5; i++) {
+        begin(variants[i], (uint16_t)(10 + i), (uint16_t)i);
+        ASSERT_OK(iotdata_encode_battery(&enc, (uint8_t)(50 + i), false), "bat");
+        if (variants[i] == 1)
+            ASSERT_OK(iotdata_encode_wind_speed(&enc, 5.0f + (float)i), "wind");
+        else
+            ASSERT_OK(iotdata_encode_temperature(&enc, 10.0f + (float)i), "temp");
+        finish();
+        memcpy(bufs[i], pkt, pkt_len);
+        lens[i] = pkt_len;
+    }
+    lens[1] = 2; /* truncated header */
+    const uint8_t *ptrs[5] = { bufs[0], bufs[1], bufs[2], bufs[3], bufs[4] };
+    iotdata_decoded_t out[5];
+    iotdata_status_t rc[5];
+    ASSERT_EQ(iotdata_decode_many(ptrs, lens, 5, out, rc), 4, "decoded count");
+    ASSERT_ERR(rc[1], IOTDATA_ERR_DECODE_SHORT, "short packet");
+    for (int i = 0; i < 5; i++) {
+        if (i == 1)
+            continue;
+        ASSERT_OK(rc[i], "rc");
+        ASSERT_OK(iotdata_decode(bufs[i], lens[i], &dec), "single decode");
+        ASSERT_EQ(out[i].variant, variants[i], "variant");
+        ASSERT_EQ(out[i].station, dec.station, "station");
+        ASSERT_EQ_U(out[i].fields, dec.fields, "fields");
+        ASSERT_EQ(out[i].battery_level, dec.battery_level, "bat");
+        if (variants[i] != 1)
+            ASSERT_NEAR(out[i].temperature, dec.temperature, 0.001, "temp");
+        ASSERT_EQ_U(out[i].packed_bits, dec.packed_bits, "packed bits");
+    }
+    PASS();
+}
+
+static void test_decode_columns_mixed_variants(void) {
+    TEST("Columnar decode across mixed variants");
+
+    uint8_t bufs[5][64];
+    size_t lens[5];
+    const uint8_t variants[5] = { 0, 0, 1, 2, 0 };
+    for (int i = 0; i < 5; i++) {
+        begin(variants[i], (uint16_t)(10 + i), (uint16_t)i);
+        ASSERT_OK(iotdata_encode_battery(&enc, (uint8_t)(50 + i), false), "bat");
+        if (variants[i] == 1)
+            ASSERT_OK(iotdata_encode_wind_speed(&enc, 5.0f + (float)i), "wind");
+        else
+            ASSERT_OK(iotdata_encode_temperature(&enc, 10.0f + (float)i), "temp");
+        finish();
+        memcpy(bufs[i], pkt, pkt_len);
+        lens[i] = pkt_len;
+    }
+    lens[1] = 2; /* truncated header */
+    const uint8_t *ptrs[5] = { bufs[0], bufs[1], bufs[2], bufs[3], bufs[4] };
+
+    uint16_t station[4];
+    uint8_t battery[4];
+    float temperature[4], wind_speed[4];
+    uint8_t temperature_valid[1] = { 0xFF }, wind_speed_valid[1] = { 0xFF };
+    iotdata_columns_t cols = { .capacity = 3 };
+    cols.station = station;
+    cols.battery_level = battery;
+    cols.temperature = temperature;
+    cols.temperature_valid = temperature_valid;
+    cols.wind_speed = wind_speed;
+    cols.wind_speed_valid = wind_speed_valid;
+    iotdata_decode_columns_scratch_t scratch;
+    iotdata_status_t rc[5];
+
+    /* Rows for packets 0, 2, 3; packet 1 fails, packet 4 finds the columns full */
+    ASSERT_EQ(iotdata_decode_columns(ptrs, lens, 5, &cols, rc, &scratch), 3, "rows appended");
+    ASSERT_ERR(rc[1], IOTDATA_ERR_DECODE_SHORT, "short packet");
+    ASSERT_ERR(rc[4], IOTDATA_ERR_DECODE_COLUMNS_FULL, "columns full");
+    ASSERT_EQ_U(cols.count, 3, "count");
+    cols.capacity = 4;
+    ASSERT_EQ(iotdata_decode_columns(&ptrs[4], &lens[4], 1, &cols, rc, &scratch), 1, "row appended");
+    ASSERT_EQ_U(cols.count, 4, "count");
+
+    const int rows[4] = { 0, 2, 3, 4 };
+    for (int r = 0; r < 4; r++) {
+        const int i = rows[r];
+        ASSERT_OK(iotdata_decode(bufs[i], lens[i], &dec), "single decode");
+        ASSERT_EQ(station[r], dec.station, "station");
+        ASSERT_EQ(battery[r], dec.battery_level, "bat");
+        const bool wind = variants[i] == 1;
+        ASSERT_EQ((temperature_valid[0] >> r) & 1, wind ? 0 : 1, "temperature valid");
+        ASSERT_EQ((wind_speed_valid[0] >> r) & 1, wind ? 1 : 0, "wind speed valid");
+        ASSERT_NEAR(temperature[r], wind ? 0.0f : dec.temperature, 0.001, "temp");
+        ASSERT_NEAR(wind_speed[r], wind ? dec.wind_speed : 0.0f, 0.001, "wind");
+    }
+    ASSERT_EQ(temperature_valid[0] >> 4, 0xF, "bits past count untouched");
+    PASS();
+}
+
 /* =========================================================================
  * Main
  * =========================================================================*/
@@ -526,6 +628,8 @@ int main(void) {
     test_print_shows_variant_name();
     test_get_variant_function();
     test_empty_packets_all_variants();
+    test_decode_many_mixed_variants();
+    test_decode_columns_mixed_variants();
 
     printf("\n=== Results: %d/%d passed", tests_passed, tests_run);
     if (tests_failed > 0)
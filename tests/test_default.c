@@ -595,6 +595,72 @@ static void test_json_round_trip(void) {
     PASS();
 }
 
+static void test_json_buffer(void) {
+    TEST("JSON to caller buffer (matches allocating form, overflow)");
+    begin(0, 10, 1000);
+
+    ASSERT_OK(iotdata_encode_battery(&enc, 80, true), "bat");
+    ASSERT_OK(iotdata_encode_environment(&enc, -12.5f, 990, 85), "env");
+    ASSERT_OK(iotdata_encode_wind(&enc, 3.5f, 90, 6.0f), "wind");
+    ASSERT_OK(iotdata_encode_position(&enc, 59.334591, 18.063240), "pos");
+    finish();
+
+    char *json = NULL;
+    iotdata_decode_to_json_scratch_t dec_scratch;
+    ASSERT_OK(iotdata_decode_to_json(pkt, pkt_len, &json, &dec_scratch), "to_json");
+
+    char out[1024];
+    size_t out_len = 0;
+    ASSERT_OK(iotdata_decode_to_json_buffer(pkt, pkt_len, out, sizeof(out), &out_len, &dec_scratch), "to_json_buffer");
+    ASSERT_EQ(out_len, strlen(json), "len match");
+    ASSERT_EQ(strcmp(out, json), 0, "text match");
+
+    /* too small by one (no room for NUL): overflow, but the required length is reported */
+    size_t need = 0;
+    ASSERT_EQ(iotdata_decode_to_json_buffer(pkt, pkt_len, out, out_len, &need, &dec_scratch), IOTDATA_ERR_JSON_OVERFLOW, "overflow");
+    ASSERT_EQ(need, out_len, "measured len");
+    ASSERT_EQ(iotdata_decode_to_json_buffer(pkt, pkt_len, NULL, 0, &need, &dec_scratch), IOTDATA_ERR_JSON_OVERFLOW, "measure only");
+    ASSERT_EQ(need, out_len, "measured len (no buffer)");
+    ASSERT_OK(iotdata_decode_to_json_buffer(pkt, pkt_len, out, out_len + 1, &need, &dec_scratch), "exact fit");
+    ASSERT_EQ(strcmp(out, json), 0, "exact fit text");
+    free(json);
+    PASS();
+}
+
+static void test_decimal_output(void) {
+    TEST("Decimal text at field resolution (JSON shortest, print fixed)");
+    begin(0, 3, 77);
+
+    ASSERT_OK(iotdata_encode_environment(&enc, -12.25f, 990, 85), "env");
+    ASSERT_OK(iotdata_encode_wind(&enc, 3.5f, 90, 6.0f), "wind");
+    ASSERT_OK(iotdata_encode_radiation(&enc, 20, 0.07f), "rad");
+    ASSERT_OK(iotdata_encode_position(&enc, -33.8688, 151.2093), "pos");
+    finish();
+
+    char *json = NULL;
+    iotdata_decode_to_json_scratch_t dec_scratch;
+    ASSERT_OK(iotdata_decode_to_json(pkt, pkt_len, &json, &dec_scratch), "to_json");
+    const char *want_json[] = { "\"temperature\":-12.25,", "\"speed\":3.5,", "\"gust\":6}", "\"dose\":0.07}", "\"latitude\":-33.8687971,", "\"longitude\":151.2092955}" };
+    for (size_t i = 0; i < sizeof(want_json) / sizeof(want_json[0]); i++)
+        if (!strstr(json, want_json[i])) {
+            free(json);
+            FAIL(want_json[i]);
+            return;
+        }
+    free(json);
+
+    char str[8192];
+    iotdata_print_scratch_t print_scratch;
+    ASSERT_OK(iotdata_print_to_string(pkt, pkt_len, str, sizeof(str), &print_scratch), "to_string");
+    const char *want_print[] = { " -12.25 C,", " 3.5 m/s,", "gust 6.0 m/s", " 0.07 uSv/h", " -33.868797, 151.209295\n" };
+    for (size_t i = 0; i < sizeof(want_print) / sizeof(want_print[0]); i++)
+        if (!strstr(str, want_print[i])) {
+            FAIL(want_print[i]);
+            return;
+        }
+    PASS();
+}
+
 static void test_dump_output(void) {
     TEST("Dump output");
     begin(0, 5, 42);
@@ -799,6 +865,8 @@ int main(void) {
     printf("\n  --- TLV, JSON, print, dump ---\n");
     test_tlv_round_trip();
     test_json_round_trip();
+    test_json_buffer();
+    test_decimal_output();
     test_dump_output();
     test_print_output();
 
@@ -916,6 +916,16 @@ static void test_json_parse_error(void) {
     ASSERT_ERR(iotdata_encode_from_json("{invalid json", buf, sizeof(buf), &len, &scratch), IOTDATA_ERR_JSON_PARSE, "parse");
     ASSERT_ERR(iotdata_encode_from_json("", buf, sizeof(buf), &len, &scratch), IOTDATA_ERR_JSON_PARSE, "empty");
     ASSERT_ERR(iotdata_encode_from_json(NULL, buf, sizeof(buf), &len, &scratch), IOTDATA_ERR_JSON_PARSE, "null");
+    ASSERT_ERR(iotdata_encode_from_json("{\"variant\":0,}", buf, sizeof(buf), &len, &scratch), IOTDATA_ERR_JSON_PARSE, "trailing comma");
+    ASSERT_ERR(iotdata_encode_from_json("{\"variant\":0} x", buf, sizeof(buf), &len, &scratch), IOTDATA_ERR_JSON_PARSE, "trailing content");
+    ASSERT_ERR(iotdata_encode_from_json("{\"variant\":01}", buf, sizeof(buf), &len, &scratch), IOTDATA_ERR_JSON_PARSE, "leading zero");
+    ASSERT_ERR(iotdata_encode_from_json("{\"x\":\"\\q\"}", buf, sizeof(buf), &len, &scratch), IOTDATA_ERR_JSON_PARSE, "bad escape");
+    ASSERT_ERR(iotdata_encode_from_json("{\"x\":\"open}", buf, sizeof(buf), &len, &scratch), IOTDATA_ERR_JSON_PARSE, "unterminated string");
+    char deep[128];
+    memset(deep, '[', 64);
+    memset(deep + 64, ']', 63);
+    deep[127] = '\0';
+    ASSERT_ERR(iotdata_encode_from_json(deep, buf, sizeof(buf), &len, &scratch), IOTDATA_ERR_JSON_PARSE, "nesting depth");
     PASS();
 }
 
@@ -928,6 +938,30 @@ static void test_json_missing_fields(void) {
 
     /* Valid JSON but missing variant/station/sequence */
     ASSERT_ERR(iotdata_encode_from_json("{\"foo\":1}", buf, sizeof(buf), &len, &scratch), IOTDATA_ERR_JSON_MISSING_FIELD, "missing header");
+    ASSERT_ERR(iotdata_encode_from_json("{\"variant\":1,\"station\":7}", buf, sizeof(buf), &len, &scratch), IOTDATA_ERR_JSON_MISSING_FIELD, "missing sequence");
+    ASSERT_ERR(iotdata_encode_from_json("[1,2]", buf, sizeof(buf), &len, &scratch), IOTDATA_ERR_JSON_MISSING_FIELD, "not an object");
+    PASS();
+}
+
+static void test_json_non_canonical_input(void) {
+    TEST("JSON input order, whitespace, case and escapes");
+
+    static const char *const canonical = "{\"variant\":1,\"station\":7,\"sequence\":42,\"battery\":{\"level\":50,\"charging\":true},\"temperature\":-12.5,\"humidity\":60}";
+    static const char *const inputs[] = {
+        /* fields before the header, whitespace, exponent form, duplicate label (first wins) */
+        " {\n\t\"humidity\" : 60 , \"battery\":{\"charging\":true,\"level\":50}, \"variant\":1,\"temperature\":-1.25e1,\"station\":7,\"sequence\":42,\"humidity\":99 }\n",
+        /* keys match case-insensitively and after unescaping, unknown members are skipped */
+        "{\"VARIANT\":1,\"Station\":7,\"sequence\":42,\"b\\u0061ttery\":{\"LEVEL\":50,\"charging\":true},\"temperature\":-12.5,\"humidity\":60,\"unknown\":[1,{\"x\":null}]}",
+    };
+    uint8_t ref[256], out[256];
+    size_t ref_len = 0, out_len = 0;
+    iotdata_encode_from_json_scratch_t scratch;
+    ASSERT_OK(iotdata_encode_from_json(canonical, ref, sizeof(ref), &ref_len, &scratch), "canonical");
+    for (int i = 0; i < (int)(sizeof(inputs) / sizeof(inputs[0])); i++) {
+        ASSERT_OK(iotdata_encode_from_json(inputs[i], out, sizeof(out), &out_len, &scratch), "non-canonical");
+        ASSERT_EQ(out_len, ref_len, "len match");
+        ASSERT_EQ(memcmp(out, ref, ref_len), 0, "bytes match");
+    }
     PASS();
 }
 
@@ -1164,6 +1198,7 @@ int main(void) {
     printf("\n--- Section 9: JSON error paths ---\n");
     test_json_parse_error();
     test_json_missing_fields();
+    test_json_non_canonical_input();
 
     printf("\n--- Section 10: Dump/print edge cases ---\n");
     test_dump_short_buffer();
@@ -0,0 +1,141 @@
+/*
+ * IoT Sensor Telemetry Protocol
+ * Copyright(C) 2026 Matthew Gream (https://libiotdata.org)
+ *
+ * test_mesh.c - test suite for the mesh helpers (examples/iotdata/iotdata_mesh.h)
+ *
+ * Covers FORWARD wrapping of an iotdata packet and the gateway's
+ * per-station duplicate suppression window: in-window duplicates,
+ * sequence wraparound, the left edge of the window, and stations that
+ * restart their sequence.
+ */
+
+#include "test_common.h"
+#include "iotdata_mesh.h"
+
+#define TIMEOUT 30
+
+static iotdata_mesh_dedup_window_t window;
+
+static bool check(uint16_t station, uint16_t sequence, uint32_t now) {
+    return iotdata_mesh_dedup_window_check_and_add(&window, station, sequence, now, TIMEOUT);
+}
+
+/* =========================================================================
+ * Forward wrapping
+ * =========================================================================*/
+
+static void test_forward_round_trip(void) {
+    TEST("Forward: wrap, unwrap and decode inner packet");
+    begin(0, 42, 1234);
+    ASSERT_OK(iotdata_encode_battery(&enc, 80, false), "bat");
+    ASSERT_OK(iotdata_encode_link(&enc, -90, 5.0f), "link");
+    finish();
+
+    uint8_t frame[IOTDATA_MESH_FORWARD_HDR_SIZE + sizeof(pkt)];
+    iotdata_mesh_pack_forward(frame, 7, 99, 3, pkt, (int)pkt_len);
+    iotdata_mesh_forward_t fwd;
+    ASSERT_TRUE(iotdata_mesh_unpack_forward(frame, IOTDATA_MESH_FORWARD_HDR_SIZE + (int)pkt_len, &fwd), "unpack");
+    ASSERT_EQ(fwd.sender_station, 7, "sender station");
+    ASSERT_EQ(fwd.sender_seq, 99, "sender seq");
+    ASSERT_EQ(fwd.ttl, 3, "ttl");
+    ASSERT_EQ(fwd.origin_station, 42, "origin station");
+    ASSERT_EQ(fwd.origin_sequence, 1234, "origin sequence");
+    ASSERT_EQ(fwd.inner_len, (int)pkt_len, "inner length");
+
+    memcpy(pkt, fwd.inner_packet, (size_t)fwd.inner_len);
+    decode_pkt();
+    ASSERT_EQ(dec.station, 42, "decoded station");
+    ASSERT_NEAR(dec.battery_level, 80, 4, "decoded battery");
+    ASSERT_NEAR(dec.link_rssi, -90, 4, "decoded rssi");
+    PASS();
+}
+
+/* =========================================================================
+ * Dedup window
+ * =========================================================================*/
+
+static void test_window_duplicates(void) {
+    TEST("Window: in-window duplicates suppressed");
+    iotdata_mesh_dedup_window_init(&window);
+    ASSERT_TRUE(check(1, 100, 0), "first");
+    ASSERT_TRUE(!check(1, 100, 0), "repeat of highest");
+    ASSERT_TRUE(check(1, 105, 1), "ahead");
+    ASSERT_TRUE(check(1, 102, 1), "gap filled");
+    ASSERT_TRUE(!check(1, 102, 2), "repeat of gap");
+    ASSERT_TRUE(!check(1, 100, 2), "repeat behind");
+    ASSERT_TRUE(check(2, 100, 2), "other station independent");
+    PASS();
+}
+
+static void test_window_wraparound(void) {
+    TEST("Window: sequence wraparound");
+    iotdata_mesh_dedup_window_init(&window);
+    ASSERT_TRUE(check(3, 65534, 0), "before wrap");
+    ASSERT_TRUE(check(3, 65535, 0), "at wrap");
+    ASSERT_TRUE(check(3, 0, 1), "after wrap");
+    ASSERT_TRUE(check(3, 1, 1), "after wrap + 1");
+    ASSERT_TRUE(!check(3, 65535, 2), "repeat across wrap");
+    ASSERT_TRUE(!check(3, 0, 2), "repeat after wrap");
+    PASS();
+}
+
+static void test_window_left_edge(void) {
+    TEST("Window: left edge and beyond");
+    iotdata_mesh_dedup_window_init(&window);
+    ASSERT_TRUE(check(4, 1000, 0), "first");
+    ASSERT_TRUE(check(4, 1000 - (IOTDATA_MESH_DEDUP_WINDOW_BITS - 1), 0), "last bit of window");
+    ASSERT_TRUE(!check(4, 1000 - (IOTDATA_MESH_DEDUP_WINDOW_BITS - 1), 0), "repeat at last bit");
+    ASSERT_TRUE(!check(4, 1000 - IOTDATA_MESH_DEDUP_WINDOW_BITS, 0), "just left of window");
+    ASSERT_TRUE(!check(4, 1000 - 500, 0), "far left (late replay)");
+    ASSERT_TRUE(!check(4, 1000, 0), "highest still suppressed");
+    ASSERT_TRUE(check(4, 1001, 0), "next still new");
+    PASS();
+}
+
+static void test_window_restart(void) {
+    TEST("Window: station restart after timeout");
+    iotdata_mesh_dedup_window_init(&window);
+    for (uint16_t s = 0; s <= 40; s++)
+        ASSERT_TRUE(check(5, s, s), "initial run");
+    ASSERT_TRUE(!check(5, 0, 41), "restart inside timeout suppressed");
+    ASSERT_TRUE(!check(5, 1, 40 + TIMEOUT - 1), "still inside timeout");
+    ASSERT_TRUE(check(5, 2, 40 + TIMEOUT), "restart after timeout accepted");
+    ASSERT_TRUE(!check(5, 2, 40 + TIMEOUT), "repeat after restart");
+    ASSERT_TRUE(check(5, 3, 40 + TIMEOUT + 1), "continues after restart");
+    PASS();
+}
+
+static void test_window_clock_behind(void) {
+    TEST("Window: caller clock slightly behind");
+    iotdata_mesh_dedup_window_init(&window);
+    ASSERT_TRUE(check(6, 10, 100), "first");
+    ASSERT_TRUE(!check(6, 10, 99), "repeat stamped earlier");
+    ASSERT_TRUE(check(6, 11, 99), "next stamped earlier");
+    PASS();
+}
+
+/* =========================================================================
+ * Main
+ * =========================================================================*/
+
+int main(void) {
+    printf("\n=== iotdata — mesh test suite ===\n\n");
+
+    printf("  --- Forward ---\n");
+    test_forward_round_trip();
+
+    printf("\n  --- Dedup window ---\n");
+    test_window_duplicates();
+    test_window_wraparound();
+    test_window_left_edge();
+    test_window_restart();
+    test_window_clock_behind();
+
+    printf("\n=== Results: %d/%d passed", tests_passed, tests_run);
+    if (tests_failed > 0)
+        printf(" (%d FAILED)", tests_failed);
+    printf(" ===\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
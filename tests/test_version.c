@@ -17,7 +17,7 @@
  *   FULL                All features (encode + decode + print + dump + JSON)
  *   NO_PRINT            Exclude iotdata_print / iotdata_print_to_string
  *   NO_DUMP             Exclude iotdata_dump / iotdata_dump_to_string
- *   NO_JSON             Exclude JSON support (no cJSON dependency)
+ *   NO_JSON             Exclude JSON support
  *   NO_DECODE           Encoder only (no decode/print/dump/JSON)
  *   NO_ENCODE           Decoder only (no encoder)
  *   NO_FLOATING         Integer-only mode (int32_t scaled values)
@@ -26,11 +26,12 @@
  *   NO_FLOATING_DOUBLES Use float instead of double for position
  *   SELECTIVE           All types via IOTDATA_ENABLE_SELECTIVE
  *   NO_CHECKS           No runtime state or type checks
+ *   STREAMING           Pack-as-you-go encoder (fields added in slot order)
  *
  * Compile (example, full variant):
  *   cc -DIOTDATA_VARIANT_MAPS=test_version_variants
  *      -DIOTDATA_VARIANT_MAPS_COUNT=1
- *      test_version.c iotdata.c -lm -lcjson -o test_version_FULL
+ *      test_version.c iotdata.c -lm -o test_version_FULL
  */
 
 #include "iotdata.h"
@@ -84,7 +85,9 @@ const iotdata_variant_def_t test_version_variants[] = {
  * -----------------------------------------------------------------------*/
 
 static const char *build_label(void) {
-#if defined(IOTDATA_NO_DECODE)
+#if defined(IOTDATA_ENCODE_STREAMING)
+    return "STREAMING";
+#elif defined(IOTDATA_NO_DECODE)
     return "NO_DECODE";
 #elif defined(IOTDATA_NO_ENCODE)
     return "NO_ENCODE";
@@ -106,6 +109,8 @@ static const char *build_label(void) {
     return "NO_CHECKS";
 #elif defined(IOTDATA_ENABLE_SELECTIVE)
     return "SELECTIVE";
+#elif defined(IOTDATA_DECODE_SPECIALISED)
+    return "SPECIALISED";
 #else
     return "FULL";
 #endif
@@ -164,6 +169,9 @@ static int do_encode(uint8_t *buf, size_t buf_size, size_t *out_len) {
     rc = iotdata_encode_battery(&enc, 75, true);
     CHECK(rc == IOTDATA_OK, "encode_battery");
 
+    rc = iotdata_encode_link(&enc, -90, 50); /* 5.00 dB */
+    CHECK(rc == IOTDATA_OK, "encode_link");
+
     rc = iotdata_encode_environment(&enc, 2250, 1013, 65); /* 22.50 °C */
     CHECK(rc == IOTDATA_OK, "encode_environment");
 
@@ -176,13 +184,10 @@ static int do_encode(uint8_t *buf, size_t buf_size, size_t *out_len) {
     rc = iotdata_encode_solar(&enc, 500, 7);
     CHECK(rc == IOTDATA_OK, "encode_solar");
 
-    rc = iotdata_encode_link(&enc, -90, 50); /* 5.00 dB */
-    CHECK(rc == IOTDATA_OK, "encode_link");
-
     /* --- pres1 fields --- */
 
-    rc = iotdata_encode_flags(&enc, 0x42);
-    CHECK(rc == IOTDATA_OK, "encode_flags");
+    rc = iotdata_encode_clouds(&enc, 4);
+    CHECK(rc == IOTDATA_OK, "encode_clouds");
 
     {
         const uint16_t pm[IOTDATA_AIR_QUALITY_PM_COUNT] = { 35, 12, 50, 25 }, gas[IOTDATA_AIR_QUALITY_GAS_COUNT] = { 400, 50, 30, 10, 5, 200, 100, 80 };
@@ -190,9 +195,6 @@ static int do_encode(uint8_t *buf, size_t buf_size, size_t *out_len) {
         CHECK(rc == IOTDATA_OK, "encode_air_quality");
     }
 
-    rc = iotdata_encode_clouds(&enc, 4);
-    CHECK(rc == IOTDATA_OK, "encode_clouds");
-
     rc = iotdata_encode_radiation(&enc, 100, 50); /* 0.50 µSv/h */
     CHECK(rc == IOTDATA_OK, "encode_radiation");
 
@@ -204,11 +206,17 @@ static int do_encode(uint8_t *buf, size_t buf_size, size_t *out_len) {
 
     rc = iotdata_encode_datetime(&enc, 86400);
     CHECK(rc == IOTDATA_OK, "encode_datetime");
+
+    rc = iotdata_encode_flags(&enc, 0x42);
+    CHECK(rc == IOTDATA_OK, "encode_flags");
 #else
     /* Float mode */
     rc = iotdata_encode_battery(&enc, 75, true);
     CHECK(rc == IOTDATA_OK, "encode_battery");
 
+    rc = iotdata_encode_link(&enc, -90, 5.0f);
+    CHECK(rc == IOTDATA_OK, "encode_link");
+
     rc = iotdata_encode_environment(&enc, 22.5f, 1013, 65);
     CHECK(rc == IOTDATA_OK, "encode_environment");
 
@@ -221,13 +229,10 @@ static int do_encode(uint8_t *buf, size_t buf_size, size_t *out_len) {
     rc = iotdata_encode_solar(&enc, 500, 7);
     CHECK(rc == IOTDATA_OK, "encode_solar");
 
-    rc = iotdata_encode_link(&enc, -90, 5.0f);
-    CHECK(rc == IOTDATA_OK, "encode_link");
-
     /* --- pres1 fields --- */
 
-    rc = iotdata_encode_flags(&enc, 0x42);
-    CHECK(rc == IOTDATA_OK, "encode_flags");
+    rc = iotdata_encode_clouds(&enc, 4);
+    CHECK(rc == IOTDATA_OK, "encode_clouds");
 
     {
         const uint16_t pm[IOTDATA_AIR_QUALITY_PM_COUNT] = { 35, 12, 50, 25 }, gas[IOTDATA_AIR_QUALITY_GAS_COUNT] = { 400, 50, 30, 10, 5, 200, 100, 80 };
@@ -235,9 +240,6 @@ static int do_encode(uint8_t *buf, size_t buf_size, size_t *out_len) {
         CHECK(rc == IOTDATA_OK, "encode_air_quality");
     }
 
-    rc = iotdata_encode_clouds(&enc, 4);
-    CHECK(rc == IOTDATA_OK, "encode_clouds");
-
     rc = iotdata_encode_radiation(&enc, 100, 0.50f);
     CHECK(rc == IOTDATA_OK, "encode_radiation");
 
@@ -253,6 +255,9 @@ static int do_encode(uint8_t *buf, size_t buf_size, size_t *out_len) {
 
     rc = iotdata_encode_datetime(&enc, 86400);
     CHECK(rc == IOTDATA_OK, "encode_datetime");
+
+    rc = iotdata_encode_flags(&enc, 0x42);
+    CHECK(rc == IOTDATA_OK, "encode_flags");
 #endif
 
     {
@@ -267,6 +272,18 @@ static int do_encode(uint8_t *buf, size_t buf_size, size_t *out_len) {
     CHECK(rc == IOTDATA_OK, "encode_end");
     CHECK(*out_len > 0, "encoded length > 0");
 
+#if defined(IOTDATA_ENCODE_STREAMING)
+    {
+        /* Streaming packs each field as it is added, so fields must arrive in slot order */
+        iotdata_encoder_t order;
+        uint8_t order_buf[32];
+        CHECK(iotdata_encode_begin(&order, order_buf, sizeof(order_buf), 0, 1, 2) == IOTDATA_OK, "streaming encode_begin");
+        CHECK(iotdata_encode_solar(&order, 500, 7) == IOTDATA_OK, "streaming encode_solar");
+        CHECK(iotdata_encode_battery(&order, 75, true) == IOTDATA_ERR_CTX_FIELD_ORDER, "streaming out-of-order field rejected");
+        CHECK(iotdata_encode_depth(&order, 150) == IOTDATA_OK, "streaming encode_depth after rejection");
+    }
+#endif
+
     return (rc == IOTDATA_OK) ? 0 : -1;
 }
 #endif /* !NO_ENCODE */